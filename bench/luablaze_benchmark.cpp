@@ -0,0 +1,258 @@
+// luablaze_benchmark.cpp - Stage-by-stage microbenchmarks for luablaze
+//
+// Measures the binding's hot paths separately for every schema/data pair in
+// spec/test_data/ (`<name>.schema.json` + `<name>[.N].data.json`):
+//
+// - lua_value_to_json/<pair>: Lua table -> sourcemeta::core::JSON conversion
+// - parse_json/<pair>: parse_json_with_depth_limit on the instance text
+// - evaluate/<pair>: Evaluator::validate on the parsed instance
+// - json_to_lua_value/<pair>: "basic" output document -> Lua tables
+//
+// Besides time per iteration, every benchmark reports `allocs_per_op` and
+// `bytes_per_op`, counting both C++ heap allocations (global operator new)
+// and Lua allocations (the state's allocator). Use the standard Google
+// Benchmark flags for machine-readable output, e.g.
+// `--benchmark_format=json` or `--benchmark_out=results.json`.
+//
+// The data directory defaults to LUABLAZE_BENCHMARK_DATA_DIR and can be
+// overridden with the LUABLAZE_BENCHMARK_DATA environment variable.
+
+// Pull in the module itself so the static stage functions are reachable
+#include "luablaze.cpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+
+#ifndef LUABLAZE_BENCHMARK_DATA_DIR
+#define LUABLAZE_BENCHMARK_DATA_DIR "spec/test_data"
+#endif
+
+// Allocation counters shared by operator new and the Lua allocator
+static std::atomic<std::uint64_t> allocation_count{0};
+static std::atomic<std::uint64_t> allocation_bytes{0};
+
+static void count_allocation(const std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void *operator new(const std::size_t size) {
+    count_allocation(size);
+    if (void *pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc{};
+}
+
+void *operator new[](const std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+// Lua allocator that feeds the same counters. Growing an existing block
+// counts as one allocation of the new size.
+static void *counting_lua_alloc(void *, void *pointer, const std::size_t old_size, const std::size_t new_size) {
+    if (new_size == 0) {
+        std::free(pointer);
+        return nullptr;
+    }
+
+    if (pointer == nullptr || new_size > old_size) {
+        count_allocation(new_size);
+    }
+    return std::realloc(pointer, new_size);
+}
+
+// Snapshot of the allocation counters, turned into per-iteration counters
+// once the benchmark loop is done.
+class AllocationScope {
+public:
+    explicit AllocationScope(benchmark::State &state)
+        : state{state}, count{allocation_count.load()}, bytes{allocation_bytes.load()} {
+    }
+
+    ~AllocationScope() {
+        state.counters["allocs_per_op"] = benchmark::Counter(
+            static_cast<double>(allocation_count.load() - this->count), benchmark::Counter::kAvgIterations);
+        state.counters["bytes_per_op"] = benchmark::Counter(
+            static_cast<double>(allocation_bytes.load() - this->bytes), benchmark::Counter::kAvgIterations);
+    }
+
+private:
+    benchmark::State &state;
+    const std::uint64_t count;
+    const std::uint64_t bytes;
+};
+
+/**
+ * @brief Everything a benchmark needs for one schema/data pair.
+ *
+ * @var instance_text Raw instance JSON
+ * @var instance Parsed instance
+ * @var schema_template Compiled schema (FastValidation)
+ * @var output "basic" standard output for the instance
+ * @var table_ref Registry reference to the instance converted to Lua tables
+ */
+struct BenchmarkPair {
+    std::string instance_text;
+    sourcemeta::core::JSON instance{nullptr};
+    sourcemeta::blaze::Template schema_template;
+    sourcemeta::core::JSON output{nullptr};
+    int table_ref{LUA_NOREF};
+};
+
+static auto read_file(const std::filesystem::path &path) -> std::string {
+    std::ifstream stream{path, std::ios::binary};
+    if (!stream) {
+        throw std::runtime_error("Cannot open " + path.string());
+    }
+    return {std::istreambuf_iterator<char>{stream}, std::istreambuf_iterator<char>{}};
+}
+
+// Find `<name>.schema.json` for `<name>[.N].data.json`, also accepting the
+// `.shcema.json` spelling used by one of the fixtures.
+static auto schema_path_for(const std::filesystem::path &data_path) -> std::optional<std::filesystem::path> {
+    const auto file_name = data_path.filename().string();
+    const auto base      = file_name.substr(0, file_name.find('.'));
+    for (const char *suffix : {".schema.json", ".shcema.json"}) {
+        const auto candidate = data_path.parent_path() / (base + suffix);
+        if (std::filesystem::exists(candidate)) {
+            return candidate;
+        }
+    }
+    return std::nullopt;
+}
+
+static void register_pair(lua_State *L, const std::string &name, BenchmarkPair &pair) {
+    benchmark::RegisterBenchmark(("lua_value_to_json/" + name).c_str(), [L, &pair](benchmark::State &state) {
+        lua_rawgeti(L, LUA_REGISTRYINDEX, pair.table_ref);
+        const int index = lua_gettop(L);
+        ConversionScratch scratch;
+        std::string error;
+        AllocationScope allocations{state};
+        for (auto _ : state) {
+            scratch.reset();
+            sourcemeta::core::JSON out{nullptr};
+            if (!lua_value_to_json(L, index, scratch, LUABLAZE_DEFAULT_MAX_ARRAY_LENGTH,
+                                   LUABLAZE_DEFAULT_MAX_RECURSION_DEPTH, 0, out, error)) {
+                state.SkipWithError(error.c_str());
+                break;
+            }
+            benchmark::DoNotOptimize(out);
+        }
+        lua_settop(L, index - 1);
+    });
+
+    benchmark::RegisterBenchmark(("parse_json/" + name).c_str(), [&pair](benchmark::State &state) {
+        AllocationScope allocations{state};
+        for (auto _ : state) {
+            auto instance = parse_json_with_depth_limit(pair.instance_text, LUABLAZE_DEFAULT_MAX_DEPTH);
+            benchmark::DoNotOptimize(instance);
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * pair.instance_text.size()));
+    });
+
+    benchmark::RegisterBenchmark(("evaluate/" + name).c_str(), [&pair](benchmark::State &state) {
+        sourcemeta::blaze::Evaluator evaluator;
+        AllocationScope allocations{state};
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(evaluator.validate(pair.schema_template, pair.instance));
+        }
+    });
+
+    benchmark::RegisterBenchmark(("json_to_lua_value/" + name).c_str(), [L, &pair](benchmark::State &state) {
+        std::string error;
+        AllocationScope allocations{state};
+        for (auto _ : state) {
+            if (!json_to_lua_value(L, pair.output, LUABLAZE_DEFAULT_MAX_RECURSION_DEPTH, 0, error)) {
+                state.SkipWithError(error.c_str());
+                break;
+            }
+            lua_pop(L, 1);
+        }
+    });
+}
+
+int main(int argc, char **argv) {
+    const char *override_dir = std::getenv("LUABLAZE_BENCHMARK_DATA");
+    const std::filesystem::path data_dir{override_dir != nullptr ? override_dir : LUABLAZE_BENCHMARK_DATA_DIR};
+
+    lua_State *L = lua_newstate(counting_lua_alloc, nullptr);
+    if (L == nullptr) {
+        std::fprintf(stderr, "Cannot create Lua state\n");
+        return EXIT_FAILURE;
+    }
+
+    // Ordered by name so runs are comparable between releases
+    std::map<std::string, BenchmarkPair> pairs;
+    try {
+        for (const auto &entry : std::filesystem::directory_iterator{data_dir}) {
+            const auto file_name = entry.path().filename().string();
+            if (file_name.size() < 10 || file_name.compare(file_name.size() - 10, 10, ".data.json") != 0) {
+                continue;
+            }
+            const auto schema_path = schema_path_for(entry.path());
+            if (!schema_path.has_value()) {
+                continue;
+            }
+
+            const auto name      = file_name.substr(0, file_name.size() - 10);
+            auto &pair           = pairs[name];
+            pair.instance_text   = read_file(entry.path());
+            pair.instance        = parse_json_with_depth_limit(pair.instance_text, LUABLAZE_DEFAULT_MAX_DEPTH);
+            pair.schema_template = sourcemeta::blaze::compile(
+                parse_json_with_depth_limit(read_file(schema_path.value()), LUABLAZE_DEFAULT_MAX_DEPTH),
+                sourcemeta::core::schema_walker, sourcemeta::core::schema_resolver,
+                sourcemeta::blaze::default_schema_compiler, sourcemeta::blaze::Mode::FastValidation);
+
+            sourcemeta::blaze::Evaluator evaluator;
+            pair.output = sourcemeta::blaze::standard(evaluator, pair.schema_template, pair.instance,
+                                                      sourcemeta::blaze::StandardOutput::Basic);
+
+            std::string error;
+            if (!json_to_lua_value(L, pair.instance, LUABLAZE_DEFAULT_MAX_RECURSION_DEPTH, 0, error)) {
+                throw std::runtime_error(name + ": " + error);
+            }
+            pair.table_ref = luaL_ref(L, LUA_REGISTRYINDEX);
+        }
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "Cannot load benchmark data from %s: %s\n", data_dir.string().c_str(), e.what());
+        lua_close(L);
+        return EXIT_FAILURE;
+    }
+
+    for (auto &[name, pair] : pairs) {
+        register_pair(L, name, pair);
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        lua_close(L);
+        return EXIT_FAILURE;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    lua_close(L);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,72 @@
+-- Tests for CompiledSchema:validate_json_async and ValidationJob
+require("spec.spec_helper")
+
+local luablaze = require("luablaze")
+
+describe("asynchronous validation", function()
+    local schema = luablaze.new([[{
+        "$schema": "http://json-schema.org/draft-07/schema#",
+        "type": "array",
+        "items": { "type": "integer" }
+    }]])
+
+    local function large_array(count, last)
+        local items = {}
+        for i = 1, count - 1 do
+            items[i] = tostring(i)
+        end
+        items[count] = last
+        return "[" .. table.concat(items, ",") .. "]"
+    end
+
+    it("returns the validation result", function()
+        assert.is_true(schema:validate_json_async("[1,2,3]"):result())
+        assert.is_false(schema:validate_json_async('[1,"2"]'):result())
+    end)
+
+    it("can be polled and waited on", function()
+        local job = schema:validate_json_async(large_array(50000, "1"))
+        assert.are.equal("boolean", type(job:done()))
+        assert.is_true(job:wait())
+        assert.is_true(job:done())
+        assert.is_true(job:wait(0))
+        assert.is_true(job:result())
+    end)
+
+    it("runs many jobs concurrently and keeps them independent", function()
+        local jobs = {}
+        for i = 1, 64 do
+            jobs[i] = schema:validate_json_async(large_array(1000, (i % 2 == 0) and "1" or '"x"'))
+        end
+        for i = 1, 64 do
+            assert.are.equal(i % 2 == 0, jobs[i]:result())
+        end
+    end)
+
+    it("raises parse errors from result()", function()
+        local job = schema:validate_json_async("[1,")
+        assert.is_true(job:wait(10))
+        assert.has_error(function() job:result() end)
+    end)
+
+    it("does not depend on the schema or input staying alive", function()
+        local job = luablaze.new([[{"type":"string"}]]):validate_json_async(string.rep(" ", 10) .. '"ok"')
+        collectgarbage()
+        collectgarbage()
+        assert.is_true(job:result())
+    end)
+
+    it("exposes a readiness descriptor on POSIX systems", function()
+        local fd = schema:validate_json_async("[]"):fd()
+        if package.config:sub(1, 1) == "/" then
+            assert.are.equal("number", type(fd))
+        else
+            assert.is_nil(fd)
+        end
+    end)
+
+    it("rejects invalid arguments", function()
+        assert.has_error(function() schema:validate_json_async({}) end)
+        assert.has_error(function() schema:validate_json_async("[]"):wait(-1) end)
+    end)
+end)
@@ -0,0 +1,144 @@
+-- Tests for the batch validation methods (validate_many / validate_json_many)
+require("spec.spec_helper")
+
+local luablaze = require("luablaze")
+
+describe("Batch validation", function()
+    local object_schema = [[{
+        "$schema": "http://json-schema.org/draft-07/schema#",
+        "type": "object",
+        "properties": { "name": { "type": "string" } },
+        "required": ["name"]
+    }]]
+
+    describe("CompiledSchema:validate_many()", function()
+        it("returns one boolean per instance and the invalid count", function()
+            local schema = luablaze.new(object_schema)
+            local results, invalid = schema:validate_many({
+                { name = "Ada" },
+                { name = 123 },
+                { name = "Grace" },
+                {},
+            })
+            assert.same({ true, false, true, false }, results)
+            assert.equals(2, invalid)
+        end)
+
+        it("returns the indices of invalid instances with failures_only", function()
+            local schema = luablaze.new(object_schema)
+            local failed, invalid = schema:validate_many({
+                { name = "Ada" },
+                { name = 123 },
+                { name = "Grace" },
+                {},
+            }, { failures_only = true })
+            assert.same({ 2, 4 }, failed)
+            assert.equals(2, invalid)
+        end)
+
+        it("matches the results of validate for every element", function()
+            local schema = luablaze.new(object_schema)
+            local instances = {}
+            for i = 1, 200 do
+                instances[i] = (i % 3 == 0) and { name = i } or { name = tostring(i) }
+            end
+            local results = schema:validate_many(instances)
+            for i = 1, #instances do
+                assert.equals(schema:validate(instances[i]), results[i])
+            end
+        end)
+
+        it("handles an empty batch", function()
+            local schema = luablaze.new(object_schema)
+            local results, invalid = schema:validate_many({})
+            assert.same({}, results)
+            assert.equals(0, invalid)
+        end)
+
+        it("names the offending element on conversion errors", function()
+            local schema = luablaze.new(object_schema)
+            local cyclic = { name = "loop" }
+            cyclic.self = cyclic
+            local ok, err = pcall(function()
+                schema:validate_many({ { name = "Ada" }, cyclic })
+            end)
+            assert.is_false(ok)
+            assert.is_truthy(err:match("instances%[2%]"))
+            assert.is_truthy(err:match("Cycle detected"))
+        end)
+
+        it("rejects non-table elements", function()
+            local schema = luablaze.new(object_schema)
+            local ok, err = pcall(function()
+                schema:validate_many({ { name = "Ada" }, "not a table" })
+            end)
+            assert.is_false(ok)
+            assert.is_truthy(err:match("instances%[2%] must be a table"))
+        end)
+
+        it("rejects invalid options", function()
+            local schema = luablaze.new(object_schema)
+            assert.has_error(function()
+                schema:validate_many({}, { failures_only = "yes" })
+            end)
+        end)
+
+        it("is available as a module-level function", function()
+            local schema = luablaze.new(object_schema)
+            local results, invalid = luablaze.validate_many(schema, { { name = "Ada" } })
+            assert.same({ true }, results)
+            assert.equals(0, invalid)
+        end)
+    end)
+
+    describe("CompiledSchema:validate_json_many()", function()
+        it("returns one boolean per instance and the invalid count", function()
+            local schema = luablaze.new(object_schema)
+            local results, invalid = schema:validate_json_many({
+                '{"name":"Ada"}',
+                '{"name":123}',
+            })
+            assert.same({ true, false }, results)
+            assert.equals(1, invalid)
+        end)
+
+        it("returns the indices of invalid instances with failures_only", function()
+            local schema = luablaze.new(object_schema)
+            local failed, invalid = schema:validate_json_many({
+                '{"name":1}',
+                '{"name":"Ada"}',
+                '{}',
+            }, { failures_only = true })
+            assert.same({ 1, 3 }, failed)
+            assert.equals(2, invalid)
+        end)
+
+        it("names the offending element on parse errors", function()
+            local schema = luablaze.new(object_schema)
+            local ok, err = pcall(function()
+                schema:validate_json_many({ '{"name":"Ada"}', '{"name":' })
+            end)
+            assert.is_false(ok)
+            assert.is_truthy(err:match("instances%[2%]"))
+        end)
+
+        it("enforces max_depth for every element", function()
+            local flat_schema = [[{"$schema":"http://json-schema.org/draft-07/schema#","type":"object"}]]
+            local schema = luablaze.new(flat_schema, { max_depth = 2 })
+            local ok, err = pcall(function()
+                schema:validate_json_many({ '{"name":"Ada"}', '{"name":[[1]]}' })
+            end)
+            assert.is_false(ok)
+            assert.is_truthy(err:match("maximum nesting depth"))
+        end)
+
+        it("rejects non-string elements", function()
+            local schema = luablaze.new(object_schema)
+            local ok, err = pcall(function()
+                schema:validate_json_many({ { name = "Ada" } })
+            end)
+            assert.is_false(ok)
+            assert.is_truthy(err:match("instances%[1%] must be a string"))
+        end)
+    end)
+end)
@@ -0,0 +1,75 @@
+-- Tests for CompiledSchema:decode_json
+require("spec.spec_helper")
+
+local luablaze = require("luablaze")
+
+describe("decode_json", function()
+    local schema = luablaze.new([[{
+        "$schema": "https://json-schema.org/draft/2020-12/schema",
+        "type": "object",
+        "properties": {
+            "id": { "type": "integer" },
+            "tags": { "type": "array" },
+            "parent": { "type": ["object", "null"] }
+        },
+        "required": ["id"]
+    }]])
+
+    it("returns the validation result and the decoded document", function()
+        local ok, value = schema:decode_json('{"id": 1, "tags": ["a", "b"], "parent": {"id": 0}}')
+        assert.is_true(ok)
+        assert.are.same({ id = 1, tags = { "a", "b" }, parent = { id = 0 } }, value)
+    end)
+
+    it("decodes invalid documents by default", function()
+        local ok, value = schema:decode_json('{"id": "1"}')
+        assert.is_false(ok)
+        assert.are.same({ id = "1" }, value)
+    end)
+
+    it("skips decoding invalid documents with decode_on_failure = false", function()
+        local ok, value = schema:decode_json('{"id": "1"}', { decode_on_failure = false })
+        assert.is_false(ok)
+        assert.is_nil(value)
+
+        ok, value = schema:decode_json('{"id": 1}', { decode_on_failure = false })
+        assert.is_true(ok)
+        assert.are.same({ id = 1 }, value)
+    end)
+
+    it("decodes null as nil or as the given sentinel", function()
+        local _, value = schema:decode_json('{"id": 1, "parent": null, "tags": [null, 1]}')
+        assert.is_nil(value.parent)
+
+        local null = setmetatable({}, { __name = "null" })
+        _, value = schema:decode_json('{"id": 1, "parent": null, "tags": [null, 1]}', { null = null })
+        assert.are.equal(null, value.parent)
+        assert.are.equal(null, value.tags[1])
+        assert.are.equal(1, value.tags[2])
+    end)
+
+    it("marks arrays and objects with metatables", function()
+        local options = { array_mt = true, object_mt = true }
+        local _, value = schema:decode_json('{"id": 1, "tags": [], "parent": {}}', options)
+        assert.are.equal(luablaze.array_mt, getmetatable(value.tags))
+        assert.are.equal(luablaze.object_mt, getmetatable(value.parent))
+        assert.are.equal(luablaze.object_mt, getmetatable(value))
+
+        local array_mt = {}
+        _, value = schema:decode_json('{"id": 1, "tags": []}', { array_mt = array_mt })
+        assert.are.equal(array_mt, getmetatable(value.tags))
+        assert.is_nil(getmetatable(value))
+    end)
+
+    it("round-trips marked empty containers through validate", function()
+        local _, value = schema:decode_json('{"id": 1, "tags": []}', { array_mt = true })
+        assert.is_true(schema:validate(value))
+    end)
+
+    it("rejects malformed JSON and invalid options", function()
+        assert.has_error(function() schema:decode_json("{") end)
+        assert.has_error(function() schema:decode_json("{}", "options") end)
+        assert.has_error(function() schema:decode_json("{}", { decode_on_failure = 1 }) end)
+        assert.has_error(function() schema:decode_json("{}", { array_mt = "array" }) end)
+    end)
+end)
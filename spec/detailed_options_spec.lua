@@ -0,0 +1,102 @@
+-- Tests for the options accepted by the *_detailed methods
+require("spec.spec_helper")
+
+local luablaze = require("luablaze")
+
+describe("detailed report options", function()
+    local schema = luablaze.new([[{
+        "$schema": "http://json-schema.org/draft-07/schema#",
+        "type": "array",
+        "items": { "type": "integer" }
+    }]], { mode = "Exhaustive" })
+
+    local bad = '["a","b","c","d","e","f"]'
+
+    it("keeps the full report without options", function()
+        local ok, report = schema:validate_json_detailed(bad)
+        assert.is_false(ok)
+        assert.is_nil(report.truncated)
+        assert.is_true(#report.errors > 3)
+    end)
+
+    it("limits the number of errors", function()
+        local _, full = schema:validate_json_detailed(bad)
+        local ok, report = schema:validate_json_detailed(bad, { max_errors = 2 })
+        assert.is_false(ok)
+        assert.is_false(report.valid)
+        assert.are.equal(2, #report.errors)
+        assert.is_true(report.truncated)
+        assert.are.same(full.errors[1], report.errors[1])
+    end)
+
+    it("stops at the same errors as the full report", function()
+        local union = luablaze.new([[{
+            "$schema": "http://json-schema.org/draft-07/schema#",
+            "type": "array",
+            "items": { "anyOf": [{ "type": "integer" }, { "type": "null" }] },
+            "contains": { "type": "boolean" }
+        }]], { mode = "Exhaustive" })
+        local _, full = union:validate_json_detailed(bad)
+        for limit = 1, #full.errors + 1 do
+            local ok, report = union:validate_json_detailed(bad, { max_errors = limit })
+            assert.is_false(ok)
+            assert.are.equal(math.min(limit, #full.errors), #report.errors)
+            for index, entry in ipairs(report.errors) do
+                assert.are.same(full.errors[index], entry)
+            end
+            if limit < #full.errors then
+                assert.is_true(report.truncated)
+            else
+                assert.is_nil(report.truncated)
+            end
+        end
+    end)
+
+    it("does not mark reports within the limit as truncated", function()
+        local _, report = schema:validate_json_detailed('["a"]', { max_errors = 10 })
+        assert.is_nil(report.truncated)
+    end)
+
+    it("does not collect annotations with max_errors", function()
+        local annotated = luablaze.new([[{
+            "$schema": "https://json-schema.org/draft/2020-12/schema",
+            "title": "list",
+            "type": "array",
+            "items": { "title": "item", "type": "integer" }
+        }]], { mode = "Exhaustive" })
+        local ok, report = annotated:validate_json_detailed("[1, 2]", { max_errors = 5 })
+        assert.is_true(ok)
+        assert.are.same({ valid = true }, report)
+    end)
+
+    it("keeps only the requested fields", function()
+        local _, report = schema:validate_detailed({ "a" }, { fields = { "instanceLocation" } })
+        for _, entry in ipairs(report.errors) do
+            assert.is_string(entry.instanceLocation)
+            assert.is_nil(entry.keywordLocation)
+            assert.is_nil(entry.error)
+        end
+    end)
+
+    it("supports the flag format", function()
+        local ok, report = schema:validate_json_detailed(bad, { format = "flag" })
+        assert.is_false(ok)
+        assert.are.same({ valid = false }, report)
+
+        local valid, valid_report = schema:validate_json_detailed("[1]", { format = "flag" })
+        assert.is_true(valid)
+        assert.are.same({ valid = true }, valid_report)
+    end)
+
+    it("is accepted by the functional forms", function()
+        local _, report = luablaze.validate_json_detailed(schema, bad, { max_errors = 1 })
+        assert.are.equal(1, #report.errors)
+    end)
+
+    it("rejects invalid options", function()
+        assert.has_error(function() schema:validate_json_detailed(bad, { format = "verbose" }) end)
+        assert.has_error(function() schema:validate_json_detailed(bad, { max_errors = -1 }) end)
+        assert.has_error(function() schema:validate_json_detailed(bad, { fields = { "valid" } }) end)
+        assert.has_error(function() schema:validate_json_detailed(bad, "flag") end)
+    end)
+end)
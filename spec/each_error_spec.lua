@@ -0,0 +1,127 @@
+-- Tests for CompiledSchema:each_error and each_error_json
+require("spec.spec_helper")
+
+local luablaze = require("luablaze")
+
+describe("each_error", function()
+    local schema = luablaze.new([[{
+        "$schema": "https://json-schema.org/draft/2020-12/schema",
+        "type": "object",
+        "properties": {
+            "id": { "type": "integer" },
+            "name": { "type": "string" },
+            "tags": { "type": "array", "items": { "type": "string" } }
+        }
+    }]], { mode = "Exhaustive" })
+
+    local function collect(method, instance)
+        local errors = {}
+        local function record(instance_location, keyword_location, message)
+            errors[#errors + 1] = { instance_location, keyword_location, message }
+        end
+        local valid, count, stopped = schema[method](schema, instance, record)
+        return valid, count, stopped, errors
+    end
+
+    it("reports nothing for valid instances", function()
+        local valid, count, stopped, errors = collect("each_error", { id = 1, name = "a" })
+        assert.is_true(valid)
+        assert.are.equal(0, count)
+        assert.is_false(stopped)
+        assert.are.same({}, errors)
+    end)
+
+    it("streams every error with its locations and message", function()
+        local valid, count, stopped, errors = collect("each_error", { id = "1", name = 2, tags = { "a", 3 } })
+        assert.is_false(valid)
+        assert.is_false(stopped)
+        assert.are.equal(#errors, count)
+
+        local locations = {}
+        for _, entry in ipairs(errors) do
+            assert.is_string(entry[3])
+            assert.is_true(#entry[3] > 0)
+            locations[entry[1]] = true
+        end
+        assert.is_true(locations["/id"])
+        assert.is_true(locations["/name"])
+        assert.is_true(locations["/tags/1"])
+    end)
+
+    it("reports the same error locations as validate_detailed", function()
+        local conditional = luablaze.new([[{
+            "$schema": "https://json-schema.org/draft/2020-12/schema",
+            "if": { "properties": { "kind": { "const": "user" } } },
+            "then": { "required": ["name"], "properties": { "name": { "type": "string" } } },
+            "else": { "properties": { "name": { "type": "null" } } },
+            "anyOf": [{ "required": ["id"] }, { "required": ["key"] }]
+        }]], { mode = "Exhaustive" })
+        local cases = {
+            { schema, { id = "1", tags = { 1, 2 } } },
+            { conditional, { kind = "user" } },
+            { conditional, { kind = "user", name = 1, id = 1 } },
+            { conditional, { kind = "bot", name = "x" } },
+        }
+        for _, case in ipairs(cases) do
+            local _, report = case[1]:validate_detailed(case[2])
+            local errors = {}
+            case[1]:each_error(case[2], function(instance_location, keyword_location)
+                errors[#errors + 1] = { instance_location, keyword_location }
+            end)
+            assert.is_true(#errors > 0)
+            assert.are.equal(#report.errors, #errors)
+            for index, entry in ipairs(report.errors) do
+                assert.are.equal(entry.instanceLocation, errors[index][1])
+                assert.are.equal(entry.keywordLocation, errors[index][2])
+            end
+        end
+    end)
+
+    it("drops errors of branches that end up passing", function()
+        local union = luablaze.new([[{
+            "anyOf": [{ "type": "string" }, { "type": "integer" }],
+            "not": { "type": "boolean" }
+        }]], { mode = "Exhaustive" })
+        local count = select(2, union:each_error_json("1", function() end))
+        assert.are.equal(0, count)
+        local valid
+        valid, count = union:each_error_json("true", function() end)
+        assert.is_false(valid)
+        assert.is_true(count > 0)
+    end)
+
+    it("stops when the function returns true", function()
+        local calls = 0
+        local valid, count, stopped = schema:each_error({ id = "1", name = 2, tags = { 1, 2, 3 } }, function()
+            calls = calls + 1
+            return true
+        end)
+        assert.is_false(valid)
+        assert.are.equal(1, calls)
+        assert.are.equal(1, count)
+        assert.is_true(stopped)
+    end)
+
+    it("accepts JSON strings and instances", function()
+        local valid, count = collect("each_error_json", '{"id": "1"}')
+        assert.is_false(valid)
+        assert.is_true(count > 0)
+        valid, count = collect("each_error", luablaze.parse('{"name": 1}'))
+        assert.is_false(valid)
+        assert.is_true(count > 0)
+    end)
+
+    it("propagates errors raised by the function", function()
+        local ok, err = pcall(schema.each_error, schema, { id = "1" }, function() error("audit sink failed") end)
+        assert.is_false(ok)
+        assert.is_truthy(tostring(err):find("audit sink failed", 1, true))
+        -- The schema stays usable afterwards
+        assert.is_false(schema:validate({ id = "1" }))
+    end)
+
+    it("rejects invalid arguments", function()
+        assert.has_error(function() schema:each_error({}, "fn") end)
+        assert.has_error(function() schema:each_error("{}", function() end) end)
+        assert.has_error(function() schema:each_error_json("{", function() end) end)
+    end)
+end)
@@ -0,0 +1,83 @@
+-- Tests for the luablaze.ffi module and CompiledSchema:ffi_handle()
+require("spec.spec_helper")
+
+local luablaze = require("luablaze")
+local luablaze_ffi = require("luablaze.ffi")
+
+describe("luablaze.ffi", function()
+    local schema_json = [[{
+        "type": "object",
+        "properties": { "id": { "type": "integer" } },
+        "required": ["id"]
+    }]]
+
+    it("uses the FFI entry point under LuaJIT", function()
+        assert.are.equal(jit ~= nil, luablaze_ffi.available)
+    end)
+
+    it("exposes the schema as a light userdata handle", function()
+        local schema = luablaze.new(schema_json)
+        assert.are.equal("userdata", type(schema:ffi_handle()))
+        assert.are.equal(schema:ffi_handle(), schema:ffi_handle())
+    end)
+
+    it("validates JSON strings like validate_json", function()
+        local schema = luablaze.new(schema_json)
+        local validate = luablaze_ffi.validator(schema)
+        assert.is_true(validate('{"id": 1}'))
+        assert.is_false(validate('{"id": "x"}'))
+        assert.is_false(validate("{}"))
+        assert.is_false(validate(""))
+        for _ = 1, 1000 do
+            assert.is_true(validate('{"id": 2}'))
+        end
+        assert.is_true(luablaze_ffi.validate_json(schema, '{"id": 3}'))
+    end)
+
+    it("parses the whole string, past embedded NUL bytes", function()
+        local schema = luablaze.new('{"type": "string"}')
+        local validate = luablaze_ffi.validator(schema)
+        assert.is_true(validate('"a"'))
+        assert.has_error(function()
+            validate('"a"\0"b"')
+        end)
+    end)
+
+    it("raises on malformed JSON and nesting limits", function()
+        local schema = luablaze.new(schema_json, { max_depth = 2 })
+        local validate = luablaze_ffi.validator(schema)
+        assert.has_error(function()
+            validate("{")
+        end)
+        assert.has_error(function()
+            validate('{"id": [[1]]}')
+        end)
+        assert.is_true(validate('{"id": 1}'))
+    end)
+
+    it("accepts Instance values", function()
+        local schema = luablaze.new(schema_json)
+        local validate = luablaze_ffi.validator(schema)
+        assert.is_true(validate(luablaze.parse('{"id": 1}')))
+        assert.is_false(validate(luablaze.from_table({ id = "x" })))
+    end)
+
+    it("records schema stats", function()
+        local schema = luablaze.new(schema_json, { stats = true })
+        local validate = luablaze_ffi.validator(schema)
+        assert.is_true(validate('{"id": 1}'))
+        assert.is_false(validate("{}"))
+        pcall(validate, "{")
+
+        local stats = schema:stats()
+        assert.are.equal(2, stats.validations)
+        assert.are.equal(1, stats.invalid)
+        assert.are.equal(1, stats.errors)
+    end)
+
+    it("rejects anything but a CompiledSchema", function()
+        assert.has_error(function()
+            luablaze_ffi.validator({})
+        end)
+    end)
+end)
@@ -0,0 +1,69 @@
+-- Tests for CompiledSchema:validate_file and validate_file_detailed
+require("spec.spec_helper")
+
+local luablaze = require("luablaze")
+
+describe("file validation", function()
+    local schema = luablaze.new([[{
+        "$schema": "http://json-schema.org/draft-07/schema#",
+        "type": "object",
+        "properties": { "name": { "type": "string" } },
+        "required": ["name"]
+    }]], { max_depth = 8 })
+
+    local paths = {}
+
+    local function write_file(contents)
+        local path = os.tmpname()
+        local file = assert(io.open(path, "wb"))
+        file:write(contents)
+        file:close()
+        paths[#paths + 1] = path
+        return path
+    end
+
+    after_each(function()
+        for _, path in ipairs(paths) do
+            os.remove(path)
+        end
+        paths = {}
+    end)
+
+    it("validates the document stored in a file", function()
+        assert.is_true(schema:validate_file(write_file('{"name":"a"}')))
+        assert.is_false(schema:validate_file(write_file('{"name":1}')))
+        assert.is_true(luablaze.validate_file(schema, write_file('{"name":"b"}\n')))
+    end)
+
+    it("validates large files", function()
+        local items = {}
+        for i = 1, 100000 do
+            items[i] = string.format('"k%d":"v"', i)
+        end
+        local path = write_file('{"name":"x",' .. table.concat(items, ",") .. "}")
+        assert.is_true(schema:validate_file(path))
+    end)
+
+    it("returns a detailed report", function()
+        local path = write_file('{"name":1}')
+        local valid, report = schema:validate_file_detailed(path)
+        assert.is_false(valid)
+        assert.is_false(report.valid)
+        assert.is_table(report.errors)
+
+        local json_valid, json_report = schema:validate_json_detailed('{"name":1}')
+        assert.are.equal(json_valid, valid)
+        assert.are.same(json_report, report)
+    end)
+
+    it("applies max_depth", function()
+        local path = write_file('{"name":"a","x":' .. string.rep("[", 10) .. string.rep("]", 10) .. "}")
+        assert.has_error(function() schema:validate_file(path) end)
+    end)
+
+    it("raises on unreadable, empty or malformed files", function()
+        assert.has_error(function() schema:validate_file("/nonexistent/luablaze/file.json") end)
+        assert.has_error(function() schema:validate_file(write_file("")) end)
+        assert.has_error(function() schema:validate_file(write_file("{")) end)
+    end)
+end)
@@ -121,4 +121,76 @@ describe("CompiledSchema:info()", function()
             assert.equals(0, info.max_depth)
         end)
     end)
+
+    describe("template footprint", function()
+        local object_schema = [[{
+            "$schema": "https://json-schema.org/draft/2020-12/schema",
+            "type": "object",
+            "properties": {
+                "id": { "type": "integer", "minimum": 1 },
+                "name": { "type": "string", "pattern": "^[a-z]+$" },
+                "tags": { "type": "array", "items": { "type": "string" } }
+            },
+            "required": ["id"]
+        }]]
+
+        it("reports instruction count and approximate bytes", function()
+            local small = luablaze.new(simple_schema):info()
+            local large = luablaze.new(object_schema):info()
+            assert.is_true(small.instruction_count > 0)
+            assert.is_true(small.approx_bytes > 0)
+            assert.is_true(large.instruction_count > small.instruction_count)
+            assert.is_true(large.approx_bytes > small.approx_bytes)
+            assert.is_false(large.compact)
+        end)
+
+        it("compacts Fast-mode templates", function()
+            local full = luablaze.new(object_schema)
+            local compact = luablaze.new(object_schema, { compact = true })
+            local info = compact:info()
+            assert.is_true(info.compact)
+            assert.equals(full:info().instruction_count, info.instruction_count)
+            assert.is_true(info.approx_bytes < full:info().approx_bytes)
+
+            local instances = { { id = 1, name = "abc" }, { id = 0 }, { name = "ABC" }, { id = 1, tags = { 1 } } }
+            for _, instance in ipairs(instances) do
+                assert.equals(full:validate(instance), compact:validate(instance))
+            end
+        end)
+
+        it("rejects the methods reporting keyword locations on compact schemas", function()
+            local compact = luablaze.new(object_schema, { compact = true })
+            local calls = {
+                validate_detailed = function() return compact:validate_detailed({ id = 0 }) end,
+                validate_json_detailed = function() return compact:validate_json_detailed('{"id":0}') end,
+                each_error = function() return compact:each_error({ id = 0 }, function() end) end,
+                each_error_json = function() return compact:each_error_json('{"id":0}', function() end) end,
+                profile = function() return compact:profile({ id = 0 }) end,
+            }
+            for method, call in pairs(calls) do
+                local ok, err = pcall(call)
+                assert.is_false(ok)
+                assert.is_truthy(err:find(method .. "() is not available", 1, true))
+                assert.is_truthy(err:find("compact = true", 1, true))
+            end
+        end)
+
+        it("keeps the compact flag through dump/load and acquire", function()
+            local compact = luablaze.new(object_schema, { compact = true })
+            assert.is_true(luablaze.load(compact:dump()):info().compact)
+
+            luablaze.publish("info_spec_compact", compact)
+            assert.is_true(luablaze.acquire("info_spec_compact"):info().compact)
+            luablaze.unpublish("info_spec_compact")
+        end)
+
+        it("rejects compact with Exhaustive mode and after compilation", function()
+            assert.has_error(function()
+                luablaze.new(object_schema, { compact = true, mode = "Exhaustive" })
+            end)
+            assert.has_error(function()
+                luablaze.load(luablaze.new(object_schema):dump(), { compact = true })
+            end)
+        end)
+    end)
 end)
@@ -0,0 +1,114 @@
+-- Tests for luablaze.parse / luablaze.from_table and Instance
+require("spec.spec_helper")
+
+local luablaze = require("luablaze")
+
+describe("parsed instances", function()
+    local envelope = luablaze.new([[{
+        "type": "object",
+        "required": ["type", "tenant"]
+    }]])
+    local tenant = luablaze.new([[{
+        "type": "object",
+        "properties": { "tenant": { "enum": ["acme", "initech"] } }
+    }]], { mode = "Exhaustive" })
+    local body = '{"type": "span", "tenant": "acme", "items": [1, 2]}'
+
+    it("validates one parsed document against several schemas", function()
+        local instance = luablaze.parse(body)
+        assert.is_true(envelope:validate(instance))
+        assert.is_true(tenant:validate(instance))
+        assert.is_true(envelope:validate_json(instance))
+        assert.is_false(luablaze.new('{"type": "array"}'):validate(instance))
+    end)
+
+    it("validates converted tables", function()
+        local instance = luablaze.from_table({ type = "gauge", tenant = "umbrella" })
+        assert.is_true(envelope:validate(instance))
+        assert.is_false(tenant:validate(instance))
+    end)
+
+    it("is accepted by the detailed methods", function()
+        local instance = luablaze.from_table({ type = "gauge", tenant = "umbrella" })
+        local ok, report = tenant:validate_detailed(instance)
+        assert.is_false(ok)
+        assert.is_true(#report.errors > 0)
+        ok = tenant:validate_json_detailed(instance, { format = "flag" })
+        assert.is_false(ok)
+    end)
+
+    it("is accepted by profile and the batch methods", function()
+        local good, bad = luablaze.parse(body), luablaze.from_table({ tenant = "acme" })
+        assert.is_true((envelope:profile(good)))
+        local results, invalid = envelope:validate_many({ good, { type = "x", tenant = "y" }, bad })
+        assert.are.same({ true, true, false }, results)
+        assert.are.equal(1, invalid)
+        results = envelope:validate_json_many({ good, '{"type": 1}', bad })
+        assert.are.same({ true, false, false }, results)
+    end)
+
+    it("is accepted by the parallel, async and track methods", function()
+        local good, bad = luablaze.parse(body), luablaze.from_table({ tenant = "acme" })
+        local results, invalid = envelope:validate_json_parallel({ good, '{"type": 1}', bad, body }, { threads = 2 })
+        assert.are.same({ true, false, false, true }, results)
+        assert.are.equal(2, invalid)
+
+        local job = envelope:validate_json_async(good)
+        good = nil
+        collectgarbage()
+        assert.is_true(job:result())
+        assert.is_false(envelope:validate_json_async(bad):result())
+
+        local instance = luablaze.from_table({ tenant = "acme" })
+        local doc = envelope:track(instance)
+        assert.is_false(doc:validate())
+        doc:set("/type", "span")
+        assert.is_true(doc:validate())
+        assert.are.same({ tenant = "acme" }, instance:to_table())
+    end)
+
+    it("is rejected by the methods taking text, buffers or paths", function()
+        local instance = luablaze.parse(body)
+        assert.has_error(function() envelope:decode_json(instance) end)
+        assert.has_error(function() envelope:validate_ndjson(instance) end)
+        assert.has_error(function() envelope:validate_file(instance) end)
+    end)
+
+    it("is accepted by schema sets", function()
+        local set = luablaze.new_set({ span = envelope }, { discriminator = "/type" })
+        local ok, name = set:validate(luablaze.parse(body))
+        assert.is_true(ok)
+        assert.are.equal("span", name)
+        assert.are.equal("span", set:route(luablaze.parse(body)))
+        assert.is_nil(set:route(luablaze.parse('{"type": "gauge"}')))
+        assert.is_true((set:validate_json(luablaze.parse(body))))
+    end)
+
+    it("ignores the projection of the schema that validates it", function()
+        local projected = luablaze.new([[{
+            "type": "object",
+            "properties": { "nested": { "type": "object", "required": ["id"] } }
+        }]], { project = true })
+        assert.is_false(projected:validate(luablaze.from_table({ nested = {} })))
+        assert.is_true(projected:validate(luablaze.from_table({ nested = { id = 1 } })))
+    end)
+
+    it("converts back to JSON and Lua", function()
+        local instance = luablaze.parse(body)
+        assert.are.same({ type = "span", tenant = "acme", items = { 1, 2 } }, instance:to_table())
+        assert.are.same(instance:to_table(), luablaze.parse(instance:to_json()):to_table())
+    end)
+
+    it("applies its own limits", function()
+        assert.has_error(function() luablaze.parse("[[[[1]]]]", { max_depth = 2 }) end)
+        assert.has_error(function() luablaze.from_table({ 1, 2, 3 }, { max_array_length = 2 }) end)
+        assert.has_error(function() luablaze.parse("{") end)
+        assert.has_error(function() luablaze.parse("{}", "options") end)
+        assert.has_error(function() luablaze.from_table("{}") end)
+    end)
+
+    it("is rejected where a different type is expected", function()
+        assert.has_error(function() envelope:validate(envelope) end)
+        assert.has_error(function() envelope:validate_json({}) end)
+    end)
+end)
@@ -0,0 +1,110 @@
+-- Tests for parsing JSON instance strings (validate_json and friends)
+require("spec.spec_helper")
+
+local luablaze = require("luablaze")
+
+describe("JSON string parsing", function()
+    local any_schema = [[{"$schema":"http://json-schema.org/draft-07/schema#"}]]
+
+    local function nested_arrays(depth)
+        return string.rep("[", depth) .. string.rep("]", depth)
+    end
+
+    describe("max_depth", function()
+        it("accepts documents exactly at the limit", function()
+            local schema = luablaze.new(any_schema, { max_depth = 10 })
+            assert.is_true(schema:validate_json(nested_arrays(10)))
+        end)
+
+        it("rejects documents one level above the limit", function()
+            local schema = luablaze.new(any_schema, { max_depth = 10 })
+            local ok, err = pcall(function() schema:validate_json(nested_arrays(11)) end)
+            assert.is_false(ok)
+            assert.is_truthy(err:match("maximum nesting depth exceeded"))
+        end)
+
+        it("counts objects and arrays alike", function()
+            local schema = luablaze.new(any_schema, { max_depth = 3 })
+            assert.is_true(schema:validate_json('{"a":[{"b":1}]}'))
+            assert.has_error(function() schema:validate_json('{"a":[{"b":[1]}]}') end)
+        end)
+
+        it("ignores brackets inside strings", function()
+            local schema = luablaze.new(any_schema, { max_depth = 2 })
+            assert.is_true(schema:validate_json('{"a":"[[[[{{{{"}'))
+            assert.is_true(schema:validate_json('{"a":"\\"[[[[\\\\"}'))
+        end)
+
+        it("does not limit depth when max_depth is 0", function()
+            local schema = luablaze.new(any_schema, { max_depth = 0 })
+            assert.is_true(schema:validate_json(nested_arrays(500)))
+        end)
+
+        it("applies to the schema itself", function()
+            local ok, err = pcall(function()
+                luablaze.new('{"properties":{"a":{"properties":{"b":{}}}}}', { max_depth = 3 })
+            end)
+            assert.is_false(ok)
+            assert.is_truthy(err:match("maximum nesting depth exceeded"))
+        end)
+    end)
+
+    describe("parsing from Lua string memory", function()
+        it("parses large documents", function()
+            local schema = luablaze.new([[{
+                "$schema": "http://json-schema.org/draft-07/schema#",
+                "type": "array",
+                "items": { "type": "string" }
+            }]])
+            local parts = {}
+            for i = 1, 20000 do
+                parts[i] = '"item-' .. i .. '"'
+            end
+            assert.is_true(schema:validate_json("[" .. table.concat(parts, ",") .. "]"))
+        end)
+
+        it("reports malformed documents", function()
+            local schema = luablaze.new(any_schema)
+            assert.has_error(function() schema:validate_json('{"a":') end)
+            assert.has_error(function() schema:validate_json('') end)
+            assert.has_error(function() schema:validate_json('"unterminated') end)
+        end)
+
+        it("rejects raw NUL bytes inside strings", function()
+            local schema = luablaze.new([[{
+                "$schema": "http://json-schema.org/draft-07/schema#",
+                "const": "ab"
+            }]])
+            assert.is_true(schema:validate_json('"ab"'))
+            assert.has_error(function() schema:validate_json('"a\0b"') end)
+        end)
+
+        it("round-trips escaped NUL characters", function()
+            local schema = luablaze.new([[{
+                "$schema": "http://json-schema.org/draft-07/schema#",
+                "const": "a\u0000b"
+            }]])
+            assert.is_true(schema:validate_json('"a\\u0000b"'))
+            assert.is_false(schema:validate_json('"ab"'))
+
+            local ok, value = schema:decode_json('"a\\u0000b"')
+            assert.is_true(ok)
+            assert.are.equal("a\0b", value)
+            assert.are.equal(3, #value)
+        end)
+
+        it("round-trips object keys containing escaped NUL characters", function()
+            local schema = luablaze.new([[{
+                "$schema": "http://json-schema.org/draft-07/schema#",
+                "type": "object",
+                "required": ["a\u0000b"]
+            }]])
+            local ok, value = schema:decode_json('{"a\\u0000b":1,"a":2}')
+            assert.is_true(ok)
+            assert.are.equal(1, value["a\0b"])
+            assert.are.equal(2, value.a)
+            assert.is_true(schema:validate(value))
+            assert.is_false(schema:validate({ a = 1 }))
+        end)
+    end)
+end)
@@ -0,0 +1,128 @@
+-- Tests for lazy Report userdata returned by the *_detailed methods
+require("spec.spec_helper")
+
+local luablaze = require("luablaze")
+
+describe("lazy reports", function()
+    local schema = luablaze.new([[{
+        "$schema": "http://json-schema.org/draft-07/schema#",
+        "type": "object",
+        "properties": {
+            "a": { "type": "integer" },
+            "b": { "type": "integer" }
+        }
+    }]], { mode = "Exhaustive" })
+
+    local bad = '{"a":"x","b":"y"}'
+
+    it("indexes like the table report", function()
+        local _, eager = schema:validate_json_detailed(bad)
+        local ok, report = schema:validate_json_detailed(bad, { lazy = true })
+        assert.is_false(ok)
+        assert.are.equal("userdata", type(report))
+        assert.is_false(report.valid)
+        assert.are.equal(#eager.errors, #report.errors)
+        assert.are.equal(eager.errors[1].instanceLocation, report.errors[1].instanceLocation)
+        assert.are.equal(eager.errors[1].keywordLocation, report.errors[1].keywordLocation)
+        assert.is_nil(report.errors[#eager.errors + 1])
+        assert.is_nil(report.missing)
+    end)
+
+    it("converts back to the eager table form", function()
+        local _, eager = schema:validate_json_detailed(bad)
+        local _, report = schema:validate_json_detailed(bad, { lazy = true })
+        assert.are.same(eager, report:to_table())
+        assert.are.same(eager.errors[1], report.errors[1]:to_table())
+    end)
+
+    it("iterates over objects and arrays with the pairs method", function()
+        local _, report = schema:validate_detailed({ a = "x" }, { lazy = true })
+        local keys = {}
+        for key in report:pairs() do
+            keys[#keys + 1] = key
+        end
+        table.sort(keys)
+        assert.are.same({ "errors", "valid" }, keys)
+
+        local count = 0
+        for index, entry in report.errors:pairs() do
+            count = count + 1
+            assert.are.equal(count, index)
+            assert.is_string(entry.instanceLocation)
+        end
+        assert.are.equal(#report.errors, count)
+    end)
+
+    it("keeps concurrent iterations over one view independent", function()
+        local _, report = schema:validate_json_detailed(bad, { lazy = true })
+        local entry = report.errors[1]
+        local outer, inner = {}, {}
+        for key in entry:pairs() do
+            outer[#outer + 1] = key
+            for nested in entry:pairs() do
+                inner[#inner + 1] = nested
+            end
+        end
+        table.sort(outer)
+        assert.are.same({ "absoluteKeywordLocation", "error", "instanceLocation", "keywordLocation" }, outer)
+        assert.are.equal(#outer * #outer, #inner)
+    end)
+
+    -- Lua 5.1 and LuaJIT ignore __pairs on userdata
+    local supports_pairs = _VERSION ~= "Lua 5.1"
+    local it_pairs = supports_pairs and it or pending
+
+    it_pairs("supports pairs over objects and arrays", function()
+        local _, report = schema:validate_detailed({ a = "x" }, { lazy = true })
+        local keys = {}
+        for key in pairs(report) do
+            keys[#keys + 1] = key
+        end
+        table.sort(keys)
+        assert.are.same({ "errors", "valid" }, keys)
+
+        local count = 0
+        for index, entry in pairs(report.errors) do
+            count = count + 1
+            assert.are.equal(count, index)
+            assert.is_string(entry.instanceLocation)
+        end
+        assert.are.equal(#report.errors, count)
+    end)
+
+    it("provides error_count, first_error and to_json", function()
+        local _, eager = schema:validate_json_detailed(bad)
+        local _, report = schema:validate_json_detailed(bad, { lazy = true })
+        assert.are.equal(#eager.errors, report:error_count())
+        assert.are.same(eager.errors[1], report:first_error())
+        assert.is_truthy(report:to_json():match('"valid":false'))
+        assert.is_truthy(report.errors[1]:to_json():match('"instanceLocation"'))
+    end)
+
+    it("reports no errors for valid instances", function()
+        local ok, report = schema:validate_json_detailed('{"a":1}', { lazy = true })
+        assert.is_true(ok)
+        assert.is_true(report.valid)
+        assert.are.equal(0, report:error_count())
+        assert.is_nil(report:first_error())
+    end)
+
+    it("keeps nested views alive after the root is collected", function()
+        local _, report = schema:validate_json_detailed(bad, { lazy = true })
+        local errors = report.errors
+        report = nil
+        collectgarbage()
+        collectgarbage()
+        assert.is_string(errors[1].keywordLocation)
+    end)
+
+    it("combines with max_errors and the flag format", function()
+        local _, bounded = schema:validate_json_detailed(bad, { lazy = true, max_errors = 1 })
+        assert.are.equal(1, bounded:error_count())
+        assert.is_true(bounded.truncated)
+
+        local _, flag = schema:validate_json_detailed(bad, { lazy = true, format = "flag" })
+        assert.is_false(flag.valid)
+        assert.are.equal(0, flag:error_count())
+    end)
+end)
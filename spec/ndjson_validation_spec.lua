@@ -0,0 +1,66 @@
+-- Tests for CompiledSchema:validate_ndjson
+require("spec.spec_helper")
+
+local luablaze = require("luablaze")
+
+describe("NDJSON validation", function()
+    local schema = luablaze.new([[{
+        "$schema": "http://json-schema.org/draft-07/schema#",
+        "type": "object",
+        "required": ["id"]
+    }]], { max_depth = 4 })
+
+    it("counts valid and invalid records", function()
+        local summary = schema:validate_ndjson('{"id":1}\n{"id":2}\n{}\n{"id":3}\n')
+        assert.are.equal(4, summary.records)
+        assert.are.equal(3, summary.valid)
+        assert.are.equal(1, summary.invalid)
+        assert.is_false(summary.stopped)
+        assert.are.equal(1, #summary.failures)
+        assert.are.equal(3, summary.failures[1].line)
+        assert.is_nil(summary.failures[1].error)
+    end)
+
+    it("reports byte positions usable with string.sub", function()
+        local buffer = '{"id":1}\n{"x":1}\n'
+        local failure = schema:validate_ndjson(buffer).failures[1]
+        assert.are.equal('{"x":1}', buffer:sub(failure.position, failure.position + 6))
+    end)
+
+    it("skips blank lines and accepts CRLF and a missing final newline", function()
+        local summary = schema:validate_ndjson('\r\n{"id":1}\r\n  \n\n{"id":2}')
+        assert.are.equal(2, summary.records)
+        assert.are.equal(0, summary.invalid)
+    end)
+
+    it("treats malformed records as failures", function()
+        local summary = schema:validate_ndjson('{"id":1}\n{"id":\n[[[[[[]]]]]]\n')
+        assert.are.equal(3, summary.records)
+        assert.are.equal(2, summary.invalid)
+        assert.are.equal(2, summary.failures[1].line)
+        assert.is_string(summary.failures[1].error)
+        assert.is_truthy(summary.failures[2].error:match("maximum nesting depth exceeded"))
+    end)
+
+    it("stops after max_failures", function()
+        local summary = schema:validate_ndjson('{}\n{}\n{}\n{"id":1}\n', { max_failures = 2 })
+        assert.are.equal(2, summary.records)
+        assert.are.equal(2, summary.invalid)
+        assert.is_true(summary.stopped)
+
+        local exact = schema:validate_ndjson('{}\n{}\n', { max_failures = 2 })
+        assert.is_false(exact.stopped)
+    end)
+
+    it("can count without listing failures", function()
+        local summary = schema:validate_ndjson('{}\n{}\n', { failures = false })
+        assert.are.equal(2, summary.invalid)
+        assert.are.same({}, summary.failures)
+    end)
+
+    it("handles empty buffers and rejects bad options", function()
+        assert.are.equal(0, schema:validate_ndjson("").records)
+        assert.has_error(function() schema:validate_ndjson("", { max_failures = -1 }) end)
+        assert.has_error(function() schema:validate_ndjson("", { failures = 1 }) end)
+    end)
+end)
@@ -0,0 +1,69 @@
+-- Tests for CompiledSchema:validate_json_parallel
+require("spec.spec_helper")
+
+local luablaze = require("luablaze")
+
+describe("parallel validation", function()
+    local schema = luablaze.new([[{
+        "$schema": "http://json-schema.org/draft-07/schema#",
+        "type": "object",
+        "properties": { "n": { "type": "integer", "minimum": 0 } },
+        "required": ["n"]
+    }]], { max_depth = 8 })
+
+    local function batch(count)
+        local instances = {}
+        for i = 1, count do
+            instances[i] = string.format('{"n":%d}', (i % 3 == 0) and -i or i)
+        end
+        return instances
+    end
+
+    it("matches validate_json_many in input order", function()
+        local instances = batch(1000)
+        local expected, expected_invalid = schema:validate_json_many(instances)
+        for _, threads in ipairs({ 1, 2, 4, 16 }) do
+            local results, invalid = schema:validate_json_parallel(instances, { threads = threads })
+            assert.are.same(expected, results)
+            assert.are.equal(expected_invalid, invalid)
+        end
+    end)
+
+    it("uses the hardware concurrency by default", function()
+        local results, invalid = schema:validate_json_parallel(batch(10))
+        assert.are.equal(10, #results)
+        assert.are.equal(3, invalid)
+    end)
+
+    it("supports failures_only", function()
+        local failures, invalid = schema:validate_json_parallel(batch(9), { threads = 3, failures_only = true })
+        assert.are.same({ 3, 6, 9 }, failures)
+        assert.are.equal(3, invalid)
+    end)
+
+    it("handles empty batches", function()
+        local results, invalid = schema:validate_json_parallel({}, { threads = 4 })
+        assert.are.same({}, results)
+        assert.are.equal(0, invalid)
+    end)
+
+    it("reports the first element that fails to parse", function()
+        local instances = batch(50)
+        instances[20] = "{"
+        instances[40] = string.rep("[", 9) .. string.rep("]", 9)
+        local ok, err = pcall(function() schema:validate_json_parallel(instances, { threads = 4 }) end)
+        assert.is_false(ok)
+        assert.is_truthy(err:match("instances%[20%]"))
+    end)
+
+    it("rejects non-string elements and bad options", function()
+        assert.has_error(function() schema:validate_json_parallel({ '{"n":1}', {} }) end)
+        assert.has_error(function() schema:validate_json_parallel({}, { threads = -1 }) end)
+        assert.has_error(function() schema:validate_json_parallel({}, { threads = 1.5 }) end)
+    end)
+
+    it("is available as a functional form", function()
+        local results = luablaze.validate_json_parallel(schema, { '{"n":1}' }, { threads = 2 })
+        assert.are.same({ true }, results)
+    end)
+end)
@@ -0,0 +1,152 @@
+-- Tests for the parse-time limits on JSON instance strings
+require("spec.spec_helper")
+
+local luablaze = require("luablaze")
+
+describe("parse limits", function()
+    local any_schema = [[{"$schema":"http://json-schema.org/draft-07/schema#"}]]
+
+    local function array_of(count)
+        local items = {}
+        for i = 1, count do
+            items[i] = tostring(i)
+        end
+        return "[" .. table.concat(items, ",") .. "]"
+    end
+
+    local function object_of(count)
+        local members = {}
+        for i = 1, count do
+            members[i] = string.format('"k%d":%d', i, i)
+        end
+        return "{" .. table.concat(members, ",") .. "}"
+    end
+
+    local function assert_rejected(fn, option)
+        local ok, err = pcall(fn)
+        assert.is_false(ok)
+        assert.is_truthy(tostring(err):find(option, 1, true))
+    end
+
+    it("is unlimited by default", function()
+        local info = luablaze.new(any_schema):info()
+        assert.are.equal(0, info.max_input_bytes)
+        assert.are.equal(0, info.max_json_array_length)
+        assert.are.equal(0, info.max_string_length)
+        assert.are.equal(0, info.max_object_properties)
+
+        local schema = luablaze.new(any_schema)
+        assert.is_true(schema:validate_json('"' .. string.rep("x", 100000) .. '"'))
+        assert.is_true(schema:validate_json(object_of(1000)))
+    end)
+
+    it("does not apply max_array_length to JSON text", function()
+        local schema = luablaze.new(any_schema, { max_array_length = 3 })
+        assert.is_true(schema:validate_json(array_of(10)))
+        assert.has_error(function() schema:validate({ 1, 2, 3, 4 }) end)
+    end)
+
+    it("reports the configured limits", function()
+        local info = luablaze.new(any_schema, {
+            max_input_bytes = 1024,
+            max_json_array_length = 32,
+            max_string_length = 16,
+            max_object_properties = 8,
+        }):info()
+        assert.are.equal(1024, info.max_input_bytes)
+        assert.are.equal(32, info.max_json_array_length)
+        assert.are.equal(16, info.max_string_length)
+        assert.are.equal(8, info.max_object_properties)
+    end)
+
+    it("rejects options that are not non-negative integers", function()
+        assert.has_error(function() luablaze.new(any_schema, { max_input_bytes = -1 }) end)
+        assert.has_error(function() luablaze.new(any_schema, { max_string_length = "10" }) end)
+        assert.has_error(function() luablaze.new(any_schema, { max_object_properties = 1.5 }) end)
+    end)
+
+    it("enforces max_input_bytes", function()
+        local schema = luablaze.new(any_schema, { max_input_bytes = 8 })
+        assert.is_true(schema:validate_json("12345678"))
+        assert_rejected(function() schema:validate_json("123456789") end, "max_input_bytes")
+    end)
+
+    it("enforces max_json_array_length on JSON arrays at any depth", function()
+        local schema = luablaze.new(any_schema, { max_json_array_length = 3 })
+        assert.is_true(schema:validate_json(array_of(3)))
+        assert.is_true(schema:validate_json("[]"))
+        assert.is_true(schema:validate_json('{"a":[1,2,3],"b":[[1,2,3],[4]]}'))
+        assert_rejected(function() schema:validate_json(array_of(4)) end, "max_json_array_length")
+        assert_rejected(function() schema:validate_json('{"a":[[1,2,3,4]]}') end, "max_json_array_length")
+        -- Commas inside strings are not elements
+        assert.is_true(schema:validate_json('["a,b,c,d,e"]'))
+    end)
+
+    it("enforces max_string_length on values and property names", function()
+        local schema = luablaze.new(any_schema, { max_string_length = 4 })
+        assert.is_true(schema:validate_json('"abcd"'))
+        assert.is_true(schema:validate_json('{"abcd":"wxyz"}'))
+        -- Escape sequences count once
+        assert.is_true(schema:validate_json('"\\u0041\\"cd"'))
+        assert_rejected(function() schema:validate_json('"abcde"') end, "max_string_length")
+        assert_rejected(function() schema:validate_json('{"abcde":1}') end, "max_string_length")
+    end)
+
+    it("enforces max_object_properties", function()
+        local schema = luablaze.new(any_schema, { max_object_properties = 2 })
+        assert.is_true(schema:validate_json(object_of(2)))
+        assert.is_true(schema:validate_json("{}"))
+        assert.is_true(schema:validate_json(array_of(10)))
+        assert_rejected(function() schema:validate_json(object_of(3)) end, "max_object_properties")
+        assert_rejected(function() schema:validate_json('[{"a":1,"b":2,"c":3}]') end, "max_object_properties")
+    end)
+
+    it("rejects before parsing, so malformed tails are never reached", function()
+        local schema = luablaze.new(any_schema, { max_json_array_length = 2 })
+        assert_rejected(function() schema:validate_json("[1,2,3" .. string.rep("!", 100)) end, "max_json_array_length")
+    end)
+
+    it("applies to every method taking JSON text", function()
+        local schema = luablaze.new(any_schema, { max_object_properties = 1 })
+        local json = object_of(2)
+        assert_rejected(function() schema:validate_json_detailed(json) end, "max_object_properties")
+        assert_rejected(function() schema:decode_json(json) end, "max_object_properties")
+        assert_rejected(function() schema:each_error_json(json, function() end) end, "max_object_properties")
+        assert_rejected(function() schema:validate_json_many({ "{}", json }) end, "max_object_properties")
+        assert_rejected(function() schema:validate_json_parallel({ "{}", json }) end, "max_object_properties")
+
+        local summary = schema:validate_ndjson("{}\n" .. json .. "\n")
+        assert.are.equal(2, summary.records)
+        assert.are.equal(1, summary.invalid)
+    end)
+
+    it("does not apply to Lua tables", function()
+        local schema = luablaze.new(any_schema, { max_object_properties = 1, max_string_length = 1 })
+        assert.is_true(schema:validate({ a = "long string", b = 2 }))
+    end)
+
+    it("is accepted by luablaze.parse", function()
+        assert.is_truthy(luablaze.parse(array_of(3), { max_json_array_length = 3 }))
+        assert_rejected(function()
+            luablaze.parse(array_of(4), { max_json_array_length = 3 })
+        end, "max_json_array_length")
+        assert_rejected(function() luablaze.parse('"abc"', { max_string_length = 2 }) end, "max_string_length")
+    end)
+
+    it("bounds the nesting it counts when max_depth is 0", function()
+        local schema = luablaze.new(any_schema, { max_depth = 0, max_object_properties = 4 })
+        assert.is_true(schema:validate_json(string.rep("[", 200) .. string.rep("]", 200)))
+        -- Rejected by the scan, before the parser sees it
+        assert_rejected(function()
+            schema:validate_json(string.rep("[", 5000) .. string.rep("]", 5000))
+        end, "max_depth")
+    end)
+
+    it("is inherited by luablaze.acquire", function()
+        luablaze.publish("parse_limits_spec", luablaze.new(any_schema, { max_input_bytes = 4 }))
+        local acquired = luablaze.acquire("parse_limits_spec")
+        assert.are.equal(4, acquired:info().max_input_bytes)
+        assert_rejected(function() acquired:validate_json("123456") end, "max_input_bytes")
+        luablaze.unpublish("parse_limits_spec")
+    end)
+end)
@@ -0,0 +1,74 @@
+-- Tests for CompiledSchema:profile
+require("spec.spec_helper")
+
+local luablaze = require("luablaze")
+
+describe("schema profiling", function()
+    local schema_json = [[{
+        "$schema": "https://json-schema.org/draft/2020-12/schema",
+        "type": "object",
+        "properties": {
+            "name": { "type": "string", "pattern": "^[a-z]+$" },
+            "value": { "oneOf": [{ "type": "integer" }, { "type": "string" }] }
+        }
+    }]]
+
+    local function find(keywords, suffix)
+        for _, keyword in ipairs(keywords) do
+            if keyword.keyword_location:sub(-#suffix) == suffix then
+                return keyword
+            end
+        end
+        return nil
+    end
+
+    it("reports per-keyword calls and times", function()
+        local schema = luablaze.new(schema_json, { mode = "Exhaustive" })
+        local valid, keywords = schema:profile({ name = "abc", value = 1 })
+        assert.is_true(valid)
+        assert.is_true(#keywords > 0)
+
+        local pattern = find(keywords, "/properties/name/pattern")
+        assert.is_not_nil(pattern)
+        assert.are.equal(1, pattern.calls)
+        assert.are.equal(0, pattern.failures)
+        assert.is_true(pattern.seconds >= pattern.self_seconds)
+        assert.is_true(pattern.self_seconds >= 0)
+    end)
+
+    it("sorts keywords by descending time", function()
+        local schema = luablaze.new(schema_json)
+        local _, keywords = schema:profile('{"name":"abc","value":"x"}')
+        for i = 2, #keywords do
+            assert.is_true(keywords[i - 1].seconds >= keywords[i].seconds)
+        end
+    end)
+
+    it("counts failures and agrees with validate", function()
+        local schema = luablaze.new(schema_json, { mode = "Exhaustive" })
+        local instance = { name = "ABC" }
+        local valid, keywords = schema:profile(instance)
+        assert.are.equal(schema:validate(instance), valid)
+        assert.is_false(valid)
+        assert.are.equal(1, find(keywords, "/properties/name/pattern").failures)
+    end)
+
+    it("accumulates over iterations", function()
+        local schema = luablaze.new(schema_json, { mode = "Exhaustive" })
+        local _, keywords = schema:profile({ name = "abc" }, { iterations = 3 })
+        assert.are.equal(3, find(keywords, "/properties/name/pattern").calls)
+    end)
+
+    it("rejects invalid arguments", function()
+        local schema = luablaze.new(schema_json)
+        assert.has_error(function()
+            schema:profile(42)
+        end)
+        assert.has_error(function()
+            schema:profile({}, { iterations = 0 })
+        end)
+        assert.has_error(function()
+            schema:profile("{")
+        end)
+    end)
+end)
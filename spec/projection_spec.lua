@@ -0,0 +1,118 @@
+-- Tests for the project option of luablaze.new
+require("spec.spec_helper")
+
+local luablaze = require("luablaze")
+
+describe("schema-driven projection", function()
+    local schema_json = [[{
+        "$schema": "https://json-schema.org/draft/2020-12/schema",
+        "title": "span",
+        "type": "object",
+        "required": ["name", "attributes"],
+        "properties": {
+            "name": { "type": "string", "minLength": 1 },
+            "attributes": {
+                "type": "object",
+                "properties": { "service": { "type": "string" } },
+                "additionalProperties": true
+            },
+            "debug": {}
+        },
+        "maxProperties": 4
+    }]]
+
+    local function cyclic()
+        local blob = { payload = string.rep("x", 1024) }
+        blob.self = blob
+        return blob
+    end
+
+    it("validates like a full conversion", function()
+        local full = luablaze.new(schema_json)
+        local projected = luablaze.new(schema_json, { project = true })
+        local instances = {
+            { name = "a", attributes = { service = "api" } },
+            { name = "", attributes = {} },
+            { name = "a", attributes = { service = 1 } },
+            { name = "a", attributes = "x" },
+            { name = "a" },
+            { name = "a", attributes = {}, debug = { 1, 2, 3 }, extra = true },
+            { name = "a", attributes = {}, debug = {}, extra = true, more = 1 },
+        }
+        for i, instance in ipairs(instances) do
+            assert.are.equal(full:validate(instance), projected:validate(instance), "instance " .. i)
+        end
+    end)
+
+    it("does not convert unobserved subtrees", function()
+        local full = luablaze.new(schema_json)
+        local projected = luablaze.new(schema_json, { project = true })
+        local instance = { name = "a", attributes = { service = "api", resource = cyclic() }, debug = cyclic() }
+
+        assert.has_error(function()
+            full:validate(instance)
+        end)
+        assert.is_true(projected:validate(instance))
+    end)
+
+    it("still converts unobserved scalars", function()
+        local projected = luablaze.new(schema_json, { project = true })
+        assert.has_error(function()
+            projected:validate({ name = "a", attributes = {}, debug = print })
+        end)
+    end)
+
+    it("converts everything below keywords it does not understand", function()
+        local schema = luablaze.new([[{
+            "$schema": "https://json-schema.org/draft/2020-12/schema",
+            "type": "object",
+            "properties": { "nested": { "$ref": "#/$defs/any" } },
+            "patternProperties": { "^x-": { "type": "string" } },
+            "$defs": { "any": {} }
+        }]], { project = true })
+        assert.has_error(function()
+            schema:validate({ nested = cyclic() })
+        end)
+        assert.is_false(schema:validate({ ["x-id"] = 1 }))
+    end)
+
+    it("converts schemas in older drafts in full", function()
+        local schema = luablaze.new([[{
+            "$schema": "http://json-schema.org/draft-07/schema#",
+            "type": "object",
+            "properties": {
+                "pair": { "type": "array", "items": [{ "type": "string" }, {}], "additionalItems": false },
+                "debug": {}
+            }
+        }]], { project = true })
+        assert.is_true(schema:validate({ pair = { "a", 1 } }))
+        assert.is_false(schema:validate({ pair = { 1, "a" } }))
+        assert.is_false(schema:validate({ pair = { "a", 1, 2 } }))
+        assert.has_error(function()
+            schema:validate({ pair = { "a", cyclic() } })
+        end)
+        assert.has_error(function()
+            schema:validate({ debug = cyclic() })
+        end)
+
+        local defaulted = luablaze.new([[{ "type": "object", "properties": { "debug": {} } }]],
+            { project = true, dialect = "draft7" })
+        assert.has_error(function()
+            defaulted:validate({ debug = cyclic() })
+        end)
+    end)
+
+    it("is shared with acquired schemas and rejected after compilation", function()
+        luablaze.publish("projection_spec", luablaze.new(schema_json, { project = true }))
+        local acquired = luablaze.acquire("projection_spec")
+        luablaze.unpublish("projection_spec")
+        assert.is_true(acquired:validate({ name = "a", attributes = {}, debug = cyclic() }))
+
+        assert.has_error(function()
+            luablaze.acquire("projection_spec", { project = true })
+        end)
+        assert.has_error(function()
+            luablaze.load(luablaze.new(schema_json):dump(), { project = true })
+        end)
+    end)
+end)
@@ -0,0 +1,88 @@
+-- Tests for luablaze.registry() and the registry option of luablaze.new
+require("spec.spec_helper")
+
+local luablaze = require("luablaze")
+
+describe("schema registry", function()
+    local common = [[{
+        "$schema": "https://json-schema.org/draft/2020-12/schema",
+        "$id": "https://example.com/common.json",
+        "$defs": {
+            "id": { "type": "integer", "minimum": 1 },
+            "name": { "$ref": "https://example.com/strings.json" }
+        }
+    }]]
+    local strings = [[{
+        "$schema": "https://json-schema.org/draft/2020-12/schema",
+        "type": "string",
+        "minLength": 1
+    }]]
+    local schema_json = [[{
+        "$schema": "https://json-schema.org/draft/2020-12/schema",
+        "type": "object",
+        "properties": {
+            "id": { "$ref": "https://example.com/common.json#/$defs/id" },
+            "name": { "$ref": "https://example.com/common.json#/$defs/name" }
+        }
+    }]]
+
+    local function make_registry()
+        local registry = luablaze.registry()
+        assert.are.equal("https://example.com/common.json", registry:add(common))
+        assert.are.equal("https://example.com/strings.json", registry:add(strings, "https://example.com/strings.json"))
+        return registry
+    end
+
+    it("resolves references to registered documents", function()
+        local schema = luablaze.new(schema_json, { registry = make_registry() })
+        assert.is_true(schema:validate({ id = 1, name = "a" }))
+        assert.is_false(schema:validate({ id = 0 }))
+        assert.is_false(schema:validate({ name = "" }))
+    end)
+
+    it("fails to compile without the registry", function()
+        assert.has_error(function() luablaze.new(schema_json) end)
+    end)
+
+    it("is reusable across compilations", function()
+        local registry = make_registry()
+        for _ = 1, 10 do
+            assert.is_true(luablaze.new(schema_json, { registry = registry }):validate({ id = 2 }))
+        end
+    end)
+
+    it("supports has, remove and length", function()
+        local registry = make_registry()
+        assert.are.equal(2, #registry)
+        assert.is_true(registry:has("https://example.com/common.json"))
+        assert.is_true(registry:has("https://example.com/common.json#"))
+        assert.is_true(registry:remove("https://example.com/strings.json"))
+        assert.is_false(registry:remove("https://example.com/strings.json"))
+        assert.are.equal(1, #registry)
+        assert.has_error(function() luablaze.new(schema_json, { registry = registry }) end)
+    end)
+
+    it("keys cached templates by registry revision", function()
+        luablaze.cache_clear()
+        local registry = make_registry()
+        local first = luablaze.new(schema_json, { registry = registry, cache = true })
+        assert.is_true(first:validate({ id = 1 }))
+
+        registry:add([[{"$id":"https://example.com/common.json","$defs":{"id":{"type":"integer","minimum":5}}}]])
+        local second = luablaze.new(schema_json, { registry = registry, cache = true })
+        assert.is_false(second:validate({ id = 1 }))
+        assert.is_true(first:validate({ id = 1 }))
+
+        local other = luablaze.new(schema_json, { registry = make_registry(), cache = true })
+        assert.is_true(other:validate({ id = 1 }))
+    end)
+
+    it("rejects invalid registries and documents", function()
+        assert.has_error(function() luablaze.new(schema_json, { registry = {} }) end)
+        assert.has_error(function() luablaze.registry():add("{") end)
+        assert.has_error(function() luablaze.registry():add('{"type":"string"}') end)
+        assert.has_error(function()
+            luablaze.acquire("missing", { registry = luablaze.registry() })
+        end)
+    end)
+end)
@@ -0,0 +1,122 @@
+-- Tests for luablaze.new_set and SchemaSet
+require("spec.spec_helper")
+
+local luablaze = require("luablaze")
+
+describe("schema sets", function()
+    local function event_schema(kind, field, field_type)
+        return luablaze.new(string.format([[{
+            "$schema": "https://json-schema.org/draft/2020-12/schema",
+            "type": "object",
+            "properties": {
+                "type": { "const": "%s" },
+                "%s": { "type": "%s" }
+            },
+            "required": ["type", "%s"]
+        }]], kind, field, field_type, field))
+    end
+
+    local function events(options)
+        return luablaze.new_set({
+            span = event_schema("span", "duration", "number"),
+            gauge = event_schema("gauge", "value", "integer"),
+        }, options or { discriminator = "/type" })
+    end
+
+    it("routes tables to the schema named by the discriminator", function()
+        local set = events()
+        local ok, name = set:validate({ type = "span", duration = 1.5 })
+        assert.is_true(ok)
+        assert.are.equal("span", name)
+
+        ok, name = set:validate({ type = "gauge", value = "high" })
+        assert.is_false(ok)
+        assert.are.equal("gauge", name)
+    end)
+
+    it("routes JSON strings", function()
+        local set = events()
+        local ok, name = set:validate_json('{"type":"gauge","value":3}')
+        assert.is_true(ok)
+        assert.are.equal("gauge", name)
+        assert.is_false((set:validate_json('{"type":"span"}')))
+        assert.has_error(function() set:validate_json("{") end)
+    end)
+
+    it("enforces the parse limits of the selected schema", function()
+        local any = '{ "type": "object" }'
+        local set = luablaze.new_set({
+            strict = luablaze.new(any, { max_depth = 4, max_input_bytes = 1024 }),
+            loose = luablaze.new(any, { max_depth = 0 }),
+        }, { discriminator = "/type" })
+
+        local nested = string.rep("[", 8) .. string.rep("]", 8)
+        assert.is_true((set:validate_json('{"type":"loose","v":' .. nested .. '}')))
+        local ok, err = pcall(set.validate_json, set, '{"type":"strict","v":' .. nested .. '}')
+        assert.is_false(ok)
+        assert.is_truthy(err:find("nesting depth", 1, true))
+
+        local large = '{"type":"%s","v":"' .. string.rep("x", 2048) .. '"}'
+        assert.is_true((set:validate_json(large:format("loose"))))
+        ok, err = pcall(set.validate_json, set, large:format("strict"))
+        assert.is_false(ok)
+        assert.is_truthy(err:find("max_input_bytes", 1, true))
+        assert.is_true((set:validate_json('{"type":"strict","v":[[1]]}')))
+    end)
+
+    it("treats unknown or missing discriminators as invalid", function()
+        local set = events()
+        for _, instance in ipairs({ { type = "counter" }, {}, { type = { "span" } } }) do
+            local ok, name = set:validate(instance)
+            assert.is_false(ok)
+            assert.is_nil(name)
+        end
+        local ok, name = set:validate_json('{"type":"counter"}')
+        assert.is_false(ok)
+        assert.is_nil(name)
+    end)
+
+    it("falls back to the default schema", function()
+        local set = events({ discriminator = "/type", default = "gauge" })
+        assert.are.equal("gauge", set:route({ value = 1 }))
+        assert.is_true((set:validate({ type = "gauge", value = 1 })))
+        assert.are.equal("span", set:route({ type = "span" }))
+    end)
+
+    it("follows nested pointers into objects and arrays", function()
+        local set = luablaze.new_set({
+            ["1"] = luablaze.new('{"type": "object"}'),
+            v2 = luablaze.new('{"type": "object", "required": ["payload"]}'),
+        }, { discriminator = "/meta/versions/0" })
+        assert.are.equal("v2", set:route({ meta = { versions = { "v2" } } }))
+        assert.are.equal("1", set:route({ meta = { versions = { 1 } } }))
+        assert.is_false((set:validate({ meta = { versions = { "v2" } } })))
+        local _, name = set:validate_json('{"meta":{"versions":[1]}}')
+        assert.are.equal("1", name)
+    end)
+
+    it("keeps working after the schemas are collected", function()
+        local set = events()
+        collectgarbage()
+        collectgarbage()
+        assert.is_true((set:validate({ type = "span", duration = 2 })))
+    end)
+
+    it("reports its configuration", function()
+        local info = events({ discriminator = "/type", default = "span" }):info()
+        assert.are.equal("/type", info.discriminator)
+        assert.are.same({ "gauge", "span" }, info.schemas)
+        assert.are.equal("span", info.default)
+    end)
+
+    it("rejects invalid schemas and options", function()
+        local schema = luablaze.new('{"type": "object"}')
+        assert.has_error(function() luablaze.new_set({}, { discriminator = "/type" }) end)
+        assert.has_error(function() luablaze.new_set({ a = "{}" }, { discriminator = "/type" }) end)
+        assert.has_error(function() luablaze.new_set({ schema }, { discriminator = "/type" }) end)
+        assert.has_error(function() luablaze.new_set({ a = schema }, {}) end)
+        assert.has_error(function() luablaze.new_set({ a = schema }, { discriminator = "" }) end)
+        assert.has_error(function() luablaze.new_set({ a = schema }, { discriminator = "type" }) end)
+        assert.has_error(function() luablaze.new_set({ a = schema }, { discriminator = "/type", default = "b" }) end)
+    end)
+end)
@@ -0,0 +1,107 @@
+-- Tests for the stats option and CompiledSchema:stats() / reset_stats()
+require("spec.spec_helper")
+
+local luablaze = require("luablaze")
+
+describe("schema stats", function()
+    local schema_json = [[{
+        "type": "object",
+        "properties": { "id": { "type": "integer" } },
+        "required": ["id"]
+    }]]
+
+    it("is disabled by default", function()
+        local schema = luablaze.new(schema_json)
+        assert.is_true(schema:validate({ id = 1 }))
+        assert.is_nil(schema:stats())
+        schema:reset_stats()
+    end)
+
+    it("counts validations and invalid instances", function()
+        local schema = luablaze.new(schema_json, { stats = true })
+        assert.is_true(schema:validate({ id = 1 }))
+        assert.is_false(schema:validate({}))
+        assert.is_false(schema:validate_json('{"id":"x"}'))
+
+        local stats = schema:stats()
+        assert.are.equal(3, stats.validations)
+        assert.are.equal(2, stats.invalid)
+        assert.are.equal(0, stats.errors)
+        assert.is_true(stats.conversion_seconds >= 0)
+        assert.is_true(stats.parse_seconds >= 0)
+        assert.is_true(stats.evaluation_seconds >= 0)
+        assert.is_true(stats.latency_seconds >= stats.evaluation_seconds)
+    end)
+
+    it("counts parse failures as errors", function()
+        local schema = luablaze.new(schema_json, { stats = true })
+        assert.has_error(function()
+            schema:validate_json("{")
+        end)
+        local stats = schema:stats()
+        assert.are.equal(0, stats.validations)
+        assert.are.equal(1, stats.errors)
+    end)
+
+    it("returns a cumulative latency histogram", function()
+        local schema = luablaze.new(schema_json, { stats = true })
+        for i = 1, 5 do
+            schema:validate({ id = i })
+        end
+
+        local latency = schema:stats().latency
+        assert.are.equal(8, #latency)
+        assert.are.equal(1e-6, latency[1].le)
+        assert.are.equal(math.huge, latency[#latency].le)
+        assert.are.equal(5, latency[#latency].count)
+        for i = 2, #latency do
+            assert.is_true(latency[i].le > latency[i - 1].le)
+            assert.is_true(latency[i].count >= latency[i - 1].count)
+        end
+    end)
+
+    it("counts batch, NDJSON and detailed validations", function()
+        local schema = luablaze.new(schema_json, { stats = true })
+        schema:validate_many({ { id = 1 }, {} })
+        schema:validate_json_many({ '{"id":1}' })
+        schema:validate_ndjson('{"id":1}\n{\n')
+        schema:validate_detailed({})
+
+        local stats = schema:stats()
+        assert.are.equal(5, stats.validations)
+        assert.are.equal(2, stats.invalid)
+        assert.are.equal(1, stats.errors)
+        assert.is_true(stats.report_seconds >= 0)
+    end)
+
+    it("resets the counters", function()
+        local schema = luablaze.new(schema_json, { stats = true })
+        schema:validate({})
+        schema:reset_stats()
+
+        local stats = schema:stats()
+        assert.are.equal(0, stats.validations)
+        assert.are.equal(0, stats.invalid)
+        assert.are.equal(0, stats.latency_seconds)
+        assert.are.equal(0, stats.latency[#stats.latency].count)
+    end)
+
+    it("keeps separate counters for acquired schemas", function()
+        local published = luablaze.new(schema_json, { stats = true })
+        luablaze.publish("schema_stats_spec", published)
+        local acquired = luablaze.acquire("schema_stats_spec")
+        local plain = luablaze.acquire("schema_stats_spec", { stats = false })
+        luablaze.unpublish("schema_stats_spec")
+
+        acquired:validate({ id = 1 })
+        assert.are.equal(1, acquired:stats().validations)
+        assert.are.equal(0, published:stats().validations)
+        assert.is_nil(plain:stats())
+    end)
+
+    it("rejects a non-boolean stats option", function()
+        assert.has_error(function()
+            luablaze.new(schema_json, { stats = "yes" })
+        end)
+    end)
+end)
@@ -0,0 +1,293 @@
+-- Tests for Lua table -> JSON instance conversion
+require("spec.spec_helper")
+
+local luablaze = require("luablaze")
+
+describe("Lua table conversion", function()
+    describe("strings and keys", function()
+        it("preserves long string values", function()
+            local schema = luablaze.new([[{
+                "$schema": "http://json-schema.org/draft-07/schema#",
+                "type": "object",
+                "properties": { "blob": { "type": "string", "minLength": 4096, "maxLength": 4096 } }
+            }]])
+            assert.is_true(schema:validate({ blob = string.rep("x", 4096) }))
+            assert.is_false(schema:validate({ blob = string.rep("x", 4095) }))
+        end)
+
+        it("preserves long property names", function()
+            local key = string.rep("k", 64)
+            local schema = luablaze.new(string.format([[{
+                "$schema": "http://json-schema.org/draft-07/schema#",
+                "type": "object",
+                "required": ["%s"],
+                "properties": { "%s": { "type": "integer" } }
+            }]], key, key))
+            assert.is_true(schema:validate({ [key] = 1 }))
+            assert.is_false(schema:validate({ [key] = "1" }))
+            assert.is_false(schema:validate({ [key:sub(2)] = 1 }))
+        end)
+
+        it("preserves embedded NUL bytes in strings", function()
+            local schema = luablaze.new([[{
+                "$schema": "http://json-schema.org/draft-07/schema#",
+                "type": "string",
+                "const": "a\u0000b"
+            }]])
+            assert.is_true(schema:validate_json('"a\\u0000b"'))
+            local wrapped = luablaze.new([[{
+                "$schema": "http://json-schema.org/draft-07/schema#",
+                "type": "object",
+                "properties": { "v": { "const": "a\u0000b" } }
+            }]])
+            assert.is_true(wrapped:validate({ v = "a\0b" }))
+            assert.is_false(wrapped:validate({ v = "a" }))
+        end)
+
+        it("keeps every key of wide objects", function()
+            local names, properties, instance = {}, {}, {}
+            for i = 1, 40 do
+                local name = "field_" .. i
+                names[#names + 1] = string.format("%q", name)
+                properties[#properties + 1] = string.format('"%s": { "const": %d }', name, i)
+                instance[name] = i
+            end
+            local schema = luablaze.new(string.format([[{
+                "$schema": "http://json-schema.org/draft-07/schema#",
+                "type": "object",
+                "required": [%s],
+                "properties": { %s },
+                "maxProperties": 40
+            }]], table.concat(names, ", "), table.concat(properties, ", ")))
+            assert.is_true(schema:validate(instance))
+
+            instance.field_17 = 0
+            assert.is_false(schema:validate(instance))
+            instance.field_17 = 17
+            instance.extra = true
+            assert.is_false(schema:validate(instance))
+        end)
+
+        it("converts wide objects without looking up every inserted key", function()
+            -- Checking each new key against the properties already inserted
+            -- makes a 50000-key object cost over a billion comparisons, while
+            -- an array of the same length stays linear.
+            local count = 50000
+            local object, array = {}, {}
+            for i = 1, count do
+                object["k" .. i] = i
+                array[i] = i
+            end
+            local schema = luablaze.new('{ "type": ["object", "array"] }')
+
+            local function fastest(instance)
+                local best = math.huge
+                for _ = 1, 3 do
+                    local started = os.clock()
+                    assert.is_true(schema:validate(instance))
+                    best = math.min(best, os.clock() - started)
+                end
+                return best
+            end
+
+            local array_time = fastest(array)
+            assert.is_true(fastest(object) < 20 * array_time + 0.05)
+        end)
+    end)
+
+    describe("nested values", function()
+        it("converts mixed nested structures like the equivalent JSON", function()
+            local schema = luablaze.new([[{
+                "$schema": "http://json-schema.org/draft-07/schema#",
+                "type": "object",
+                "properties": {
+                    "items": {
+                        "type": "array",
+                        "items": {
+                            "type": "object",
+                            "properties": {
+                                "id": { "type": "integer" },
+                                "score": { "type": "number" },
+                                "ok": { "type": "boolean" }
+                            },
+                            "required": ["id", "score", "ok"]
+                        }
+                    }
+                }
+            }]])
+            local instance = { items = {} }
+            for i = 1, 50 do
+                instance.items[i] = { id = i, score = i / 2, ok = i % 2 == 0 }
+            end
+            assert.is_true(schema:validate(instance))
+            instance.items[25].id = "25"
+            assert.is_false(schema:validate(instance))
+        end)
+
+        it("converts holes in sparse arrays to null", function()
+            local schema = luablaze.new([[{
+                "$schema": "http://json-schema.org/draft-07/schema#",
+                "type": "array",
+                "items": [{ "type": "integer" }, { "type": "null" }, { "type": "integer" }]
+            }]])
+            assert.is_true(schema:validate({ [1] = 1, [3] = 3 }))
+        end)
+    end)
+
+    describe("array/object markers", function()
+        local array_schema = [[{"$schema":"http://json-schema.org/draft-07/schema#","type":"array"}]]
+        local object_schema = [[{"$schema":"http://json-schema.org/draft-07/schema#","type":"object"}]]
+
+        it("exposes the marker metatables", function()
+            assert.is_table(luablaze.array_mt)
+            assert.is_table(luablaze.object_mt)
+            assert.equals("array", luablaze.array_mt.__jsontype)
+            assert.equals("object", luablaze.object_mt.__jsontype)
+        end)
+
+        it("treats unmarked empty tables as objects", function()
+            assert.is_true(luablaze.new(object_schema):validate({}))
+            assert.is_false(luablaze.new(array_schema):validate({}))
+        end)
+
+        it("treats empty tables marked with array_mt as arrays", function()
+            local empty = setmetatable({}, luablaze.array_mt)
+            assert.is_true(luablaze.new(array_schema):validate(empty))
+            assert.is_false(luablaze.new(object_schema):validate(empty))
+        end)
+
+        it("treats tables marked with object_mt as objects", function()
+            local empty = setmetatable({}, luablaze.object_mt)
+            assert.is_true(luablaze.new(object_schema):validate(empty))
+        end)
+
+        it("honors the __jsontype convention", function()
+            local empty = setmetatable({}, { __jsontype = "array" })
+            assert.is_true(luablaze.new(array_schema):validate(empty))
+        end)
+
+        it("honors registered foreign metatables", function()
+            local foreign_mt = {}
+            luablaze.register_metatable(foreign_mt, "array")
+            local empty = setmetatable({}, foreign_mt)
+            assert.is_true(luablaze.new(array_schema):validate(empty))
+
+            luablaze.register_metatable(foreign_mt, nil)
+            assert.is_false(luablaze.new(array_schema):validate(empty))
+        end)
+
+        it("rejects unknown marker kinds", function()
+            assert.has_error(function()
+                luablaze.register_metatable({}, "list")
+            end)
+        end)
+
+        it("rejects non-integer keys in marked arrays", function()
+            local t = setmetatable({ 1, 2, name = "x" }, luablaze.array_mt)
+            local ok, err = pcall(function() luablaze.new(array_schema):validate(t) end)
+            assert.is_false(ok)
+            assert.is_truthy(err:find("Array table keys must be positive integers (found string)", 1, true))
+        end)
+
+        it("rejects integer keys in marked objects", function()
+            local t = setmetatable({ 1, 2 }, luablaze.object_mt)
+            local ok, err = pcall(function() luablaze.new(object_schema):validate(t) end)
+            assert.is_false(ok)
+            assert.is_truthy(err:match("Object table keys must be strings"))
+        end)
+    end)
+
+    describe("single-pass classification", function()
+        it("rejects tables mixing integer and string keys", function()
+            local schema = luablaze.new([[{"$schema":"http://json-schema.org/draft-07/schema#"}]])
+            local ok, err = pcall(function() schema:validate({ 1, 2, name = "x" }) end)
+            assert.is_false(ok)
+            assert.is_truthy(err:match("Object table keys must be strings"))
+            assert.is_truthy(err:find("found both number and string keys", 1, true))
+
+            ok, err = pcall(function() schema:validate({ name = "x", [1] = 1 }) end)
+            assert.is_false(ok)
+            assert.is_truthy(err:match("Object table keys must be strings"))
+        end)
+
+        it("orders integer keys inserted out of sequence", function()
+            local schema = luablaze.new([[{
+                "$schema": "http://json-schema.org/draft-07/schema#",
+                "type": "array",
+                "items": [{ "const": "a" }, { "const": "b" }, { "const": "c" }],
+                "minItems": 3,
+                "maxItems": 3
+            }]])
+            local t = {}
+            t[3] = "c"
+            t[1] = "a"
+            t[2] = "b"
+            assert.is_true(schema:validate(t))
+        end)
+
+        it("rejects arrays above max_array_length", function()
+            local schema = luablaze.new([[{"$schema":"http://json-schema.org/draft-07/schema#","type":"array"}]],
+                { max_array_length = 3 })
+            assert.is_true(schema:validate({ 1, 2, 3 }))
+            local ok, err = pcall(function() schema:validate({ 1, 2, 3, 4 }) end)
+            assert.is_false(ok)
+            assert.is_truthy(err:match("max_array_length"))
+        end)
+    end)
+
+    describe("cycle detection", function()
+        local any_schema = [[{"$schema":"http://json-schema.org/draft-07/schema#"}]]
+
+        local function nested(depth)
+            local root = {}
+            local node = root
+            for _ = 1, depth - 1 do
+                node.child = {}
+                node = node.child
+            end
+            return root, node
+        end
+
+        it("allows the same table in sibling positions", function()
+            local shared = { value = 1 }
+            local schema = luablaze.new(any_schema)
+            assert.is_true(schema:validate({ a = shared, b = shared, list = { shared, shared } }))
+        end)
+
+        it("detects cycles in deeply nested tables", function()
+            local schema = luablaze.new(any_schema, { max_recursion_depth = 0 })
+            local root, leaf = nested(90)
+            leaf.back = root
+            local ok, err = pcall(function() schema:validate(root) end)
+            assert.is_false(ok)
+            assert.is_truthy(err:match("Cycle detected"))
+        end)
+
+        it("detects cycles that close below the linear scan window", function()
+            local schema = luablaze.new(any_schema, { max_recursion_depth = 0 })
+            local root, leaf = nested(120)
+            leaf.back = root.child.child.child
+            local ok, err = pcall(function() schema:validate(root) end)
+            assert.is_false(ok)
+            assert.is_truthy(err:match("Cycle detected"))
+
+            local deep = root
+            for _ = 1, 100 do
+                deep = deep.child
+            end
+            leaf.back = deep
+            ok, err = pcall(function() schema:validate(root) end)
+            assert.is_false(ok)
+            assert.is_truthy(err:match("Cycle detected"))
+        end)
+
+        it("recovers after a failed conversion", function()
+            local schema = luablaze.new(any_schema)
+            local cyclic = {}
+            cyclic.self = cyclic
+            assert.has_error(function() schema:validate(cyclic) end)
+            local shared = { x = 1 }
+            assert.is_true(schema:validate({ a = shared, b = shared }))
+        end)
+    end)
+end)
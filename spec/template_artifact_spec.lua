@@ -0,0 +1,60 @@
+-- Tests for CompiledSchema:dump() and luablaze.load()
+require("spec.spec_helper")
+
+local luablaze = require("luablaze")
+
+describe("template artifacts", function()
+    local schema_json = [[{
+        "$schema": "https://json-schema.org/draft/2020-12/schema",
+        "type": "object",
+        "properties": {
+            "name": { "type": "string", "minLength": 1 },
+            "tags": { "type": "array", "items": { "type": "string" } }
+        },
+        "required": ["name"]
+    }]]
+
+    it("round-trips a compiled schema", function()
+        local artifact = luablaze.new(schema_json):dump()
+        assert.are.equal("string", type(artifact))
+
+        local schema = luablaze.load(artifact)
+        assert.is_true(schema:validate({ name = "a", tags = { "x" } }))
+        assert.is_false(schema:validate({ name = "" }))
+        assert.is_false(schema:validate_json('{"tags":[1]}'))
+    end)
+
+    it("preserves mode and dialect", function()
+        local artifact = luablaze.new([[{"type":"integer"}]], { mode = "Exhaustive", dialect = "draft7" }):dump()
+        local info = luablaze.load(artifact):info()
+        assert.are.equal("Exhaustive", info.mode)
+        assert.are.equal("http://json-schema.org/draft-07/schema#", info.dialect)
+    end)
+
+    it("applies conversion limits passed to load", function()
+        local artifact = luablaze.new([[{"type":"array"}]]):dump()
+        local schema = luablaze.load(artifact, { max_array_length = 2 })
+        assert.are.equal(2, schema:info().max_array_length)
+        assert.has_error(function() schema:validate({ 1, 2, 3 }) end)
+    end)
+
+    it("rejects options fixed by the artifact", function()
+        local artifact = luablaze.new([[{"type":"string"}]]):dump()
+        assert.has_error(function() luablaze.load(artifact, { mode = "Fast" }) end)
+        assert.has_error(function() luablaze.load(artifact, { dialect = "draft7" }) end)
+    end)
+
+    it("rejects stale artifacts", function()
+        local artifact = luablaze.new([[{"type":"string"}]]):dump()
+        local stale = artifact:gsub('"luablaze_version":"[^"]*"', '"luablaze_version":"0.0.0-stale"')
+        local ok, err = pcall(luablaze.load, stale)
+        assert.is_false(ok)
+        assert.is_truthy(err:match("Stale template artifact"))
+    end)
+
+    it("rejects malformed artifacts", function()
+        assert.has_error(function() luablaze.load("{}") end)
+        assert.has_error(function() luablaze.load("[]") end)
+        assert.has_error(function() luablaze.load("not json") end)
+    end)
+end)
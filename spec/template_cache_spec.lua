@@ -0,0 +1,122 @@
+-- Tests for the process-wide compiled template cache
+require("spec.spec_helper")
+
+local luablaze = require("luablaze")
+
+describe("template cache", function()
+    local schema_json = [[{
+        "$schema": "http://json-schema.org/draft-07/schema#",
+        "type": "object",
+        "properties": { "id": { "type": "integer" } },
+        "required": ["id"]
+    }]]
+
+    before_each(function()
+        luablaze.cache_clear()
+        luablaze.cache_set_limit(256, 0)
+    end)
+
+    it("does not use the cache by default", function()
+        local before = luablaze.cache_stats()
+        local schema = luablaze.new(schema_json)
+        local after = luablaze.cache_stats()
+        assert.are.equal(before.misses, after.misses)
+        assert.are.equal(0, after.entries)
+        assert.is_false(schema:info().cached)
+    end)
+
+    it("compiles on a miss and reuses the template on a hit", function()
+        local before = luablaze.cache_stats()
+        local first = luablaze.new(schema_json, { cache = true })
+        local second = luablaze.new(schema_json, { cache = true })
+        local after = luablaze.cache_stats()
+
+        assert.are.equal(before.misses + 1, after.misses)
+        assert.are.equal(before.hits + 1, after.hits)
+        assert.are.equal(1, after.entries)
+        assert.is_true(second:info().cached)
+
+        for _, schema in ipairs({ first, second }) do
+            assert.is_true(schema:validate({ id = 1 }))
+            assert.is_false(schema:validate({ id = "1" }))
+        end
+    end)
+
+    it("keys entries by mode and dialect", function()
+        luablaze.new(schema_json, { cache = true })
+        luablaze.new(schema_json, { cache = true, mode = "Exhaustive" })
+        luablaze.new(schema_json, { cache = true, dialect = "draft2020-12" })
+        assert.are.equal(3, luablaze.cache_stats().entries)
+    end)
+
+    it("keeps cached schemas usable after cache_clear", function()
+        local schema = luablaze.new(schema_json, { cache = true })
+        luablaze.cache_clear()
+        collectgarbage()
+        assert.are.equal(0, luablaze.cache_stats().entries)
+        assert.is_true(schema:validate({ id = 1 }))
+    end)
+
+    it("evicts the least recently used entry", function()
+        luablaze.cache_set_limit(2)
+        local a = [[{"type":"string"}]]
+        local b = [[{"type":"number"}]]
+        local c = [[{"type":"boolean"}]]
+
+        luablaze.new(a, { cache = true })
+        luablaze.new(b, { cache = true })
+        luablaze.new(a, { cache = true })
+        local before = luablaze.cache_stats()
+        luablaze.new(c, { cache = true })
+        local after = luablaze.cache_stats()
+
+        assert.are.equal(2, after.entries)
+        assert.are.equal(2, after.max_entries)
+        assert.are.equal(before.evictions + 1, after.evictions)
+
+        -- `a` was used more recently than `b`, so it survived
+        luablaze.new(a, { cache = true })
+        assert.are.equal(after.hits + 1, luablaze.cache_stats().hits)
+    end)
+
+    it("accounts bytes and evicts beyond max_bytes", function()
+        local a = [[{"type":"string","minLength":1}]]
+        -- Smaller than `a`, so it fits on its own
+        local b = [[{"type":"number"}]]
+
+        luablaze.new(a, { cache = true })
+        local one = luablaze.cache_stats()
+        assert.is_true(one.bytes > #a)
+        assert.are.equal(0, one.max_bytes)
+
+        -- Room for the first entry only
+        luablaze.cache_set_limit(256, one.bytes)
+        luablaze.new(b, { cache = true })
+        local after = luablaze.cache_stats()
+        assert.are.equal(1, after.entries)
+        assert.are.equal(one.bytes, after.max_bytes)
+        assert.is_true(after.bytes <= after.max_bytes)
+        assert.are.equal(one.evictions + 1, after.evictions)
+
+        -- Omitting max_bytes keeps the byte limit
+        luablaze.cache_set_limit(128)
+        assert.are.equal(one.bytes, luablaze.cache_stats().max_bytes)
+
+        luablaze.cache_clear()
+        assert.are.equal(0, luablaze.cache_stats().bytes)
+    end)
+
+    it("still enforces max_depth on cache hits", function()
+        local nested = [[{"items":{"items":{"items":{}}}}]]
+        luablaze.new(nested, { cache = true, max_depth = 0 })
+        assert.has_error(function()
+            luablaze.new(nested, { cache = true, max_depth = 2 })
+        end)
+    end)
+
+    it("rejects invalid options", function()
+        assert.has_error(function() luablaze.new(schema_json, { cache = "yes" }) end)
+        assert.has_error(function() luablaze.cache_set_limit(-1) end)
+        assert.has_error(function() luablaze.cache_set_limit(1, -1) end)
+    end)
+end)
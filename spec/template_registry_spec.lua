@@ -0,0 +1,70 @@
+-- Tests for the process-wide template registry (publish / acquire)
+require("spec.spec_helper")
+
+local luablaze = require("luablaze")
+
+describe("template registry", function()
+    local schema_json = [[{
+        "$schema": "http://json-schema.org/draft-07/schema#",
+        "type": "object",
+        "properties": { "id": { "type": "integer" } },
+        "required": ["id"]
+    }]]
+
+    after_each(function()
+        for _, name in ipairs(luablaze.published()) do
+            luablaze.unpublish(name)
+        end
+    end)
+
+    it("acquires a published template", function()
+        luablaze.publish("user", luablaze.new(schema_json))
+        local schema = luablaze.acquire("user")
+        assert.is_true(schema:validate({ id = 1 }))
+        assert.is_false(schema:validate({}))
+    end)
+
+    it("returns nil for unknown names", function()
+        assert.is_nil(luablaze.acquire("missing"))
+    end)
+
+    it("keeps the template alive after the original schema is collected", function()
+        luablaze.publish("user", luablaze.new(schema_json))
+        collectgarbage()
+        collectgarbage()
+        assert.is_true(luablaze.acquire("user"):validate_json('{"id":2}'))
+    end)
+
+    it("inherits mode and limits and lets acquire override limits", function()
+        luablaze.publish("user", luablaze.new(schema_json, { mode = "Exhaustive", max_depth = 16 }))
+
+        local inherited = luablaze.acquire("user"):info()
+        assert.are.equal("Exhaustive", inherited.mode)
+        assert.are.equal(16, inherited.max_depth)
+
+        local overridden = luablaze.acquire("user", { max_depth = 4 }):info()
+        assert.are.equal(4, overridden.max_depth)
+        assert.has_error(function() luablaze.acquire("user", { mode = "Fast" }) end)
+    end)
+
+    it("gives every acquired schema its own evaluator", function()
+        luablaze.publish("user", luablaze.new(schema_json))
+        local a = luablaze.acquire("user")
+        local b = luablaze.acquire("user")
+        assert.is_true(a:validate({ id = 1 }))
+        assert.is_false(b:validate({ id = "x" }))
+        assert.is_true(a:validate({ id = 3 }))
+    end)
+
+    it("unpublishes and lists names", function()
+        luablaze.publish("b", luablaze.new(schema_json))
+        luablaze.publish("a", luablaze.new(schema_json))
+        assert.are.same({ "a", "b" }, luablaze.published())
+
+        local schema = luablaze.acquire("a")
+        assert.is_true(luablaze.unpublish("a"))
+        assert.is_false(luablaze.unpublish("a"))
+        assert.is_nil(luablaze.acquire("a"))
+        assert.is_true(schema:validate({ id = 1 }))
+    end)
+end)
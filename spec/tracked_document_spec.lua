@@ -0,0 +1,258 @@
+-- Tests for CompiledSchema:track and TrackedDocument
+require("spec.spec_helper")
+
+local luablaze = require("luablaze")
+
+describe("tracked documents", function()
+    local schema = luablaze.new([[{
+        "$schema": "https://json-schema.org/draft/2020-12/schema",
+        "type": "object",
+        "properties": {
+            "port": { "type": "integer", "maximum": 65535 },
+            "tags": { "type": "array", "items": { "type": "string" } },
+            "server": {
+                "type": "object",
+                "properties": { "host": { "type": "string" } }
+            }
+        },
+        "required": ["port"]
+    }]])
+
+    local function config()
+        return { port = 8080, tags = { "a", "b" }, server = { host = "localhost" } }
+    end
+
+    it("validates the tracked document", function()
+        local doc = schema:track(config())
+        assert.is_true(doc:validate())
+        assert.is_false(schema:track({ port = "8080" }):validate())
+    end)
+
+    it("does not write edits back to the original table", function()
+        local original = config()
+        local doc = schema:track(original)
+        doc:set("/port", 1)
+        assert.are.equal(8080, original.port)
+        assert.are.equal(1, doc:get("/port"))
+    end)
+
+    describe("set", function()
+        it("replaces values and revalidates", function()
+            local doc = schema:track(config())
+            doc:set("/port", 70000)
+            assert.is_false(doc:validate())
+            doc:set("/port", 443)
+            assert.is_true(doc:validate())
+        end)
+
+        it("adds object members and appends to arrays", function()
+            local doc = schema:track(config())
+            doc:set("/server/port", 1)
+            doc:set("/tags/-", "c")
+            doc:set("/tags/3", "d")
+            assert.are.equal(1, doc:get("/server/port"))
+            assert.are.same({ "a", "b", "c", "d" }, doc:get("/tags"))
+        end)
+
+        it("replaces the whole document", function()
+            local doc = schema:track(config())
+            doc:set("", { port = 1 })
+            assert.are.same({ port = 1 }, doc:get())
+        end)
+
+        it("converts nested tables", function()
+            local doc = schema:track(config())
+            doc:set("/tags/0", { nested = true })
+            assert.is_false(doc:validate())
+        end)
+
+        it("rejects missing parents and bad pointers", function()
+            local doc = schema:track(config())
+            assert.has_error(function() doc:set("/missing/child", 1) end)
+            assert.has_error(function() doc:set("/tags/5", "x") end)
+            assert.has_error(function() doc:set("/tags/01", "x") end)
+            assert.has_error(function() doc:set("port", 1) end)
+            assert.has_error(function() doc:set("/a~2b", 1) end)
+        end)
+
+        it("unescapes pointer tokens", function()
+            local doc = schema:track(config())
+            doc:set("/a~1b~0c", 1)
+            assert.are.equal(1, doc:get("/a~1b~0c"))
+            assert.is_truthy(doc:to_json():find('"a/b~c":1', 1, true))
+        end)
+    end)
+
+    describe("remove", function()
+        it("removes members and array elements", function()
+            local doc = schema:track(config())
+            assert.is_true(doc:remove("/tags/0"))
+            assert.is_true(doc:remove("/server/host"))
+            assert.are.same({ "b" }, doc:get("/tags"))
+            assert.is_nil(doc:get("/server/host"))
+        end)
+
+        it("returns false for missing values", function()
+            local doc = schema:track(config())
+            assert.is_false(doc:remove("/nothing"))
+            assert.is_false(doc:remove("/tags/9"))
+        end)
+
+        it("invalidates the cached result", function()
+            local doc = schema:track(config())
+            assert.is_true(doc:validate())
+            doc:remove("/port")
+            assert.is_false(doc:validate())
+        end)
+
+        it("refuses to remove the root", function()
+            assert.has_error(function() schema:track(config()):remove("") end)
+        end)
+    end)
+
+    describe("patch", function()
+        it("applies every operation in order", function()
+            local doc = schema:track(config())
+            doc:patch({
+                { op = "replace", path = "/port", value = 9000 },
+                { op = "add", path = "/tags/0", value = "first" },
+                { op = "remove", path = "/tags/2" },
+                { op = "copy", from = "/server/host", path = "/tags/-" },
+                { op = "move", from = "/server", path = "/backend" },
+                { op = "test", path = "/port", value = 9000 },
+            })
+            assert.are.equal(9000, doc:get("/port"))
+            assert.are.same({ "first", "a", "localhost" }, doc:get("/tags"))
+            assert.is_nil(doc:get("/server"))
+            assert.are.same({ host = "localhost" }, doc:get("/backend"))
+            assert.is_true(doc:validate())
+        end)
+
+        it("leaves the document unchanged when an operation fails", function()
+            local doc = schema:track(config())
+            local ok, err = pcall(doc.patch, doc, {
+                { op = "replace", path = "/port", value = 1 },
+                { op = "remove", path = "/tags/0" },
+                { op = "add", path = "/new", value = "x" },
+                { op = "move", from = "/server/host", path = "/host" },
+                { op = "test", path = "/port", value = 2 },
+            })
+            assert.is_false(ok)
+            assert.is_truthy(tostring(err):find("Patch operation 5", 1, true))
+            assert.are.same(config(), doc:get())
+        end)
+
+        it("reads operation fields without metamethods", function()
+            local doc = schema:track(config())
+            local raising = setmetatable({}, { __index = function() error("unexpected __index call") end })
+            local ok, err = pcall(doc.patch, doc, {
+                { op = "replace", path = "/port", value = 1 },
+                raising,
+            })
+            assert.is_false(ok)
+            assert.is_truthy(tostring(err):find("field 'op' must be a string", 1, true))
+            assert.are.same(config(), doc:get())
+        end)
+
+        it("rejects malformed operations", function()
+            local doc = schema:track(config())
+            assert.has_error(function() doc:patch({ { op = "frobnicate", path = "/port" } }) end)
+            assert.has_error(function() doc:patch({ { op = "add" } }) end)
+            assert.has_error(function() doc:patch({ "add" }) end)
+            assert.has_error(function() doc:patch({ { op = "move", from = "/server", path = "/server/x" } }) end)
+        end)
+    end)
+
+    describe("incremental validation", function()
+        local schema_json = [[{
+            "$schema": "https://json-schema.org/draft/2020-12/schema",
+            "type": "object",
+            "properties": {
+                "port": { "type": "integer", "maximum": 65535 },
+                "tags": { "type": "array", "items": { "type": "string" } },
+                "server": {
+                    "type": "object",
+                    "properties": { "host": { "type": "string" } },
+                    "required": ["host"]
+                }
+            },
+            "additionalProperties": { "type": "boolean" },
+            "required": ["port"],
+            "maxProperties": 4
+        }]]
+        local incremental = luablaze.new(schema_json, { incremental = true })
+
+        it("splits only schemas whose parts compile on their own", function()
+            assert.is_true(incremental:info().incremental)
+            assert.is_false(schema:info().incremental)
+            assert.is_false(luablaze.new([[{
+                "$schema": "https://json-schema.org/draft/2020-12/schema",
+                "properties": { "port": { "$ref": "#/$defs/port" } },
+                "$defs": { "port": { "type": "integer" } }
+            }]], { incremental = true }):info().incremental)
+            assert.is_false(luablaze.new([[{
+                "$schema": "https://json-schema.org/draft/2020-12/schema",
+                "allOf": [{ "required": ["port"] }]
+            }]], { incremental = true }):info().incremental)
+            assert.is_false(luablaze.new([[{
+                "$schema": "http://json-schema.org/draft-07/schema#",
+                "properties": { "port": { "type": "integer" } }
+            }]], { incremental = true }):info().incremental)
+        end)
+
+        it("matches full evaluation after every edit", function()
+            local full = luablaze.new(schema_json):track(config())
+            local doc = incremental:track(config())
+            local edits = {
+                function(d) d:set("/port", 70000) end,
+                function(d) d:set("/port", 443) end,
+                function(d) d:set("/tags/-", 1) end,
+                function(d) d:remove("/tags/2") end,
+                function(d) d:set("/debug", "yes") end,
+                function(d) d:set("/debug", true) end,
+                function(d) d:set("/extra", true) end,
+                function(d) d:remove("/extra") end,
+                function(d) d:remove("/server/host") end,
+                function(d) d:patch({ { op = "add", path = "/server/host", value = "example.org" } }) end,
+                function(d) d:patch({ { op = "move", from = "/port", path = "/moved" } }) end,
+                function(d) d:patch({ { op = "copy", from = "/debug", path = "/port" } }) end,
+                function(d)
+                    d:patch({ { op = "replace", path = "/port", value = 1 }, { op = "remove", path = "/x" } })
+                end,
+                function(d)
+                    d:patch({ { op = "remove", path = "/moved" }, { op = "replace", path = "/port", value = 1 } })
+                end,
+                function(d) d:set("", { 1, 2 }) end,
+                function(d) d:set("", config()) end,
+            }
+            for i, edit in ipairs(edits) do
+                pcall(edit, full)
+                pcall(edit, doc)
+                assert.are.same(full:get(), doc:get(), "edit " .. i)
+                assert.are.equal(full:validate(), doc:validate(), "edit " .. i)
+            end
+        end)
+
+        it("does not re-evaluate properties that were not edited", function()
+            local function document()
+                local tags = {}
+                for i = 1, 100000 do
+                    tags[i] = "tag"
+                end
+                return { port = 1, tags = tags }
+            end
+
+            local function elapsed(doc)
+                local started = os.clock()
+                for i = 1, 50 do
+                    doc:set("/port", i)
+                    assert.is_true(doc:validate())
+                end
+                return os.clock() - started
+            end
+
+            local full_time = elapsed(luablaze.new(schema_json):track(document()))
+            assert.is_true(elapsed(incremental:track(document())) < full_time / 5 + 0.01)
+        end)
+    end)
+end)
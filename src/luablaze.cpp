@@ -8,14 +8,114 @@
 
 #include <sourcemeta/blaze/compiler.h>
 #include <sourcemeta/blaze/evaluator.h>
+#include <sourcemeta/blaze/output_simple.h>
 #include <sourcemeta/blaze/output_standard.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <climits>
 #include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <new>
 #include <optional>
 #include <sstream>
 #include <stdexcept>
+#include <streambuf>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#endif
+
+// Lua 5.1 / LuaJIT compatibility. The binding is written against the 5.3 C
+// API; the few 5.2/5.3 functions it relies on are provided here for 5.1 ABI
+// hosts (LuaJIT reports LUA_VERSION_NUM 501). Macros are used so the shims
+// also take precedence over the subset LuaJIT 2.1 already declares.
+#if LUA_VERSION_NUM < 502
+#ifndef LUA_OK
+#define LUA_OK 0
+#endif
+
+static int luablaze_compat_absindex(lua_State *L, const int index) {
+    return (index > 0 || index <= LUA_REGISTRYINDEX) ? index : lua_gettop(L) + index + 1;
+}
+
+static void *luablaze_compat_testudata(lua_State *L, const int index, const char *name) {
+    void *pointer = lua_touserdata(L, index);
+    if (pointer == nullptr || !lua_getmetatable(L, index)) {
+        return nullptr;
+    }
+    luaL_getmetatable(L, name);
+    const bool matches = lua_rawequal(L, -1, -2) != 0;
+    lua_pop(L, 2);
+    return matches ? pointer : nullptr;
+}
+
+static void luablaze_compat_setfuncs(lua_State *L, const luaL_Reg *functions, const int upvalues) {
+    luaL_checkstack(L, upvalues, "too many upvalues");
+    for (; functions->name != nullptr; functions++) {
+        for (int i = 0; i < upvalues; i++) {
+            lua_pushvalue(L, -upvalues);
+        }
+        lua_pushcclosure(L, functions->func, upvalues);
+        lua_setfield(L, -(upvalues + 2), functions->name);
+    }
+    lua_pop(L, upvalues);
+}
+
+#define lua_absindex luablaze_compat_absindex
+#define luaL_testudata luablaze_compat_testudata
+#define luaL_setfuncs luablaze_compat_setfuncs
+#define lua_rawlen(L, index) lua_objlen((L), (index))
+#define luaL_newlib(L, functions)                                                                                      \
+    (lua_createtable((L), 0, static_cast<int>(sizeof(functions) / sizeof((functions)[0]) - 1)),                        \
+     luaL_setfuncs((L), (functions), 0))
+#endif
+
+// Every number is a double before 5.3, so an integral value that fits
+// lua_Integer stands in for the integer subtype
+#if LUA_VERSION_NUM < 503
+static int luablaze_compat_isinteger(lua_State *L, const int index) {
+    if (lua_type(L, index) != LUA_TNUMBER) {
+        return 0;
+    }
+    const lua_Number number = lua_tonumber(L, index);
+    const auto lowest       = static_cast<lua_Number>(std::numeric_limits<lua_Integer>::min());
+    return std::floor(number) == number && number >= lowest && number < -lowest;
+}
+
+#define lua_isinteger luablaze_compat_isinteger
+#endif
 
 /**
  * @file luablaze.cpp
@@ -30,17 +130,97 @@
  *
  * Module-level functions:
  * - `luablaze.new(schema_json[, options]) -> CompiledSchema`
+ * - `luablaze.load(artifact_json[, options]) -> CompiledSchema`
+ * - `luablaze.new_set(schemas, options) -> SchemaSet`
+ * - `luablaze.parse(instance_json[, options]) -> Instance`
+ * - `luablaze.from_table(instance_table[, options]) -> Instance`
+ * - `luablaze.publish(name, compiled_schema)`
+ * - `luablaze.acquire(name[, options]) -> CompiledSchema | nil`
+ * - `luablaze.unpublish(name) -> boolean`
+ * - `luablaze.published() -> names`
+ * - `luablaze.registry() -> SchemaRegistry`
  * - `luablaze.validate(compiled_schema, instance_table) -> boolean`
  * - `luablaze.validate_json(compiled_schema, instance_json_string) -> boolean`
- * - `luablaze.validate_detailed(compiled_schema, instance_table) -> boolean, report_table`
- * - `luablaze.validate_json_detailed(compiled_schema, instance_json_string) -> boolean, report_table`
+ * - `luablaze.validate_detailed(compiled_schema, instance_table[, options]) -> boolean, report_table`
+ * - `luablaze.validate_json_detailed(compiled_schema, instance_json_string[, options]) -> boolean, report_table`
+ * - `luablaze.validate_file(compiled_schema, path) -> boolean`
+ * - `luablaze.validate_file_detailed(compiled_schema, path[, options]) -> boolean, report_table`
+ * - `luablaze.validate_many(compiled_schema, instance_tables[, options]) -> results, invalid_count`
+ * - `luablaze.validate_json_many(compiled_schema, instance_json_strings[, options]) -> results, invalid_count`
+ * - `luablaze.validate_json_parallel(compiled_schema, instance_json_strings[, options]) -> results, invalid_count`
+ * - `luablaze.register_metatable(mt, "array" | "object" | nil)`
+ * - `luablaze.cache_stats() -> table`
+ * - `luablaze.cache_clear()`
+ * - `luablaze.cache_set_limit(max_entries[, max_bytes])`
  *
  * CompiledSchema methods:
  * - `CompiledSchema:validate(instance_table) -> boolean`
  * - `CompiledSchema:validate_json(instance_json_string) -> boolean`
- * - `CompiledSchema:validate_detailed(instance_table) -> boolean, report_table`
- * - `CompiledSchema:validate_json_detailed(instance_json_string) -> boolean, report_table`
+ * - `CompiledSchema:decode_json(instance_json_string[, options]) -> boolean, value`
+ * - `CompiledSchema:validate_detailed(instance_table[, options]) -> boolean, report_table`
+ * - `CompiledSchema:validate_json_detailed(instance_json_string[, options]) -> boolean, report_table`
+ * - `CompiledSchema:validate_file(path) -> boolean`
+ * - `CompiledSchema:validate_file_detailed(path[, options]) -> boolean, report_table`
+ * - `CompiledSchema:each_error(instance_table, fn) -> boolean, count, stopped`
+ * - `CompiledSchema:each_error_json(instance_json_string, fn) -> boolean, count, stopped`
+ * - `CompiledSchema:validate_many(instance_tables[, options]) -> results, invalid_count`
+ * - `CompiledSchema:validate_json_many(instance_json_strings[, options]) -> results, invalid_count`
+ * - `CompiledSchema:validate_json_parallel(instance_json_strings[, options]) -> results, invalid_count`
+ * - `CompiledSchema:validate_json_async(instance_json_string) -> ValidationJob`
+ * - `CompiledSchema:validate_ndjson(buffer[, options]) -> summary`
  * - `CompiledSchema:evaluate(instance_table) -> boolean` (alias for validate)
+ * - `CompiledSchema:profile(instance[, options]) -> boolean, keywords`
+ * - `CompiledSchema:info() -> table`
+ * - `CompiledSchema:stats() -> table | nil`
+ * - `CompiledSchema:reset_stats()`
+ * - `CompiledSchema:dump() -> artifact_json`
+ * - `CompiledSchema:track(instance_table) -> TrackedDocument`
+ * - `CompiledSchema:ffi_handle() -> lightuserdata`
+ *
+ * The validate, profile, batch, async and track methods of `CompiledSchema`
+ * and `SchemaSet` also accept an `Instance` wherever they take an instance
+ * table or string. `decode_json`, `validate_ndjson` and `validate_file*` do
+ * not, as they take JSON text, an NDJSON buffer or a path.
+ *
+ * Instance methods:
+ * - `Instance:to_json() -> string`
+ * - `Instance:to_table() -> value`
+ *
+ * ValidationJob methods:
+ * - `ValidationJob:done() -> boolean`
+ * - `ValidationJob:wait([timeout_seconds]) -> boolean`
+ * - `ValidationJob:result() -> boolean`
+ * - `ValidationJob:fd() -> integer | nil`
+ *
+ * SchemaRegistry methods:
+ * - `SchemaRegistry:add(schema_json[, uri]) -> uri`
+ * - `SchemaRegistry:remove(uri) -> boolean`
+ * - `SchemaRegistry:has(uri) -> boolean`
+ *
+ * Report methods (reports returned with `{ lazy = true }`):
+ * - `Report:pairs() -> iterator`
+ * - `Report:error_count() -> integer`
+ * - `Report:first_error() -> table | nil`
+ * - `Report:to_json() -> string`
+ * - `Report:to_table() -> table`
+ *
+ * SchemaSet methods:
+ * - `SchemaSet:validate(instance_table) -> boolean, name`
+ * - `SchemaSet:validate_json(instance_json) -> boolean, name`
+ * - `SchemaSet:route(instance_table) -> name | nil`
+ * - `SchemaSet:info() -> table`
+ *
+ * LuaJIT FFI entry points (see the `luablaze.ffi` module):
+ * - `int luablaze_ffi_validate_json(void *handle, const char *data, size_t length)`
+ * - `const char *luablaze_ffi_last_error(void)`
+ *
+ * TrackedDocument methods:
+ * - `TrackedDocument:set(pointer, value)`
+ * - `TrackedDocument:remove(pointer) -> boolean`
+ * - `TrackedDocument:patch(operations)`
+ * - `TrackedDocument:validate() -> boolean`
+ * - `TrackedDocument:get([pointer]) -> value`
+ * - `TrackedDocument:to_json() -> string`
  *
  * The schema is passed as a JSON string and parsed with `sourcemeta::core::parse_json`.
  * Instances can be provided either as Lua tables (converted to a JSON value) or as JSON
@@ -51,19 +231,39 @@
  *
  * **CompiledSchema objects are NOT thread-safe.**
  *
+ * A CompiledSchema pairs an immutable, reference-counted Blaze `Template` with
+ * a per-object `Evaluator` and conversion scratch state. Only the latter is
+ * mutable.
+ *
  * - Each CompiledSchema instance should be used by only one thread at a time
  * - If multiple threads need to validate against the same schema, each thread should
- *   create its own CompiledSchema instance via luablaze.new()
+ *   create its own CompiledSchema instance, ideally with luablaze.acquire() on a
+ *   template published once with luablaze.publish(), so the template is shared
+ *   instead of compiled per thread
  * - Alternatively, use external synchronization (mutexes) to protect shared access
  * - The compilation process (luablaze.new) is thread-safe as long as each thread
  *   operates on different Lua states
+ * - The template cache (`cache = true`) is shared by every Lua state in the process
+ *   and is internally synchronized; cached templates are immutable
  */
 
-static constexpr const char *LUABLAZE_COMPILEDSCHEMA_MT = "luablaze.CompiledSchema";
+static constexpr const char *LUABLAZE_COMPILEDSCHEMA_MT  = "luablaze.CompiledSchema";
+static constexpr const char *LUABLAZE_ARRAY_MT           = "luablaze.array";
+static constexpr const char *LUABLAZE_OBJECT_MT          = "luablaze.object";
+static constexpr const char *LUABLAZE_VALIDATIONJOB_MT   = "luablaze.ValidationJob";
+static constexpr const char *LUABLAZE_REPORT_MT          = "luablaze.Report";
+static constexpr const char *LUABLAZE_SCHEMAREGISTRY_MT  = "luablaze.SchemaRegistry";
+static constexpr const char *LUABLAZE_TRACKEDDOCUMENT_MT = "luablaze.TrackedDocument";
+static constexpr const char *LUABLAZE_SCHEMASET_MT       = "luablaze.SchemaSet";
+static constexpr const char *LUABLAZE_INSTANCE_MT        = "luablaze.Instance";
+// Registry table mapping marker metatables to "array" / "object" (weak keys)
+static constexpr const char *LUABLAZE_TABLE_HINTS_KEY    = "luablaze.table_hints";
 
 // Module version information
-static constexpr const char *LUABLAZE_VERSION           = "1.0.0";
-static constexpr const char *LUABLAZE_NAME              = "luablaze";
+static constexpr const char *LUABLAZE_VERSION            = "1.0.0";
+static constexpr const char *LUABLAZE_NAME               = "luablaze";
+// Format tag of `CompiledSchema:dump()` artifacts
+static constexpr const char *LUABLAZE_TEMPLATE_FORMAT    = "luablaze.template/1";
 
 // Blaze library version (passed from CMake)
 #ifndef BLAZE_LIBRARY_VERSION
@@ -76,6 +276,9 @@ static constexpr std::size_t LUABLAZE_DEFAULT_MAX_ARRAY_LENGTH    = 100000;
 static constexpr std::size_t LUABLAZE_DEFAULT_MAX_DEPTH           = 128;
 static constexpr std::size_t LUABLAZE_DEFAULT_MAX_RECURSION_DEPTH = 100;
 
+// Default number of templates kept by the process-wide template cache
+static constexpr std::size_t LUABLAZE_DEFAULT_TEMPLATE_CACHE_SIZE = 256;
+
 /**
  * @brief Convert a user-facing dialect identifier into a JSON Schema metaschema URI.
  *
@@ -148,11 +351,6 @@ static auto parse_mode_string(const std::string_view value) -> std::optional<sou
     return std::nullopt;
 }
 
-// Parse `luablaze.new` options table.
-//
-// Supported keys:
-// - `mode`: "Fast" (default) or "Exhaustive"
-// - `dialect`: test-suite folder name (e.g. "draft7") or a full dialect URI
 static bool validate_options_table_keys(lua_State *L, const int index, std::string &error) {
     const int abs_index = lua_absindex(L, index);
     lua_pushnil(L);
@@ -169,9 +367,197 @@ static bool validate_options_table_keys(lua_State *L, const int index, std::stri
     return true;
 }
 
-static bool parse_options_table(lua_State *L, const int index, sourcemeta::blaze::Mode &mode,
-                                std::optional<std::string> &default_dialect, std::size_t &max_array_length,
-                                std::size_t &max_depth, std::size_t &max_recursion_depth, std::string &error) {
+// Read the optional non-negative integer field `name` of the options table at
+// `abs_index` into `value`. Leaves `value` untouched when the field is nil.
+static bool parse_size_option(lua_State *L, const int abs_index, const char *name, std::size_t &value,
+                              std::string &error) {
+    lua_getfield(L, abs_index, name);
+    if (!lua_isnil(L, -1)) {
+        if (!lua_isinteger(L, -1)) {
+            lua_pop(L, 1);
+            error = std::string{"options."} + name + " must be an integer";
+            return false;
+        }
+        const lua_Integer v = lua_tointeger(L, -1);
+        if (v < 0) {
+            lua_pop(L, 1);
+            error = std::string{"options."} + name + " must be >= 0";
+            return false;
+        }
+        value = static_cast<std::size_t>(v);
+    }
+    lua_pop(L, 1);
+    return true;
+}
+
+// Read the optional boolean field `name` of the options table at `abs_index`
+// into `value`. Leaves `value` untouched when the field is nil.
+static bool parse_boolean_option(lua_State *L, const int abs_index, const char *name, bool &value,
+                                 std::string &error) {
+    lua_getfield(L, abs_index, name);
+    if (!lua_isnil(L, -1)) {
+        if (!lua_isboolean(L, -1)) {
+            lua_pop(L, 1);
+            error = std::string{"options."} + name + " must be a boolean";
+            return false;
+        }
+        value = lua_toboolean(L, -1) != 0;
+    }
+    lua_pop(L, 1);
+    return true;
+}
+
+/**
+ * @brief In-memory store of schema documents addressable by URI.
+ *
+ * Created from Lua with `luablaze.registry()` and passed to `luablaze.new`
+ * through the `registry` option, where it acts as the schema resolver ahead
+ * of the built-in metaschemas. Documents are parsed once when added and
+ * shared by every compilation that references them. Every change bumps a
+ * revision so cached templates never outlive the documents they were
+ * compiled against.
+ *
+ * All members are safe to call concurrently from different threads.
+ */
+class SchemaRegistry {
+public:
+    SchemaRegistry() : id{next_id()} {
+    }
+
+    auto add(std::string uri, sourcemeta::core::JSON schema) -> void {
+        const std::lock_guard<std::mutex> lock{this->mutex};
+        this->documents.insert_or_assign(std::move(uri), std::move(schema));
+        this->revision++;
+    }
+
+    auto remove(const std::string &uri) -> bool {
+        const std::lock_guard<std::mutex> lock{this->mutex};
+        const bool removed = this->documents.erase(uri) > 0;
+        if (removed) {
+            this->revision++;
+        }
+        return removed;
+    }
+
+    auto find(const std::string_view uri) const -> std::optional<sourcemeta::core::JSON> {
+        const std::lock_guard<std::mutex> lock{this->mutex};
+        const auto match = this->documents.find(std::string{normalize_uri(uri)});
+        if (match == this->documents.end()) {
+            return std::nullopt;
+        }
+
+        return match->second;
+    }
+
+    auto contains(const std::string_view uri) const -> bool {
+        const std::lock_guard<std::mutex> lock{this->mutex};
+        return this->documents.find(std::string{normalize_uri(uri)}) != this->documents.end();
+    }
+
+    auto size() const -> std::size_t {
+        const std::lock_guard<std::mutex> lock{this->mutex};
+        return this->documents.size();
+    }
+
+    // Identity and revision of the registry, for template cache keys
+    auto cache_key() const -> std::string {
+        const std::lock_guard<std::mutex> lock{this->mutex};
+        return std::to_string(this->id) + ":" + std::to_string(this->revision);
+    }
+
+    // Drop an empty trailing fragment, so `https://example.com/a.json#` and
+    // `https://example.com/a.json` name the same document
+    static auto normalize_uri(std::string_view uri) -> std::string_view {
+        if (!uri.empty() && uri.back() == '#') {
+            uri.remove_suffix(1);
+        }
+        return uri;
+    }
+
+private:
+    static auto next_id() -> std::uint64_t {
+        static std::atomic<std::uint64_t> counter{0};
+        return ++counter;
+    }
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, sourcemeta::core::JSON> documents;
+    std::uint64_t revision{0};
+    const std::uint64_t id;
+};
+
+struct SchemaRegistryUserdata {
+    std::shared_ptr<SchemaRegistry> registry;
+};
+
+// Build the resolver used for compilation: documents of `registry` (if any)
+// first, then the built-in metaschemas.
+static auto make_schema_resolver(std::shared_ptr<SchemaRegistry> registry) -> sourcemeta::core::SchemaResolver {
+    if (registry == nullptr) {
+        return sourcemeta::core::schema_resolver;
+    }
+
+    return [registry = std::move(registry)](const std::string_view identifier) {
+        auto match = registry->find(identifier);
+        if (match.has_value()) {
+            return match;
+        }
+        return sourcemeta::core::schema_resolver(identifier);
+    };
+}
+
+/**
+ * @brief Options accepted by `luablaze.new`.
+ *
+ * @var mode Compilation mode
+ * @var default_dialect Dialect URI for schemas without `$schema`
+ * @var max_array_length Maximum array length when converting Lua tables (0 = unlimited)
+ * @var max_depth Maximum nesting depth when parsing JSON strings (0 = unlimited)
+ * @var max_input_bytes Maximum size of a JSON instance string (0 = unlimited)
+ * @var max_json_array_length Maximum array length when parsing JSON strings (0 = unlimited)
+ * @var max_string_length Maximum string length when parsing JSON strings (0 = unlimited)
+ * @var max_object_properties Maximum object property count when parsing JSON strings (0 = unlimited)
+ * @var max_recursion_depth Maximum recursion depth for table conversion (0 = unlimited)
+ * @var cache Share the compiled template through the process-wide template cache
+ * @var registry Schemas to resolve `$ref`s against before the built-in metaschemas
+ * @var stats Collect runtime statistics for `CompiledSchema:stats()`
+ * @var compact Strip data only needed for output formats from Fast-mode templates
+ * @var project Skip converting table fields the schema never observes
+ * @var incremental Split the schema so tracked documents only re-evaluate what edits touched
+ */
+struct SchemaOptions {
+    sourcemeta::blaze::Mode mode{sourcemeta::blaze::Mode::FastValidation};
+    std::optional<std::string> default_dialect{std::nullopt};
+    std::size_t max_array_length{LUABLAZE_DEFAULT_MAX_ARRAY_LENGTH};
+    std::size_t max_depth{LUABLAZE_DEFAULT_MAX_DEPTH};
+    std::size_t max_input_bytes{0};
+    std::size_t max_json_array_length{0};
+    std::size_t max_string_length{0};
+    std::size_t max_object_properties{0};
+    std::size_t max_recursion_depth{LUABLAZE_DEFAULT_MAX_RECURSION_DEPTH};
+    bool cache{false};
+    std::shared_ptr<SchemaRegistry> registry{nullptr};
+    bool stats{false};
+    bool compact{false};
+    bool project{false};
+    bool incremental{false};
+};
+
+// Parse `luablaze.new` options table.
+//
+// Supported keys:
+// - `mode`: "Fast" (default) or "Exhaustive"
+// - `dialect`: test-suite folder name (e.g. "draft7") or a full dialect URI
+// - `max_array_length`, `max_depth`, `max_recursion_depth`: conversion limits
+// - `max_input_bytes`, `max_json_array_length`, `max_string_length`,
+//   `max_object_properties`: JSON parse limits
+// - `cache`: reuse templates through the process-wide template cache
+// - `registry`: a `luablaze.registry()` to resolve references against
+// - `stats`: collect per-schema runtime statistics
+// - `compact`: drop keyword locations from Fast-mode templates
+// - `project`: convert only the table fields the schema observes
+// - `incremental`: split the schema for `TrackedDocument:validate()`
+static bool parse_options_table(lua_State *L, const int index, SchemaOptions &options, std::string &error) {
     const int abs_index = lua_absindex(L, index);
     if (!validate_options_table_keys(L, abs_index, error)) {
         return false;
@@ -193,7 +579,7 @@ static bool parse_options_table(lua_State *L, const int index, sourcemeta::blaze
             error = "Unknown mode '" + std::string{mode_name} + "'";
             return false;
         }
-        mode = parsed.value();
+        options.mode = parsed.value();
     }
     lua_pop(L, 1);
 
@@ -207,8 +593,8 @@ static bool parse_options_table(lua_State *L, const int index, sourcemeta::blaze
         std::size_t dialect_len{0};
         const char *dialect_str = lua_tolstring(L, -1, &dialect_len);
         const auto dialect_name = std::string_view{dialect_str, dialect_len};
-        default_dialect         = dialect_uri_from_name(dialect_name);
-        if (!default_dialect.has_value()) {
+        options.default_dialect = dialect_uri_from_name(dialect_name);
+        if (!options.default_dialect.has_value()) {
             lua_pop(L, 1);
             error = "Unknown dialect '" + std::string{dialect_name} + "'";
             return false;
@@ -216,547 +602,5659 @@ static bool parse_options_table(lua_State *L, const int index, sourcemeta::blaze
     }
     lua_pop(L, 1);
 
-    lua_getfield(L, abs_index, "max_array_length");
+    lua_getfield(L, abs_index, "registry");
     if (!lua_isnil(L, -1)) {
-        if (!lua_isinteger(L, -1)) {
-            lua_pop(L, 1);
-            error = "options.max_array_length must be an integer";
-            return false;
-        }
-        const lua_Integer v = lua_tointeger(L, -1);
-        if (v < 0) {
+        auto *ud = static_cast<SchemaRegistryUserdata *>(luaL_testudata(L, -1, LUABLAZE_SCHEMAREGISTRY_MT));
+        if (ud == nullptr || ud->registry == nullptr) {
             lua_pop(L, 1);
-            error = "options.max_array_length must be >= 0";
+            error = "options.registry must be a registry created by luablaze.registry()";
             return false;
         }
-        max_array_length = static_cast<std::size_t>(v);
+        options.registry = ud->registry;
     }
     lua_pop(L, 1);
 
-    lua_getfield(L, abs_index, "max_depth");
-    if (!lua_isnil(L, -1)) {
-        if (!lua_isinteger(L, -1)) {
-            lua_pop(L, 1);
-            error = "options.max_depth must be an integer";
-            return false;
-        }
-        const lua_Integer v = lua_tointeger(L, -1);
-        if (v < 0) {
-            lua_pop(L, 1);
-            error = "options.max_depth must be >= 0";
-            return false;
-        }
-        max_depth = static_cast<std::size_t>(v);
-    }
-    lua_pop(L, 1);
+    return parse_size_option(L, abs_index, "max_array_length", options.max_array_length, error) &&
+           parse_size_option(L, abs_index, "max_depth", options.max_depth, error) &&
+           parse_size_option(L, abs_index, "max_input_bytes", options.max_input_bytes, error) &&
+           parse_size_option(L, abs_index, "max_json_array_length", options.max_json_array_length, error) &&
+           parse_size_option(L, abs_index, "max_string_length", options.max_string_length, error) &&
+           parse_size_option(L, abs_index, "max_object_properties", options.max_object_properties, error) &&
+           parse_size_option(L, abs_index, "max_recursion_depth", options.max_recursion_depth, error) &&
+           parse_boolean_option(L, abs_index, "cache", options.cache, error) &&
+           parse_boolean_option(L, abs_index, "stats", options.stats, error) &&
+           parse_boolean_option(L, abs_index, "compact", options.compact, error) &&
+           parse_boolean_option(L, abs_index, "project", options.project, error) &&
+           parse_boolean_option(L, abs_index, "incremental", options.incremental, error);
+}
 
-    lua_getfield(L, abs_index, "max_recursion_depth");
-    if (!lua_isnil(L, -1)) {
-        if (!lua_isinteger(L, -1)) {
-            lua_pop(L, 1);
-            error = "options.max_recursion_depth must be an integer";
-            return false;
-        }
-        const lua_Integer v = lua_tointeger(L, -1);
-        if (v < 0) {
-            lua_pop(L, 1);
-            error = "options.max_recursion_depth must be >= 0";
+// Fail if the options table at `index` sets any option that only makes sense
+// when compiling (`mode`, `dialect`, `cache`, `registry`, `compact`, `project`,
+// `incremental`). Used by the entry points that wrap an already compiled template.
+static bool reject_compilation_options(lua_State *L, const int index, const char *function_name,
+                                       std::string &error) {
+    const int abs_index = lua_absindex(L, index);
+    for (const char *key : {"mode", "dialect", "cache", "registry", "compact", "project", "incremental"}) {
+        lua_getfield(L, abs_index, key);
+        const bool present = !lua_isnil(L, -1);
+        lua_pop(L, 1);
+        if (present) {
+            error = std::string{"options."} + key + " is not supported by " + function_name;
             return false;
         }
-        max_recursion_depth = static_cast<std::size_t>(v);
     }
-    lua_pop(L, 1);
 
     return true;
 }
 
 /**
- * @brief Userdata payload for a compiled schema.
+ * @brief Process-wide LRU cache of compiled templates.
  *
- * We store the Blaze template by value directly inside the userdata.
+ * Keyed by compilation mode, default dialect and the exact schema text, so a
+ * hit is guaranteed to yield the template a fresh compilation would produce.
+ * Entries are indexed by the hash of that key and keep its only copy, which
+ * a lookup compares against; a hash collision is a miss. Templates are
+ * immutable once compiled and are shared by every `CompiledSchema` created
+ * from the same entry; evicting or clearing an entry never invalidates
+ * schemas that already hold it.
  *
- * @var schema_template The compiled Blaze template
- * @var max_array_length Maximum array length when converting Lua tables to JSON (0 = unlimited)
- * @var max_depth Maximum nesting depth when parsing JSON strings (0 = unlimited)
- * @var max_recursion_depth Maximum recursion depth for table conversion (0 = unlimited)
- * @var mode_name Mode used for compilation ("Fast" or "Exhaustive")
- * @var dialect_name Dialect used for compilation
+ * The cache is bounded by its number of entries and by the bytes they
+ * account for (key plus approximate template footprint).
+ *
+ * All members are safe to call concurrently from different threads.
  */
-struct CompiledSchema {
-    sourcemeta::blaze::Template schema_template;
-    sourcemeta::blaze::Evaluator evaluator;
-    std::size_t max_array_length;
-    std::size_t max_depth;
-    std::size_t max_recursion_depth;
-    const char *mode_name; // Static string pointer ("Fast" or "Exhaustive")
-    std::string dialect_name;
-};
+class TemplateCache {
+public:
+    struct Stats {
+        std::size_t entries;
+        std::size_t max_entries;
+        std::size_t bytes;
+        std::size_t max_bytes;
+        std::uint64_t hits;
+        std::uint64_t misses;
+        std::uint64_t evictions;
+    };
 
-struct CompiledSchemaUserdata {
-    CompiledSchema *ptr;
-};
+    auto find(const std::string &key) -> std::shared_ptr<const sourcemeta::blaze::Template> {
+        const auto hash = std::hash<std::string_view>{}(key);
+        const std::lock_guard<std::mutex> lock{this->mutex};
+        const auto match = this->entries.find(hash);
+        if (match == this->entries.end() || match->second.key != key) {
+            this->misses++;
+            return nullptr;
+        }
 
-static bool lua_value_to_json(lua_State *L, int index, std::unordered_set<const void *> &seen,
-                              const std::size_t max_array_length, const std::size_t max_recursion_depth,
-                              std::size_t depth, sourcemeta::core::JSON &out, std::string &error);
+        this->hits++;
+        this->lru.splice(this->lru.begin(), this->lru, match->second.position);
+        return match->second.schema_template;
+    }
 
-static bool lua_value_to_json_abs(lua_State *L, int abs_index, std::unordered_set<const void *> &seen,
-                                  const std::size_t max_array_length, const std::size_t max_recursion_depth,
-                                  std::size_t depth, sourcemeta::core::JSON &out, std::string &error);
+    // Cache `schema_template` under `key`. `template_bytes` is its approximate
+    // footprint, as reported by `measure_template`.
+    auto insert(std::string key, std::shared_ptr<const sourcemeta::blaze::Template> schema_template,
+                const std::size_t template_bytes) -> void {
+        const auto hash  = std::hash<std::string_view>{}(key);
+        const auto bytes = key.size() + template_bytes;
+        const std::lock_guard<std::mutex> lock{this->mutex};
+        // Compiled concurrently by another state, or a colliding key; keep
+        // the first one
+        const auto [match, inserted] =
+            this->entries.try_emplace(hash, Entry{std::move(key), std::move(schema_template), bytes, {}});
+        if (!inserted) {
+            return;
+        }
 
-static bool lua_table_to_json_abs(lua_State *L, int abs_index, std::unordered_set<const void *> &seen,
-                                  const std::size_t max_array_length, const std::size_t max_recursion_depth,
-                                  std::size_t depth, sourcemeta::core::JSON &out, std::string &error);
+        this->lru.push_front(&*match);
+        match->second.position = this->lru.begin();
+        this->bytes += bytes;
+        this->evict_locked();
+    }
 
-// Convert a JSON value to a Lua value and push it onto the stack.
-// Returns true on success, false on error (with error message in error string).
-static bool json_to_lua_value(lua_State *L, const sourcemeta::core::JSON &value, const std::size_t max_recursion_depth,
-                              std::size_t depth, std::string &error);
+    auto clear() -> void {
+        const std::lock_guard<std::mutex> lock{this->mutex};
+        this->lru.clear();
+        this->entries.clear();
+        this->bytes = 0;
+    }
 
-static bool json_object_to_lua_table(lua_State *L, const sourcemeta::core::JSON &obj,
-                                     const std::size_t max_recursion_depth, std::size_t depth, std::string &error) {
-    // Ensure we have enough stack space for the table and at least one value
-    if (!lua_checkstack(L, 3)) {
-        error = "Cannot grow Lua stack (stack overflow risk)";
-        return false;
+    // Set the maximum number of cached templates and their bytes (0 =
+    // unlimited), evicting the least recently used entries if needed.
+    auto set_limits(const std::size_t entries_limit, const std::size_t bytes_limit) -> void {
+        const std::lock_guard<std::mutex> lock{this->mutex};
+        this->max_entries = entries_limit;
+        this->max_bytes   = bytes_limit;
+        this->evict_locked();
     }
-    lua_createtable(L, 0, static_cast<int>(obj.size()));
-    for (const auto &pair : obj.as_object()) {
-        if (!json_to_lua_value(L, pair.second, max_recursion_depth, depth + 1, error)) {
-            lua_pop(L, 1); // Clean up partial table on error
-            error = "Error converting JSON object property '" + pair.first + "': " + error;
-            return false;
+
+    auto stats() -> Stats {
+        const std::lock_guard<std::mutex> lock{this->mutex};
+        return {this->entries.size(), this->max_entries, this->bytes,    this->max_bytes,
+                this->hits,           this->misses,      this->evictions};
+    }
+
+private:
+    struct Entry;
+    using Node = std::pair<const std::size_t, Entry>;
+
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const sourcemeta::blaze::Template> schema_template;
+        std::size_t bytes;
+        std::list<Node *>::iterator position;
+    };
+
+    auto evict_locked() -> void {
+        while (!this->lru.empty() && ((this->max_entries > 0 && this->entries.size() > this->max_entries) ||
+                                      (this->max_bytes > 0 && this->bytes > this->max_bytes))) {
+            const Node *node = this->lru.back();
+            this->lru.pop_back();
+            this->bytes -= node->second.bytes;
+            this->entries.erase(node->first);
+            this->evictions++;
         }
-        lua_setfield(L, -2, pair.first.c_str());
     }
-    return true;
+
+    std::mutex mutex;
+    std::list<Node *> lru; // Most recently used first
+    std::unordered_map<std::size_t, Entry> entries;
+    std::size_t max_entries{LUABLAZE_DEFAULT_TEMPLATE_CACHE_SIZE};
+    std::size_t max_bytes{0};
+    std::size_t bytes{0};
+    std::uint64_t hits{0};
+    std::uint64_t misses{0};
+    std::uint64_t evictions{0};
+};
+
+static auto template_cache() -> TemplateCache & {
+    static TemplateCache cache;
+    return cache;
 }
 
-static bool json_array_to_lua_table(lua_State *L, const sourcemeta::core::JSON &arr,
-                                    const std::size_t max_recursion_depth, std::size_t depth, std::string &error) {
-    const std::size_t size = arr.size();
-    // Ensure we have enough stack space for the table and at least one value
-    if (!lua_checkstack(L, 3)) {
-        error = "Cannot grow Lua stack (stack overflow risk)";
+// Build the template cache key for a schema compiled with `options`. Schemas
+// compiled against a registry are keyed by its identity and revision too.
+static auto template_cache_key(const std::string_view schema, const SchemaOptions &options) -> std::string {
+    const auto dialect = options.default_dialect.value_or("");
+    std::string key;
+    key.reserve(schema.size() + dialect.size() + 5);
+    key.push_back(options.mode == sourcemeta::blaze::Mode::FastValidation ? 'F' : 'E');
+    key.push_back(options.compact ? 'C' : '-');
+    key.push_back('\0');
+    key.append(dialect);
+    key.push_back('\0');
+    if (options.registry != nullptr) {
+        key.append(options.registry->cache_key());
+    }
+    key.push_back('\0');
+    key.append(schema);
+    return key;
+}
+
+/**
+ * @brief Which parts of an instance a schema can observe.
+ *
+ * Computed from the schema JSON by `analyze_projection` for `{ project = true }`
+ * and consulted while converting Lua tables:
+ *
+ * - `Full`: convert the value as usual
+ * - `Any`: the schema never looks at the value beyond its presence, so a cheap
+ *   placeholder of the same JSON type is converted instead
+ * - `Object`: if the value is an object, look each property up in
+ *   `properties` (sorted by name); other properties are `Full` when
+ *   `others_observed` is set and `Any` otherwise
+ */
+struct Projection {
+    enum class Kind : std::uint8_t { Full, Any, Object };
+    struct Property;
+
+    Kind kind{Kind::Full};
+    std::vector<Property> properties;
+    bool others_observed{false};
+
+    // Projection of property `name`, or null if it must be converted in full
+    auto child(std::string_view name) const -> const Projection *;
+};
+
+struct Projection::Property {
+    std::string name;
+    Projection projection;
+};
+
+auto Projection::child(const std::string_view name) const -> const Projection * {
+    static const Projection any{Kind::Any, {}, false};
+    const auto match =
+        std::lower_bound(this->properties.begin(), this->properties.end(), name,
+                         [](const Property &property, const std::string_view value) { return property.name < value; });
+    const Projection *result = match != this->properties.end() && match->name == name ? &match->projection
+                               : this->others_observed                              ? nullptr
+                                                                                    : &any;
+    return result != nullptr && result->kind == Kind::Full ? nullptr : result;
+}
+
+// Keywords that never affect the validation result
+static auto is_annotation_keyword(const std::string_view keyword) -> bool {
+    static constexpr std::string_view keywords[] = {
+        "$schema", "$id",     "id",         "$anchor",  "$comment",  "$defs",    "definitions",
+        "title",   "default", "description", "examples", "deprecated", "readOnly", "writeOnly"};
+    return std::find(std::begin(keywords), std::end(keywords), keyword) != std::end(keywords);
+}
+
+// Whether `schema` is written in JSON Schema 2019-09 or 2020-12, judging by
+// its `$schema` or, failing that, by `default_dialect`. Any other dialect,
+// including custom metaschemas, counts as neither.
+static auto uses_modern_dialect(const sourcemeta::core::JSON &schema,
+                                const std::optional<std::string> &default_dialect) -> bool {
+    const auto *declared = schema.is_object() ? schema.try_at("$schema") : nullptr;
+    if (declared != nullptr && !declared->is_string()) {
         return false;
     }
-    lua_createtable(L, static_cast<int>(size), 0);
-    for (std::size_t i = 0; i < size; i++) {
-        if (!json_to_lua_value(L, arr.at(i), max_recursion_depth, depth + 1, error)) {
-            lua_pop(L, 1); // Clean up partial table on error
-            error = "Error converting JSON array at index " + std::to_string(i) + ": " + error;
-            return false;
+
+    std::string_view dialect;
+    if (declared != nullptr) {
+        dialect = declared->to_string();
+    } else if (default_dialect.has_value()) {
+        dialect = default_dialect.value();
+    }
+
+    for (const std::string_view known :
+         {"https://json-schema.org/draft/2020-12/schema", "https://json-schema.org/draft/2019-09/schema"}) {
+        if (dialect == known || (dialect.size() == known.size() + 1 && dialect.starts_with(known) &&
+                                 dialect.back() == '#')) {
+            return true;
         }
-        lua_rawseti(L, -2, static_cast<lua_Integer>(i + 1));
     }
-    return true;
+    return false;
 }
 
-static bool json_to_lua_value(lua_State *L, const sourcemeta::core::JSON &value, const std::size_t max_recursion_depth,
-                              std::size_t depth, std::string &error) {
-    // Check recursion depth to prevent stack overflow (0 = unlimited)
-    if (max_recursion_depth > 0 && depth > max_recursion_depth) {
-        error = "Maximum recursion depth exceeded in JSON conversion (depth=" + std::to_string(depth) + ")";
-        return false;
+// Work out which parts of an instance `schema` observes. The analysis is
+// deliberately conservative: only annotations and the object keywords
+// `type`, `properties`, `required`, `additionalProperties`, `minProperties`
+// and `maxProperties` are understood, and any other keyword (`$ref`,
+// applicators, `patternProperties`, `unevaluatedProperties`, ...) makes the
+// whole subtree `Full`. Only meant for schemas that `uses_modern_dialect`
+// accepts; older drafts give some of these keywords other meanings.
+static auto analyze_projection(const sourcemeta::core::JSON &schema) -> Projection {
+    // `true` accepts any value and `false` rejects any value
+    if (schema.is_boolean()) {
+        return Projection{Projection::Kind::Any, {}, false};
     }
 
-    if (value.is_null()) {
-        lua_pushnil(L);
-        return true;
+    if (!schema.is_object()) {
+        return Projection{};
     }
-    if (value.is_boolean()) {
-        lua_pushboolean(L, value.to_boolean());
-        return true;
+
+    Projection result{Projection::Kind::Any, {}, false};
+    for (const auto &entry : schema.as_object()) {
+        const auto &keyword = entry.first;
+        if (is_annotation_keyword(keyword)) {
+            continue;
+        }
+
+        if (keyword == "type" || keyword == "required" || keyword == "minProperties" || keyword == "maxProperties" ||
+            keyword == "additionalProperties" || (keyword == "properties" && entry.second.is_object())) {
+            result.kind = Projection::Kind::Object;
+            continue;
+        }
+
+        return Projection{};
     }
-    if (value.is_integer()) {
-        lua_pushinteger(L, static_cast<lua_Integer>(value.to_integer()));
-        return true;
+
+    if (result.kind != Projection::Kind::Object) {
+        return result;
     }
-    if (value.is_real()) {
-        lua_pushnumber(L, static_cast<lua_Number>(value.to_real()));
-        return true;
+
+    if (const auto *properties = schema.try_at("properties"); properties != nullptr) {
+        for (const auto &entry : properties->as_object()) {
+            result.properties.push_back({entry.first, analyze_projection(entry.second)});
+        }
+        std::sort(result.properties.begin(), result.properties.end(),
+                  [](const auto &left, const auto &right) { return left.name < right.name; });
     }
-    if (value.is_string()) {
+
+    if (const auto *additional = schema.try_at("additionalProperties"); additional != nullptr) {
+        result.others_observed = analyze_projection(*additional).kind != Projection::Kind::Any;
+    }
+
+    return result;
+}
+
+/**
+ * @brief A schema split by top-level property for `TrackedDocument:validate()`.
+ *
+ * Built by `decompose_schema` for `{ incremental = true }`. An object
+ * instance is valid exactly when it passes `shape` (the root schema without
+ * `properties` and `additionalProperties`, whose remaining keywords only
+ * look at the property names) and every property passes its part:
+ * `properties[name]` if the schema lists it, `additional` otherwise. Any
+ * other instance is evaluated against the whole template.
+ */
+struct Decomposition {
+    // A compiled subschema, or a constant result when `schema_template` is null
+    struct Part {
+        std::shared_ptr<const sourcemeta::blaze::Template> schema_template;
+        bool value;
+    };
+
+    std::shared_ptr<const sourcemeta::blaze::Template> shape;
+    std::unordered_map<std::string, Part> properties;
+    Part additional{nullptr, true};
+
+    auto part(const std::string &name) const -> const Part & {
+        const auto match = this->properties.find(name);
+        return match == this->properties.end() ? this->additional : match->second;
+    }
+};
+
+/**
+ * @brief Process-wide registry of published templates.
+ *
+ * Maps names to compiled templates (plus the options they were compiled
+ * with) so that any `lua_State` in the process, on any thread, can create a
+ * `CompiledSchema` around an already compiled template instead of compiling
+ * its own copy. Each acquired schema gets its own `Evaluator` and conversion
+ * limits; only the immutable template is shared.
+ *
+ * All members are safe to call concurrently from different threads.
+ */
+class TemplateRegistry {
+public:
+    struct Entry {
+        std::shared_ptr<const sourcemeta::blaze::Template> schema_template;
+        SchemaOptions options;
+        std::shared_ptr<const Projection> projection;
+        std::shared_ptr<const Decomposition> decomposition;
+    };
+
+    // Publish `entry` under `name`, replacing any previous entry
+    auto publish(const std::string &name, Entry entry) -> void {
+        const std::lock_guard<std::mutex> lock{this->mutex};
+        this->entries.insert_or_assign(name, std::move(entry));
+    }
+
+    auto find(const std::string &name) -> std::optional<Entry> {
+        const std::lock_guard<std::mutex> lock{this->mutex};
+        const auto match = this->entries.find(name);
+        if (match == this->entries.end()) {
+            return std::nullopt;
+        }
+
+        return match->second;
+    }
+
+    auto unpublish(const std::string &name) -> bool {
+        const std::lock_guard<std::mutex> lock{this->mutex};
+        return this->entries.erase(name) > 0;
+    }
+
+    auto names() -> std::vector<std::string> {
+        const std::lock_guard<std::mutex> lock{this->mutex};
+        std::vector<std::string> result;
+        result.reserve(this->entries.size());
+        for (const auto &entry : this->entries) {
+            result.push_back(entry.first);
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+private:
+    std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+};
+
+static auto template_registry() -> TemplateRegistry & {
+    static TemplateRegistry registry;
+    return registry;
+}
+
+/**
+ * @brief Reusable scratch state for Lua table -> JSON conversion.
+ *
+ * Cycle detection only needs the tables currently being converted, which form
+ * a stack indexed by depth: a table closes a cycle exactly when it is already
+ * on the stack. Normal nesting is shallow, so a linear scan beats hashing;
+ * entries deeper than `LINEAR_SCAN_LIMIT` are additionally indexed in a hash
+ * set so that pathological nesting stays linear.
+ *
+ * The containers keep their capacity between calls, so steady-state
+ * conversions do not allocate for cycle detection.
+ *
+ * `projection` is the projection of the next table to convert; callers set it
+ * right before every recursive conversion (null = convert in full).
+ */
+struct ConversionScratch {
+    static constexpr std::size_t LINEAR_SCAN_LIMIT = 64;
+
+    std::vector<const void *> active_tables;
+    std::unordered_set<const void *> deep_tables;
+    const Projection *projection{nullptr};
+
+    auto reset() -> void {
+        active_tables.clear();
+        deep_tables.clear();
+    }
+
+    // Push `table` onto the conversion stack. Returns false if the table is
+    // already being converted (i.e. a cycle was found).
+    auto enter(const void *table) -> bool {
+        const auto shallow_end =
+            active_tables.begin() + static_cast<std::ptrdiff_t>(std::min(active_tables.size(), LINEAR_SCAN_LIMIT));
+        if (std::find(active_tables.begin(), shallow_end, table) != shallow_end) {
+            return false;
+        }
+
+        if (active_tables.size() >= LINEAR_SCAN_LIMIT && !deep_tables.insert(table).second) {
+            return false;
+        }
+
+        active_tables.push_back(table);
+        return true;
+    }
+
+    // Pop the innermost table pushed by `enter`.
+    auto leave() -> void {
+        if (active_tables.size() > LINEAR_SCAN_LIMIT) {
+            deep_tables.erase(active_tables.back());
+        }
+        active_tables.pop_back();
+    }
+};
+
+/**
+ * @brief Runtime counters of a `CompiledSchema` created with `{ stats = true }`.
+ *
+ * Only ever touched from the thread that owns the schema, so the counters are
+ * plain integers. Stage times are accumulated in nanoseconds; `latency` is a
+ * histogram of whole-call latency with decade buckets from 1us to 1s plus an
+ * overflow bucket.
+ *
+ * @var validations Instances that were validated
+ * @var invalid Instances that did not match the schema
+ * @var errors Instances that failed to convert or parse
+ * @var conversion_ns Time spent converting Lua tables to JSON
+ * @var parse_ns Time spent parsing JSON text
+ * @var evaluation_ns Time spent evaluating the template
+ * @var report_ns Time spent building detailed reports
+ * @var latency_ns Total latency of all validated instances
+ * @var latency Per-bucket (non-cumulative) latency counts
+ */
+struct SchemaStats {
+    static constexpr std::size_t LATENCY_BUCKETS = 8;
+    // Upper bounds of all but the overflow bucket, in nanoseconds
+    static constexpr std::array<std::uint64_t, LATENCY_BUCKETS - 1> LATENCY_BOUNDS_NS{
+        1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+    std::uint64_t validations{0};
+    std::uint64_t invalid{0};
+    std::uint64_t errors{0};
+    std::uint64_t conversion_ns{0};
+    std::uint64_t parse_ns{0};
+    std::uint64_t evaluation_ns{0};
+    std::uint64_t report_ns{0};
+    std::uint64_t latency_ns{0};
+    std::array<std::uint64_t, LATENCY_BUCKETS> latency{};
+
+    auto record(const bool valid, const std::uint64_t elapsed_ns) -> void {
+        validations++;
+        if (!valid) {
+            invalid++;
+        }
+        latency_ns += elapsed_ns;
+        const auto bucket = std::lower_bound(LATENCY_BOUNDS_NS.begin(), LATENCY_BOUNDS_NS.end(), elapsed_ns);
+        latency[static_cast<std::size_t>(bucket - LATENCY_BOUNDS_NS.begin())]++;
+    }
+};
+
+/**
+ * @brief Times the stages of validating one instance into a `SchemaStats`.
+ *
+ * Every member is a no-op when `stats` is null, so schemas without
+ * statistics never read the clock. Call `lap` after each stage to charge the
+ * time since the previous lap to that stage, then `finish` with the result. An
+ * instance whose timer is destroyed without `finish` (an exception escaped)
+ * is counted as an error.
+ */
+class StatsTimer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit StatsTimer(SchemaStats *stats) : stats{stats} {
+        if (this->stats != nullptr) {
+            this->start = Clock::now();
+            this->last  = this->start;
+        }
+    }
+
+    ~StatsTimer() {
+        if (this->stats != nullptr && !this->finished) {
+            this->stats->errors++;
+        }
+    }
+
+    StatsTimer(const StatsTimer &)                     = delete;
+    auto operator=(const StatsTimer &) -> StatsTimer & = delete;
+
+    auto lap(std::uint64_t SchemaStats::*stage) -> void {
+        if (this->stats == nullptr) {
+            return;
+        }
+        const auto now = Clock::now();
+        this->stats->*stage += elapsed_ns(this->last, now);
+        this->last = now;
+    }
+
+    auto finish(const bool valid) -> void {
+        if (this->stats == nullptr || this->finished) {
+            return;
+        }
+        this->finished = true;
+        this->stats->record(valid, elapsed_ns(this->start, Clock::now()));
+    }
+
+private:
+    static auto elapsed_ns(const Clock::time_point from, const Clock::time_point to) -> std::uint64_t {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+    }
+
+    SchemaStats *const stats;
+    Clock::time_point start{};
+    Clock::time_point last{};
+    bool finished{false};
+};
+
+/**
+ * @brief Approximate size of a compiled template.
+ *
+ * Counts the instruction nodes and their keyword location strings. Values
+ * (regexes, enum constants, ...) only contribute their inline size, so
+ * `bytes` is a lower bound meant for comparing schemas and sizing caches.
+ */
+struct TemplateFootprint {
+    std::size_t instructions{0};
+    std::size_t bytes{0};
+};
+
+static auto measure_instructions(const sourcemeta::blaze::Instructions &instructions, TemplateFootprint &footprint)
+    -> void {
+    footprint.bytes += instructions.capacity() * sizeof(sourcemeta::blaze::Instruction);
+    for (const auto &instruction : instructions) {
+        footprint.instructions++;
+        footprint.bytes += instruction.keyword_location.size();
+        measure_instructions(instruction.children, footprint);
+    }
+}
+
+static auto measure_template(const sourcemeta::blaze::Template &schema_template) -> TemplateFootprint {
+    TemplateFootprint footprint;
+    footprint.bytes = sizeof(sourcemeta::blaze::Template) +
+                      schema_template.targets.capacity() * sizeof(sourcemeta::blaze::Instructions);
+    for (const auto &target : schema_template.targets) {
+        measure_instructions(target, footprint);
+    }
+    return footprint;
+}
+
+// Clear the keyword locations of `instructions` and their children. The
+// evaluator never reads them; only output formats and evaluation callbacks do.
+static auto strip_keyword_locations(sourcemeta::blaze::Instructions &instructions) -> void {
+    for (auto &instruction : instructions) {
+        instruction.keyword_location.clear();
+        instruction.keyword_location.shrink_to_fit();
+        strip_keyword_locations(instruction.children);
+    }
+}
+
+static auto compact_template(const sourcemeta::blaze::Template &schema_template) -> sourcemeta::blaze::Template {
+    auto result = schema_template;
+    for (auto &target : result.targets) {
+        strip_keyword_locations(target);
+    }
+    return result;
+}
+
+// Compile `schema` as `luablaze.new` would with `options`
+static auto compile_schema_template(const sourcemeta::core::JSON &schema, const SchemaOptions &options)
+    -> std::shared_ptr<const sourcemeta::blaze::Template> {
+    auto compiled = sourcemeta::blaze::compile(schema, sourcemeta::core::schema_walker,
+                                               make_schema_resolver(options.registry),
+                                               sourcemeta::blaze::default_schema_compiler, options.mode,
+                                               options.default_dialect);
+    return std::make_shared<const sourcemeta::blaze::Template>(options.compact ? compact_template(compiled)
+                                                                               : std::move(compiled));
+}
+
+// Whether `value` uses a reference keyword anywhere, which a subschema
+// compiled on its own could not resolve
+static auto has_reference_keyword(const sourcemeta::core::JSON &value) -> bool {
+    if (value.is_array()) {
+        return std::any_of(value.as_array().begin(), value.as_array().end(),
+                           [](const auto &element) { return has_reference_keyword(element); });
+    }
+
+    if (!value.is_object()) {
+        return false;
+    }
+
+    for (const auto &entry : value.as_object()) {
+        if (entry.first == "$ref" || entry.first == "$dynamicRef" || entry.first == "$recursiveRef" ||
+            has_reference_keyword(entry.second)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Split `schema` for `{ incremental = true }`, or return null if it cannot
+// be split. Only 2019-09 and 2020-12 schemas whose root uses nothing but
+// annotations, `type`, `required`, `minProperties`, `maxProperties`,
+// `properties` and `additionalProperties` qualify, and only if no subschema
+// uses a reference keyword, so that every part compiles on its own.
+static auto decompose_schema(const sourcemeta::core::JSON &schema, const SchemaOptions &options)
+    -> std::shared_ptr<const Decomposition> {
+    if (!schema.is_object() || !uses_modern_dialect(schema, options.default_dialect) ||
+        has_reference_keyword(schema)) {
+        return nullptr;
+    }
+
+    const auto *properties = schema.try_at("properties");
+    const auto *additional = schema.try_at("additionalProperties");
+    if ((properties != nullptr && !properties->is_object()) ||
+        (additional != nullptr && !additional->is_object() && !additional->is_boolean())) {
+        return nullptr;
+    }
+
+    auto shape = sourcemeta::core::JSON::make_object();
+    for (const auto &entry : schema.as_object()) {
+        const auto &keyword = entry.first;
+        if (keyword == "properties" || keyword == "additionalProperties") {
+            continue;
+        }
+
+        if (!is_annotation_keyword(keyword) && keyword != "type" && keyword != "required" &&
+            keyword != "minProperties" && keyword != "maxProperties") {
+            return nullptr;
+        }
+
+        shape.assign(keyword, entry.second);
+    }
+
+    // Parts are compiled as schemas of their own, in the dialect of the root
+    const auto *dialect = schema.try_at("$schema");
+    const auto compile_part = [&options, dialect](const sourcemeta::core::JSON &subschema) -> Decomposition::Part {
+        if (subschema.is_boolean()) {
+            return {nullptr, subschema.to_boolean()};
+        }
+
+        auto standalone = subschema;
+        if (dialect != nullptr && standalone.is_object() && !standalone.defines("$schema")) {
+            standalone.assign("$schema", *dialect);
+        }
+        return {compile_schema_template(standalone, options), true};
+    };
+
+    auto result   = std::make_shared<Decomposition>();
+    result->shape = compile_schema_template(shape, options);
+    if (properties != nullptr) {
+        for (const auto &entry : properties->as_object()) {
+            result->properties.insert_or_assign(entry.first, compile_part(entry.second));
+        }
+    }
+    if (additional != nullptr) {
+        result->additional = compile_part(*additional);
+    }
+    return result;
+}
+
+/**
+ * @brief Userdata payload for a compiled schema.
+ *
+ * The userdata only holds a pointer to this struct. The compiled template
+ * is held through a `std::shared_ptr<const Template>` and is never modified
+ * after compilation, so one template can back many schemas at once: those
+ * created from the same template cache entry, those acquired from the
+ * template registry, and the routes of a `SchemaSet`. Each schema keeps its
+ * own evaluator, limits and scratch state.
+ *
+ * @var schema_template The compiled Blaze template (immutable, shared through the template cache, registry and acquire)
+ * @var max_array_length Maximum array length when converting Lua tables (0 = unlimited)
+ * @var max_depth Maximum nesting depth when parsing JSON strings (0 = unlimited)
+ * @var max_input_bytes Maximum size of a JSON instance string (0 = unlimited)
+ * @var max_json_array_length Maximum array length when parsing JSON strings (0 = unlimited)
+ * @var max_string_length Maximum string length when parsing JSON strings (0 = unlimited)
+ * @var max_object_properties Maximum object property count when parsing JSON strings (0 = unlimited)
+ * @var max_recursion_depth Maximum recursion depth for table conversion (0 = unlimited)
+ * @var mode_name Mode used for compilation ("Fast" or "Exhaustive")
+ * @var dialect_name Dialect used for compilation
+ * @var cached Whether the template came from or went into the template cache
+ * @var compact Whether the template was compacted (no keyword locations)
+ * @var instruction_count Number of instructions in the template
+ * @var approx_bytes Approximate heap footprint of the template
+ * @var scratch Conversion scratch state reused across validation calls
+ * @var stats Runtime statistics, or null unless created with `{ stats = true }`
+ * @var projection Fields that table conversion may skip, or null unless created with `{ project = true }`
+ * @var decomposition Parts `TrackedDocument:validate()` re-evaluates separately, or null unless created with
+ *      `{ incremental = true }` from a schema that can be split
+ */
+struct CompiledSchema {
+    std::shared_ptr<const sourcemeta::blaze::Template> schema_template;
+    sourcemeta::blaze::Evaluator evaluator;
+    std::size_t max_array_length;
+    std::size_t max_depth;
+    std::size_t max_input_bytes;
+    std::size_t max_json_array_length;
+    std::size_t max_string_length;
+    std::size_t max_object_properties;
+    std::size_t max_recursion_depth;
+    const char *mode_name; // Static string pointer ("Fast" or "Exhaustive")
+    std::string dialect_name;
+    bool cached;
+    bool compact;
+    std::size_t instruction_count;
+    std::size_t approx_bytes;
+    ConversionScratch scratch;
+    std::unique_ptr<SchemaStats> stats;
+    std::shared_ptr<const Projection> projection;
+    std::shared_ptr<const Decomposition> decomposition;
+};
+
+struct CompiledSchemaUserdata {
+    CompiledSchema *ptr;
+};
+
+// Explicit JSON type marker attached to a Lua table through its metatable.
+enum class TableHint { None, Array, Object };
+
+static auto table_hint_from_value(lua_State *L, const int index) -> TableHint {
+    if (lua_type(L, index) != LUA_TSTRING) {
+        return TableHint::None;
+    }
+
+    std::size_t len{0};
+    const char *str   = lua_tolstring(L, index, &len);
+    const auto marker = std::string_view{str, len};
+    if (marker == "array") {
+        return TableHint::Array;
+    }
+
+    if (marker == "object") {
+        return TableHint::Object;
+    }
+
+    return TableHint::None;
+}
+
+// Convert a Lua value into a `sourcemeta::core::JSON` instance.
+//
+// Blaze evaluates owning `sourcemeta::core::JSON` values only, so strings and
+// keys are necessarily copied out of Lua memory. The conversion builds every
+// node exactly once, in place, and moves it into its parent container.
+static bool lua_value_to_json(lua_State *L, int index, ConversionScratch &scratch,
+                              const std::size_t max_array_length, const std::size_t max_recursion_depth,
+                              std::size_t depth, sourcemeta::core::JSON &out, std::string &error);
+
+static bool lua_value_to_json_abs(lua_State *L, int abs_index, ConversionScratch &scratch,
+                                  const std::size_t max_array_length, const std::size_t max_recursion_depth,
+                                  std::size_t depth, sourcemeta::core::JSON &out, std::string &error);
+
+static bool lua_table_to_json_abs(lua_State *L, int abs_index, ConversionScratch &scratch,
+                                  const std::size_t max_array_length, const std::size_t max_recursion_depth,
+                                  std::size_t depth, sourcemeta::core::JSON &out, std::string &error);
+
+// Convert a non-table Lua value (nil, boolean, number or string) of type `t`.
+// Table elements and object values take this path directly, so leaves do not
+// pay for a second type dispatch through `lua_value_to_json_abs`.
+static bool lua_scalar_to_json(lua_State *L, int abs_index, int t, const std::size_t max_recursion_depth,
+                               std::size_t depth, sourcemeta::core::JSON &out, std::string &error);
+
+/**
+ * @brief How JSON values without a natural Lua counterpart are decoded.
+ *
+ * Every field is the absolute stack index of a Lua value, or 0 for the
+ * default, so a sentinel such as `cjson.null` never has to leave the stack.
+ *
+ * @var null_index Value pushed for JSON null (default: nil)
+ * @var array_mt_index Metatable set on tables decoded from arrays (default: none)
+ * @var object_mt_index Metatable set on tables decoded from objects (default: none)
+ */
+struct LuaDecodeStyle {
+    int null_index{0};
+    int array_mt_index{0};
+    int object_mt_index{0};
+};
+
+// Convert a JSON value to a Lua value and push it onto the stack.
+// Returns true on success, false on error (with error message in error string).
+static bool json_to_lua_value(lua_State *L, const sourcemeta::core::JSON &value, const std::size_t max_recursion_depth,
+                              std::size_t depth, std::string &error, const LuaDecodeStyle *style = nullptr);
+
+static bool json_object_to_lua_table(lua_State *L, const sourcemeta::core::JSON &obj,
+                                     const std::size_t max_recursion_depth, std::size_t depth, std::string &error,
+                                     const LuaDecodeStyle *style) {
+    // Ensure we have enough stack space for the table and at least one value
+    if (!lua_checkstack(L, 3)) {
+        error = "Cannot grow Lua stack (stack overflow risk)";
+        return false;
+    }
+    lua_createtable(L, 0, static_cast<int>(obj.size()));
+    for (const auto &pair : obj.as_object()) {
+        // Keys may contain NUL bytes, so push them with their length
+        lua_pushlstring(L, pair.first.data(), pair.first.size());
+        if (!json_to_lua_value(L, pair.second, max_recursion_depth, depth + 1, error, style)) {
+            lua_pop(L, 2); // Clean up the key and the partial table on error
+            error = "Error converting JSON object property '" + pair.first + "': " + error;
+            return false;
+        }
+        lua_rawset(L, -3);
+    }
+    if (style != nullptr && style->object_mt_index != 0) {
+        lua_pushvalue(L, style->object_mt_index);
+        lua_setmetatable(L, -2);
+    }
+    return true;
+}
+
+static bool json_array_to_lua_table(lua_State *L, const sourcemeta::core::JSON &arr,
+                                    const std::size_t max_recursion_depth, std::size_t depth, std::string &error,
+                                    const LuaDecodeStyle *style) {
+    const std::size_t size = arr.size();
+    // Ensure we have enough stack space for the table and at least one value
+    if (!lua_checkstack(L, 3)) {
+        error = "Cannot grow Lua stack (stack overflow risk)";
+        return false;
+    }
+    lua_createtable(L, static_cast<int>(size), 0);
+    for (std::size_t i = 0; i < size; i++) {
+        if (!json_to_lua_value(L, arr.at(i), max_recursion_depth, depth + 1, error, style)) {
+            lua_pop(L, 1); // Clean up partial table on error
+            error = "Error converting JSON array at index " + std::to_string(i) + ": " + error;
+            return false;
+        }
+        lua_rawseti(L, -2, static_cast<lua_Integer>(i + 1));
+    }
+    if (style != nullptr && style->array_mt_index != 0) {
+        lua_pushvalue(L, style->array_mt_index);
+        lua_setmetatable(L, -2);
+    }
+    return true;
+}
+
+static bool json_to_lua_value(lua_State *L, const sourcemeta::core::JSON &value, const std::size_t max_recursion_depth,
+                              std::size_t depth, std::string &error, const LuaDecodeStyle *style) {
+    // Check recursion depth to prevent stack overflow (0 = unlimited)
+    if (max_recursion_depth > 0 && depth > max_recursion_depth) {
+        error = "Maximum recursion depth exceeded in JSON conversion (depth=" + std::to_string(depth) + ")";
+        return false;
+    }
+
+    if (value.is_null()) {
+        if (style != nullptr && style->null_index != 0) {
+            lua_pushvalue(L, style->null_index);
+        } else {
+            lua_pushnil(L);
+        }
+        return true;
+    }
+    if (value.is_boolean()) {
+        lua_pushboolean(L, value.to_boolean());
+        return true;
+    }
+    if (value.is_integer()) {
+        lua_pushinteger(L, static_cast<lua_Integer>(value.to_integer()));
+        return true;
+    }
+    if (value.is_real()) {
+        lua_pushnumber(L, static_cast<lua_Number>(value.to_real()));
+        return true;
+    }
+    if (value.is_string()) {
         const auto &str = value.to_string();
         lua_pushlstring(L, str.data(), str.size());
         return true;
     }
     if (value.is_array()) {
-        return json_array_to_lua_table(L, value, max_recursion_depth, depth, error);
+        return json_array_to_lua_table(L, value, max_recursion_depth, depth, error, style);
     }
     if (value.is_object()) {
-        return json_object_to_lua_table(L, value, max_recursion_depth, depth, error);
+        return json_object_to_lua_table(L, value, max_recursion_depth, depth, error, style);
+    }
+    error = "Unsupported JSON type for Lua conversion";
+    return false;
+}
+
+static bool lua_table_to_json(lua_State *L, int index, ConversionScratch &scratch,
+                              const std::size_t max_array_length, const std::size_t max_recursion_depth,
+                              std::size_t depth, sourcemeta::core::JSON &out, std::string &error) {
+    const int abs_index = lua_absindex(L, index);
+    return lua_table_to_json_abs(L, abs_index, scratch, max_array_length, max_recursion_depth, depth, out, error);
+}
+
+// Determine whether a Lua table carries an explicit array/object marker.
+//
+// A table is marked when its metatable is `luablaze.array_mt` /
+// `luablaze.object_mt`, was registered through `luablaze.register_metatable`
+// (e.g. lua-cjson's `array_mt` / `empty_array_mt`), or defines a
+// `__jsontype` field of "array" or "object" (the dkjson convention).
+static auto lua_table_json_hint(lua_State *L, const int abs_index) -> TableHint {
+    if (!lua_getmetatable(L, abs_index)) {
+        return TableHint::None;
+    }
+
+    const int mt_index = lua_gettop(L);
+    TableHint hint{TableHint::None};
+
+    lua_getfield(L, LUA_REGISTRYINDEX, LUABLAZE_TABLE_HINTS_KEY);
+    if (lua_istable(L, -1)) {
+        lua_pushvalue(L, mt_index);
+        lua_rawget(L, -2);
+        hint = table_hint_from_value(L, -1);
+        lua_pop(L, 1);
+    }
+    lua_pop(L, 1);
+
+    if (hint == TableHint::None) {
+        lua_pushliteral(L, "__jsontype");
+        lua_rawget(L, mt_index);
+        hint = table_hint_from_value(L, -1);
+        lua_pop(L, 1);
+    }
+
+    lua_pop(L, 1); // metatable
+    return hint;
+}
+
+// Convert a value the schema never observes into a cheap placeholder of the
+// same JSON type: tables become an empty array or object, strings become
+// empty. Other scalars are cheap and convert as usual, so unsupported types
+// still raise. Tables are not traversed, so they are not checked for cycles or
+// unsupported contents.
+static bool lua_value_to_placeholder(lua_State *L, const int abs_index, const int type,
+                                     const std::size_t max_recursion_depth, const std::size_t depth,
+                                     sourcemeta::core::JSON &out, std::string &error) {
+    if (type == LUA_TSTRING) {
+        out = sourcemeta::core::JSON{""};
+        return true;
+    }
+
+    if (type != LUA_TTABLE) {
+        return lua_scalar_to_json(L, abs_index, type, max_recursion_depth, depth, out, error);
+    }
+
+    TableHint hint = lua_table_json_hint(L, abs_index);
+    if (hint == TableHint::None && lua_rawlen(L, abs_index) > 0) {
+        hint = TableHint::Array;
+    }
+    if (hint == TableHint::None) {
+        lua_pushnil(L);
+        if (lua_next(L, abs_index) != 0) {
+            hint = lua_type(L, -2) == LUA_TNUMBER ? TableHint::Array : TableHint::Object;
+            lua_pop(L, 2);
+        }
+    }
+
+    out = hint == TableHint::Array ? sourcemeta::core::JSON{sourcemeta::core::JSON::Array{}}
+                                   : sourcemeta::core::JSON{sourcemeta::core::JSON::Object{}};
+    return true;
+}
+
+static bool lua_table_to_json_abs(lua_State *L, const int abs_index, ConversionScratch &scratch,
+                                  const std::size_t max_array_length, const std::size_t max_recursion_depth,
+                                  std::size_t depth, sourcemeta::core::JSON &out, std::string &error) {
+    // Read before any recursion overwrites it
+    const Projection *projection = scratch.projection;
+
+    // Check recursion depth to prevent stack overflow (0 = unlimited)
+    if (max_recursion_depth > 0 && depth > max_recursion_depth) {
+        error = "Maximum recursion depth exceeded (depth=" + std::to_string(depth) + ")";
+        return false;
+    }
+
+    // Ensure we have enough Lua stack space for table iteration/conversion.
+    // Deeply nested tables can otherwise trigger undefined behavior.
+    if (!lua_checkstack(L, 8)) {
+        error = "Cannot grow Lua stack (stack overflow risk)";
+        return false;
+    }
+
+    const void *ptr = lua_topointer(L, abs_index);
+    if (ptr != nullptr && !scratch.enter(ptr)) {
+        error = "Cycle detected in Lua table";
+        return false;
+    }
+
+    const auto release = [&]() {
+        if (ptr != nullptr) {
+            scratch.leave();
+        }
+        return false;
+    };
+    const auto fail = [&](std::string message) {
+        error = std::move(message);
+        return release();
+    };
+
+    // Classify the table. Explicit markers win; otherwise a non-empty border
+    // (`lua_rawlen`) means `t[1]` exists, which rules out an object, and for
+    // everything else the first key seen by `lua_next` decides. Empty tables
+    // without a marker are treated as objects.
+    const TableHint marker = lua_table_json_hint(L, abs_index);
+    TableHint hint         = marker;
+    if (hint == TableHint::None && lua_rawlen(L, abs_index) > 0) {
+        hint = TableHint::Array;
+    }
+
+    sourcemeta::core::JSON result{nullptr};
+    bool initialized{false};
+    if (hint == TableHint::Array) {
+        result      = sourcemeta::core::JSON{sourcemeta::core::JSON::Array{}};
+        initialized = true;
+    } else if (hint == TableHint::Object) {
+        result      = sourcemeta::core::JSON{sourcemeta::core::JSON::Object{}};
+        initialized = true;
+    }
+
+    // Single pass over the table: every entry is converted as soon as it is
+    // visited. Array part entries arrive in index order and are appended;
+    // entries stored in the hash part may arrive out of order, so holes are
+    // padded with JSON null and filled in place once their entry shows up.
+    std::size_t array_size{0};
+    lua_pushnil(L);
+    while (lua_next(L, abs_index) != 0) {
+        const int key_type = lua_type(L, -2);
+
+        if (!initialized) {
+            if (key_type == LUA_TNUMBER) {
+                hint   = TableHint::Array;
+                result = sourcemeta::core::JSON{sourcemeta::core::JSON::Array{}};
+            } else {
+                hint   = TableHint::Object;
+                result = sourcemeta::core::JSON{sourcemeta::core::JSON::Object{}};
+            }
+            initialized = true;
+        }
+
+        const int value_index = lua_gettop(L);
+        const int value_type  = lua_type(L, value_index);
+
+        if (hint == TableHint::Array) {
+            lua_Integer ki{0};
+            bool valid_index{false};
+            if (key_type == LUA_TNUMBER) {
+                const lua_Number k = lua_tonumber(L, -2);
+                ki                 = lua_tointeger(L, -2);
+                valid_index        = static_cast<lua_Number>(ki) == k && ki > 0;
+            }
+            if (!valid_index) {
+                std::string message;
+                if (marker == TableHint::Array) {
+                    message = std::string{"Array table keys must be positive integers (found "} +
+                              lua_typename(L, key_type) + ")";
+                } else if (key_type == LUA_TSTRING) {
+                    // Mixed tables were historically classified as objects, so
+                    // report them the same way.
+                    message = "Object table keys must be strings (found both number and string keys)";
+                } else {
+                    message = std::string{"Object table keys must be strings (found "} + lua_typename(L, key_type) +
+                              ")";
+                }
+                lua_pop(L, 2);
+                return fail(std::move(message));
+            }
+
+            const auto index = static_cast<std::size_t>(ki);
+            // Check for potential integer overflow before growing the array
+            if (index == SIZE_MAX) {
+                lua_pop(L, 2);
+                return fail("Array index too large (integer overflow risk)");
+            }
+            if (max_array_length > 0 && index > max_array_length) {
+                lua_pop(L, 2);
+                return fail("Array length exceeds max_array_length");
+            }
+
+            sourcemeta::core::JSON element{nullptr};
+            scratch.projection = nullptr;
+            const bool converted =
+                value_type == LUA_TTABLE
+                    ? lua_table_to_json_abs(L, value_index, scratch, max_array_length, max_recursion_depth, depth + 1,
+                                            element, error)
+                    : lua_scalar_to_json(L, value_index, value_type, max_recursion_depth, depth + 1, element, error);
+            if (!converted) {
+                lua_pop(L, 2);
+                return release();
+            }
+
+            if (index > array_size) {
+                while (array_size + 1 < index) {
+                    result.push_back(sourcemeta::core::JSON{nullptr});
+                    array_size++;
+                }
+                result.push_back(std::move(element));
+                array_size++;
+            } else {
+                result.at(index - 1) = std::move(element);
+            }
+
+            lua_pop(L, 1);
+            continue;
+        }
+
+        if (key_type != LUA_TSTRING) {
+            lua_pop(L, 2);
+            return fail(std::string{"Object table keys must be strings (found "} + lua_typename(L, key_type) + ")");
+        }
+
+        std::size_t key_len{0};
+        const char *key_str = lua_tolstring(L, -2, &key_len);
+        const auto *child   = projection == nullptr ? nullptr : projection->child(std::string_view{key_str, key_len});
+
+        sourcemeta::core::JSON value{nullptr};
+        bool converted{false};
+        if (child != nullptr && child->kind == Projection::Kind::Any) {
+            converted = lua_value_to_placeholder(L, value_index, value_type, max_recursion_depth, depth + 1, value,
+                                                 error);
+        } else {
+            scratch.projection = child;
+            converted =
+                value_type == LUA_TTABLE
+                    ? lua_table_to_json_abs(L, value_index, scratch, max_array_length, max_recursion_depth, depth + 1,
+                                            value, error)
+                    : lua_scalar_to_json(L, value_index, value_type, max_recursion_depth, depth + 1, value, error);
+        }
+        if (!converted) {
+            lua_pop(L, 2);
+            return release();
+        }
+        // Build the key straight from the Lua string's bytes and move it in.
+        // String keys of a Lua table are unique, so the property can be
+        // appended without looking it up first: `assign` would compare its
+        // hash against every property already inserted.
+        result.assign_assume_new(sourcemeta::core::JSON::String{key_str, key_len}, std::move(value));
+        lua_pop(L, 1);
+    }
+
+    release();
+
+    if (!initialized) {
+        // Empty table without a marker: treat as object by default.
+        result = sourcemeta::core::JSON{sourcemeta::core::JSON::Object{}};
+    }
+
+    out = std::move(result);
+    return true;
+}
+
+static bool lua_value_to_json(lua_State *L, int index, ConversionScratch &scratch,
+                              const std::size_t max_array_length, const std::size_t max_recursion_depth,
+                              std::size_t depth, sourcemeta::core::JSON &out, std::string &error) {
+    const int abs_index = lua_absindex(L, index);
+    return lua_value_to_json_abs(L, abs_index, scratch, max_array_length, max_recursion_depth, depth, out, error);
+}
+
+static bool lua_value_to_json_abs(lua_State *L, const int abs_index, ConversionScratch &scratch,
+                                  const std::size_t max_array_length, const std::size_t max_recursion_depth,
+                                  std::size_t depth, sourcemeta::core::JSON &out, std::string &error) {
+    const int t = lua_type(L, abs_index);
+    if (t == LUA_TTABLE) {
+        return lua_table_to_json_abs(L, abs_index, scratch, max_array_length, max_recursion_depth, depth, out, error);
+    }
+
+    return lua_scalar_to_json(L, abs_index, t, max_recursion_depth, depth, out, error);
+}
+
+static bool lua_scalar_to_json(lua_State *L, const int abs_index, const int t, const std::size_t max_recursion_depth,
+                               const std::size_t depth, sourcemeta::core::JSON &out, std::string &error) {
+    // Check recursion depth to prevent stack overflow (0 = unlimited)
+    if (max_recursion_depth > 0 && depth > max_recursion_depth) {
+        error = "Maximum recursion depth exceeded (depth=" + std::to_string(depth) + ")";
+        return false;
+    }
+
+    switch (t) {
+        case LUA_TNIL:
+            out = sourcemeta::core::JSON{nullptr};
+            return true;
+        case LUA_TBOOLEAN:
+            out = sourcemeta::core::JSON{static_cast<bool>(lua_toboolean(L, abs_index))};
+            return true;
+        case LUA_TNUMBER: {
+            if (lua_isinteger(L, abs_index)) {
+                out = sourcemeta::core::JSON{static_cast<std::int64_t>(lua_tointeger(L, abs_index))};
+                return true;
+            }
+            const double number = static_cast<double>(lua_tonumber(L, abs_index));
+            if (!std::isfinite(number)) {
+                error = "Non-finite numbers (NaN/Inf) are not valid JSON numbers";
+                return false;
+            }
+            out = sourcemeta::core::JSON{number};
+            return true;
+        }
+        case LUA_TSTRING: {
+            std::size_t len{0};
+            const char *str = lua_tolstring(L, abs_index, &len);
+            out             = sourcemeta::core::JSON{sourcemeta::core::JSON::String{str, len}};
+            return true;
+        }
+        default: {
+            std::ostringstream oss;
+            oss << "Unsupported Lua type for JSON conversion: " << lua_typename(L, t);
+            if (t == LUA_TUSERDATA || t == LUA_TLIGHTUSERDATA) {
+                oss << " (userdata cannot be converted to JSON)";
+            } else if (t == LUA_TFUNCTION) {
+                oss << " (functions cannot be converted to JSON)";
+            } else if (t == LUA_TTHREAD) {
+                oss << " (threads cannot be converted to JSON)";
+            }
+            error = oss.str();
+            return false;
+        }
+    }
+}
+
+/**
+ * @brief Read-only `std::streambuf` over caller-owned memory.
+ *
+ * Lets `sourcemeta::core::parse_json` read straight out of a Lua string (or
+ * any other buffer that outlives the parse) instead of a `std::string` copy.
+ */
+class MemoryStreamBuffer : public std::streambuf {
+public:
+    MemoryStreamBuffer(const char *data, const std::size_t size) {
+        // The get area is never written through
+        auto *begin = const_cast<char *>(data);
+        this->setg(begin, begin, begin + size);
+    }
+};
+
+/**
+ * @brief Limits enforced on JSON instance text before it is parsed.
+ *
+ * Every limit is 0 for unlimited.
+ *
+ * @var max_depth Maximum nesting depth of arrays and objects
+ * @var max_input_bytes Maximum size of the whole document
+ * @var max_json_array_length Maximum number of array elements
+ * @var max_string_length Maximum string (and property name) length, in bytes with each escape sequence counted once
+ * @var max_object_properties Maximum number of object properties
+ */
+struct ParseLimits {
+    std::size_t max_depth{0};
+    std::size_t max_input_bytes{0};
+    std::size_t max_json_array_length{0};
+    std::size_t max_string_length{0};
+    std::size_t max_object_properties{0};
+
+    auto operator==(const ParseLimits &other) const -> bool = default;
+};
+
+// The parse limits configured on a `CompiledSchema` or `SchemaOptions`
+template <typename Source> static auto parse_limits_of(const Source &source) -> ParseLimits {
+    return {source.max_depth, source.max_input_bytes, source.max_json_array_length, source.max_string_length,
+            source.max_object_properties};
+}
+
+/**
+ * @brief Reject JSON documents that exceed any of `limits`.
+ *
+ * A single byte scan tracks the depth of `[`/`{` outside of string literals,
+ * the length of every string literal and, when a size limit is set, counts
+ * the commas of every open container, so the limits are enforced before the
+ * parser allocates anything and without a per-value parse callback. The scan
+ * stops at the first violation. Malformed input is left to the parser.
+ *
+ * Counting needs one entry per open container. With `max_depth = 0`,
+ * documents nested deeper than 4096 levels are rejected while a size limit
+ * is set, so the scan's memory stays bounded.
+ *
+ * @throws std::runtime_error if the document exceeds a limit
+ */
+static auto check_json_limits(const std::string_view input, const ParseLimits &limits) -> void {
+    if (limits.max_input_bytes > 0 && input.size() > limits.max_input_bytes) {
+        throw std::runtime_error("JSON input exceeds max_input_bytes");
+    }
+    if (limits.max_depth == 0 && limits.max_json_array_length == 0 && limits.max_string_length == 0 &&
+        limits.max_object_properties == 0) {
+        return;
+    }
+
+    constexpr auto unlimited    = std::numeric_limits<std::size_t>::max();
+    const auto max_depth        = limits.max_depth > 0 ? limits.max_depth : unlimited;
+    const auto max_string       = limits.max_string_length > 0 ? limits.max_string_length : unlimited;
+    const bool count_elements   = limits.max_json_array_length > 0 || limits.max_object_properties > 0;
+    const auto max_array_length = limits.max_json_array_length > 0 ? limits.max_json_array_length : unlimited;
+    const auto max_properties   = limits.max_object_properties > 0 ? limits.max_object_properties : unlimited;
+
+    // Elements so far (assuming the container is not empty, so commas + 1) and
+    // limit of every open container, innermost last. Without `max_depth` the
+    // stack is capped at `max_counted_depth` so it cannot grow with the input.
+    struct OpenContainer {
+        std::size_t elements;
+        std::size_t limit;
+        bool array;
+    };
+    std::vector<OpenContainer> open;
+    constexpr std::size_t max_counted_depth = 4096;
+
+    std::size_t depth{0};
+    const char *cursor    = input.data();
+    const char *const end = cursor + input.size();
+    while (cursor < end) {
+        const char c = *cursor++;
+        switch (c) {
+            case '"': {
+                // Skip the string literal, honoring escapes
+                std::size_t length{0};
+                while (cursor < end) {
+                    const char s = *cursor++;
+                    if (s == '\\' && cursor < end) {
+                        cursor += (*cursor == 'u' && end - cursor > 4) ? 5 : 1;
+                    } else if (s == '"') {
+                        break;
+                    }
+                    if (++length > max_string) {
+                        throw std::runtime_error("JSON string length exceeds max_string_length");
+                    }
+                }
+                break;
+            }
+            case '[':
+            case '{':
+                depth++;
+                if (depth > max_depth) {
+                    throw std::runtime_error("JSON maximum nesting depth exceeded");
+                }
+                if (count_elements) {
+                    if (limits.max_depth == 0 && open.size() == max_counted_depth) {
+                        throw std::runtime_error("JSON nesting too deep to enforce max_json_array_length and "
+                                                 "max_object_properties without max_depth");
+                    }
+                    open.push_back({1, c == '[' ? max_array_length : max_properties, c == '['});
+                }
+                break;
+            case ']':
+            case '}':
+                if (depth > 0) {
+                    depth--;
+                    if (count_elements) {
+                        open.pop_back();
+                    }
+                }
+                break;
+            case ',':
+                if (count_elements && !open.empty() && ++open.back().elements > open.back().limit) {
+                    throw std::runtime_error(open.back().array ? "JSON array length exceeds max_json_array_length"
+                                                               : "JSON object exceeds max_object_properties");
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// Parse a JSON document directly from `input`'s memory, enforcing `limits`
+// up front. `input` must outlive the call.
+static auto parse_json_with_limits(const std::string_view input, const ParseLimits &limits) -> sourcemeta::core::JSON {
+    check_json_limits(input, limits);
+
+    MemoryStreamBuffer buffer{input.data(), input.size()};
+    std::istream stream{&buffer};
+    return sourcemeta::core::parse_json(stream);
+}
+
+// Parse a JSON document (schemas and artifacts) enforcing `max_depth` only
+static auto parse_json_with_depth_limit(const std::string_view input, const std::size_t max_depth)
+    -> sourcemeta::core::JSON {
+    return parse_json_with_limits(input, ParseLimits{max_depth});
+}
+
+/**
+ * @brief Read-only view of a whole file.
+ *
+ * On POSIX systems the file is memory-mapped, so parsing reads straight from
+ * the page cache without copying the file into the Lua or C++ heap. Other
+ * platforms fall back to reading the file into an owned buffer.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const std::string &path) {
+#if !defined(_WIN32)
+        const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open file '" + path + "': " + std::strerror(errno));
+        }
+
+        struct stat info {};
+        if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+            close(fd);
+            throw std::runtime_error("Cannot read file '" + path + "': not a regular file");
+        }
+
+        this->length = static_cast<std::size_t>(info.st_size);
+        if (this->length > 0) {
+            void *address = mmap(nullptr, this->length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address == MAP_FAILED) {
+                const int mmap_errno = errno;
+                close(fd);
+                throw std::runtime_error("Cannot map file '" + path + "': " + std::strerror(mmap_errno));
+            }
+            (void)madvise(address, this->length, MADV_SEQUENTIAL);
+            this->address = static_cast<const char *>(address);
+        }
+        close(fd);
+#else
+        std::ifstream stream{path, std::ios::binary};
+        if (!stream) {
+            throw std::runtime_error("Cannot open file '" + path + "'");
+        }
+        this->contents.assign(std::istreambuf_iterator<char>{stream}, std::istreambuf_iterator<char>{});
+        this->address = this->contents.data();
+        this->length  = this->contents.size();
+#endif
+    }
+
+    MappedFile(const MappedFile &)            = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile() {
+#if !defined(_WIN32)
+        if (this->address != nullptr) {
+            munmap(const_cast<char *>(this->address), this->length);
+        }
+#endif
+    }
+
+    auto view() const -> std::string_view {
+        return {this->address == nullptr ? "" : this->address, this->length};
+    }
+
+private:
+    const char *address{nullptr};
+    std::size_t length{0};
+#if defined(_WIN32)
+    std::string contents;
+#endif
+};
+
+// Convert the Lua value at `index` into a JSON instance, applying the
+// schema's conversion limits and reusing its scratch state.
+static bool convert_lua_instance(lua_State *L, CompiledSchema *compiled, const int index,
+                                 sourcemeta::core::JSON &out, std::string &error) {
+    compiled->scratch.reset();
+    const auto *projection = compiled->projection.get();
+    if (projection != nullptr && projection->kind == Projection::Kind::Any) {
+        return lua_value_to_placeholder(L, lua_absindex(L, index), lua_type(L, index), compiled->max_recursion_depth,
+                                        0, out, error);
+    }
+    compiled->scratch.projection = projection;
+    return lua_value_to_json(L, index, compiled->scratch, compiled->max_array_length, compiled->max_recursion_depth, 0,
+                             out, error);
+}
+
+/**
+ * @brief An immutable, already converted instance.
+ *
+ * Created by `luablaze.parse()` and `luablaze.from_table()`. Every validate
+ * method of `CompiledSchema` and `SchemaSet` accepts it in place of a table
+ * or JSON string, so one document validated against several schemas is
+ * parsed or converted only once.
+ *
+ * @var value The instance, shared with background validations still using it
+ * @var max_recursion_depth Maximum recursion depth when converting back to Lua
+ */
+struct Instance {
+    std::shared_ptr<const sourcemeta::core::JSON> value;
+    std::size_t max_recursion_depth;
+};
+
+struct InstanceUserdata {
+    Instance *ptr;
+};
+
+// The `Instance` userdata at `index`, or null if the value there is not one.
+static auto test_instance_object(lua_State *L, const int index) -> Instance * {
+    auto *ud = static_cast<InstanceUserdata *>(luaL_testudata(L, index, LUABLAZE_INSTANCE_MT));
+    return ud != nullptr ? ud->ptr : nullptr;
+}
+
+// The instance held by the `Instance` userdata at `index`, or null if the
+// value there is not an `Instance`.
+static auto test_instance(lua_State *L, const int index) -> const sourcemeta::core::JSON * {
+    const auto *instance = test_instance_object(L, index);
+    return instance != nullptr ? instance->value.get() : nullptr;
+}
+
+// Validate and extract an `Instance*` from a Lua userdata at `index`.
+// Raises a Lua error if the type does not match.
+static auto check_instance(lua_State *L, const int index) -> Instance * {
+    auto *ud = static_cast<InstanceUserdata *>(luaL_checkudata(L, index, LUABLAZE_INSTANCE_MT));
+    luaL_argcheck(L, ud != nullptr && ud->ptr != nullptr, index, "Instance expected");
+    return ud->ptr;
+}
+
+// Lua GC metamethod: destroy the object stored inside the userdata.
+static int instance_gc(lua_State *L) {
+    auto *ud = static_cast<InstanceUserdata *>(luaL_testudata(L, 1, LUABLAZE_INSTANCE_MT));
+    if (ud != nullptr && ud->ptr != nullptr) {
+        delete ud->ptr;
+        ud->ptr = nullptr;
+    }
+    return 0;
+}
+
+// Push a new `Instance` userdata holding `value`.
+static void push_instance(lua_State *L, sourcemeta::core::JSON &&value, const std::size_t max_recursion_depth) {
+    auto *ud = static_cast<InstanceUserdata *>(lua_newuserdata(L, sizeof(InstanceUserdata)));
+    ud->ptr  = nullptr;
+    luaL_getmetatable(L, LUABLAZE_INSTANCE_MT);
+    lua_setmetatable(L, -2);
+    ud->ptr = new Instance{std::make_shared<const sourcemeta::core::JSON>(std::move(value)), max_recursion_depth};
+}
+
+// Read the conversion limits accepted by `luablaze.parse` and
+// `luablaze.from_table` from the optional options table at `index`.
+static void check_instance_options(lua_State *L, const int index, SchemaOptions &options) {
+    if (lua_isnoneornil(L, index)) {
+        return;
+    }
+    if (lua_type(L, index) != LUA_TTABLE) {
+        throw std::runtime_error("options_table must be a table");
+    }
+    const int abs_index = lua_absindex(L, index);
+    std::string error;
+    if (!validate_options_table_keys(L, abs_index, error) ||
+        !parse_size_option(L, abs_index, "max_array_length", options.max_array_length, error) ||
+        !parse_size_option(L, abs_index, "max_depth", options.max_depth, error) ||
+        !parse_size_option(L, abs_index, "max_input_bytes", options.max_input_bytes, error) ||
+        !parse_size_option(L, abs_index, "max_json_array_length", options.max_json_array_length, error) ||
+        !parse_size_option(L, abs_index, "max_string_length", options.max_string_length, error) ||
+        !parse_size_option(L, abs_index, "max_object_properties", options.max_object_properties, error) ||
+        !parse_size_option(L, abs_index, "max_recursion_depth", options.max_recursion_depth, error)) {
+        throw std::runtime_error(error);
+    }
+}
+
+/**
+ * @brief Parse a JSON string into a reusable instance.
+ *
+ * Implements `luablaze.parse(instance_json_string[, options]) -> Instance`
+ *
+ * Options: `max_depth` (default: 128, 0 = unlimited), the parse limits
+ * `max_input_bytes`, `max_json_array_length`, `max_string_length` and
+ * `max_object_properties` (as for `luablaze.new`) and `max_recursion_depth`
+ * (used by `Instance:to_table()`).
+ *
+ * @param L Lua state (expects a JSON string at index 1, optional options table at index 2)
+ * @return 1 (Instance userdata on stack)
+ * @throws Lua error on parse failure
+ */
+static int luablaze_parse(lua_State *L) {
+    std::size_t instance_len{0};
+    const char *instance_str = luaL_checklstring(L, 1, &instance_len);
+
+    try {
+        SchemaOptions options;
+        check_instance_options(L, 2, options);
+        push_instance(L, parse_json_with_limits(std::string_view{instance_str, instance_len}, parse_limits_of(options)),
+                      options.max_recursion_depth);
+        return 1;
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Convert a Lua table into a reusable instance.
+ *
+ * Implements `luablaze.from_table(instance_table[, options]) -> Instance`
+ *
+ * The table is converted in full, as by a schema created without
+ * `project`, so the instance suits every schema. Options:
+ * `max_array_length` (default: 100000) and `max_recursion_depth` (default: 100).
+ *
+ * @param L Lua state (expects a table at index 1, optional options table at index 2)
+ * @return 1 (Instance userdata on stack)
+ * @throws Lua error on conversion failure
+ */
+static int luablaze_from_table(lua_State *L) {
+    luaL_checktype(L, 1, LUA_TTABLE);
+
+    try {
+        SchemaOptions options;
+        check_instance_options(L, 2, options);
+        ConversionScratch scratch;
+        sourcemeta::core::JSON value{nullptr};
+        std::string error;
+        if (!lua_value_to_json(L, 1, scratch, options.max_array_length, options.max_recursion_depth, 0, value,
+                               error)) {
+            throw std::runtime_error(error);
+        }
+        push_instance(L, std::move(value), options.max_recursion_depth);
+        return 1;
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Serialize an instance.
+ *
+ * Implements `Instance:to_json() -> string`
+ *
+ * @param L Lua state (expects an Instance at index 1)
+ * @return 1 (JSON string on stack)
+ */
+static int instance_to_json(lua_State *L) {
+    auto *instance = check_instance(L, 1);
+
+    try {
+        std::ostringstream stream;
+        sourcemeta::core::stringify(*instance->value, stream);
+        const auto output = stream.str();
+        lua_pushlstring(L, output.data(), output.size());
+        return 1;
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Convert an instance back to plain Lua values.
+ *
+ * Implements `Instance:to_table() -> value`
+ *
+ * @param L Lua state (expects an Instance at index 1)
+ * @return 1 (value on stack)
+ */
+static int instance_to_table(lua_State *L) {
+    auto *instance = check_instance(L, 1);
+
+    std::string error;
+    if (!json_to_lua_value(L, *instance->value, instance->max_recursion_depth, 0, error)) {
+        return luaL_error(L, "%s", error.c_str());
+    }
+    return 1;
+}
+
+// Validate and extract a `CompiledSchema*` from a Lua userdata at `index`.
+// Raises a Lua error if the type does not match.
+static auto check_compiled_schema(lua_State *L, const int index) -> CompiledSchema * {
+    auto *ud = static_cast<CompiledSchemaUserdata *>(luaL_checkudata(L, index, LUABLAZE_COMPILEDSCHEMA_MT));
+    luaL_argcheck(L, ud != nullptr && ud->ptr != nullptr, index, "CompiledSchema expected");
+    return ud->ptr;
+}
+
+// Raise unless the template of `compiled` still has its keyword locations,
+// which `method` reports. Compact templates only answer plain validation.
+static auto check_not_compact(lua_State *L, const CompiledSchema *compiled, const char *method) -> void {
+    if (compiled->compact) {
+        luaL_error(L, "CompiledSchema:%s() is not available on schemas compiled with compact = true", method);
+    }
+}
+
+// Lua GC metamethod: destroy the object stored inside the userdata.
+static int compiled_schema_gc(lua_State *L) {
+    auto *ud = static_cast<CompiledSchemaUserdata *>(luaL_testudata(L, 1, LUABLAZE_COMPILEDSCHEMA_MT));
+    if (ud != nullptr && ud->ptr != nullptr) {
+        delete ud->ptr;
+        ud->ptr = nullptr;
+    }
+    return 0;
+}
+
+/**
+ * @brief Return information about the compiled schema configuration.
+ *
+ * Implements `CompiledSchema:info() -> table`
+ *
+ * Returns a table containing:
+ * - mode: "Fast" or "Exhaustive"
+ * - dialect: The dialect used or "auto" if auto-detected
+ * - max_array_length: Maximum array length for Lua table conversion
+ * - max_depth: Maximum JSON nesting depth
+ * - max_input_bytes: Maximum JSON instance size
+ * - max_json_array_length: Maximum JSON array length
+ * - max_string_length: Maximum JSON string length
+ * - max_object_properties: Maximum JSON object property count
+ * - max_recursion_depth: Maximum recursion depth for conversion
+ * - cached: Whether the template is shared through the template cache
+ * - compact: Whether the template was compiled with `compact = true`
+ * - incremental: Whether the schema was split for `TrackedDocument:validate()` (see `incremental = true`)
+ * - instruction_count: Number of instructions in the template
+ * - approx_bytes: Approximate heap footprint of the template (lower bound)
+ * - luablaze_version: Version of luablaze
+ * - blaze_version: Version of the Blaze library
+ *
+ * @param L Lua state
+ * @return 1 (info table on stack)
+ */
+static int compiled_schema_info(lua_State *L) {
+    auto *compiled = check_compiled_schema(L, 1);
+
+    // Ensure we have enough stack space (16 key-value pairs + table)
+    if (!lua_checkstack(L, 33)) {
+        return luaL_error(L, "Cannot grow Lua stack for info table");
+    }
+
+    lua_createtable(L, 0, 16);
+
+    lua_pushstring(L, compiled->mode_name);
+    lua_setfield(L, -2, "mode");
+
+    lua_pushstring(L, compiled->dialect_name.c_str());
+    lua_setfield(L, -2, "dialect");
+
+    lua_pushinteger(L, static_cast<lua_Integer>(compiled->max_array_length));
+    lua_setfield(L, -2, "max_array_length");
+
+    lua_pushinteger(L, static_cast<lua_Integer>(compiled->max_depth));
+    lua_setfield(L, -2, "max_depth");
+
+    lua_pushinteger(L, static_cast<lua_Integer>(compiled->max_input_bytes));
+    lua_setfield(L, -2, "max_input_bytes");
+
+    lua_pushinteger(L, static_cast<lua_Integer>(compiled->max_json_array_length));
+    lua_setfield(L, -2, "max_json_array_length");
+
+    lua_pushinteger(L, static_cast<lua_Integer>(compiled->max_string_length));
+    lua_setfield(L, -2, "max_string_length");
+
+    lua_pushinteger(L, static_cast<lua_Integer>(compiled->max_object_properties));
+    lua_setfield(L, -2, "max_object_properties");
+
+    lua_pushinteger(L, static_cast<lua_Integer>(compiled->max_recursion_depth));
+    lua_setfield(L, -2, "max_recursion_depth");
+
+    lua_pushboolean(L, compiled->cached ? 1 : 0);
+    lua_setfield(L, -2, "cached");
+
+    lua_pushboolean(L, compiled->compact ? 1 : 0);
+    lua_setfield(L, -2, "compact");
+
+    lua_pushboolean(L, compiled->decomposition != nullptr ? 1 : 0);
+    lua_setfield(L, -2, "incremental");
+
+    lua_pushinteger(L, static_cast<lua_Integer>(compiled->instruction_count));
+    lua_setfield(L, -2, "instruction_count");
+
+    lua_pushinteger(L, static_cast<lua_Integer>(compiled->approx_bytes));
+    lua_setfield(L, -2, "approx_bytes");
+
+    lua_pushstring(L, LUABLAZE_VERSION);
+    lua_setfield(L, -2, "luablaze_version");
+
+    lua_pushstring(L, BLAZE_VERSION);
+    lua_setfield(L, -2, "blaze_version");
+
+    return 1;
+}
+
+/**
+ * @brief Return the runtime statistics collected for this schema.
+ *
+ * Implements `CompiledSchema:stats() -> table | nil`
+ *
+ * Returns nil unless the schema was created with `{ stats = true }`. The
+ * table contains:
+ * - validations: Instances validated
+ * - invalid: Instances that did not match the schema
+ * - errors: Instances that failed to convert or parse
+ * - conversion_seconds, parse_seconds, evaluation_seconds, report_seconds:
+ *   Time spent per stage
+ * - latency_seconds: Total latency of all validated instances
+ * - latency: Cumulative histogram, an array of `{ le = seconds, count = n }`
+ *   ending with `le = math.huge`, ready for a Prometheus histogram
+ *
+ * `validate_json_parallel` and `validate_json_async` run outside the owning
+ * thread and are not counted.
+ *
+ * @param L Lua state
+ * @return 1 (stats table or nil on stack)
+ */
+static int compiled_schema_stats(lua_State *L) {
+    const auto *compiled = check_compiled_schema(L, 1);
+    const auto *stats    = compiled->stats.get();
+    if (stats == nullptr) {
+        lua_pushnil(L);
+        return 1;
+    }
+
+    if (!lua_checkstack(L, 6)) {
+        return luaL_error(L, "Cannot grow Lua stack for stats table");
+    }
+
+    const auto seconds = [](const std::uint64_t nanoseconds) {
+        return static_cast<lua_Number>(nanoseconds) / 1e9;
+    };
+
+    lua_createtable(L, 0, 9);
+
+    lua_pushinteger(L, static_cast<lua_Integer>(stats->validations));
+    lua_setfield(L, -2, "validations");
+
+    lua_pushinteger(L, static_cast<lua_Integer>(stats->invalid));
+    lua_setfield(L, -2, "invalid");
+
+    lua_pushinteger(L, static_cast<lua_Integer>(stats->errors));
+    lua_setfield(L, -2, "errors");
+
+    lua_pushnumber(L, seconds(stats->conversion_ns));
+    lua_setfield(L, -2, "conversion_seconds");
+
+    lua_pushnumber(L, seconds(stats->parse_ns));
+    lua_setfield(L, -2, "parse_seconds");
+
+    lua_pushnumber(L, seconds(stats->evaluation_ns));
+    lua_setfield(L, -2, "evaluation_seconds");
+
+    lua_pushnumber(L, seconds(stats->report_ns));
+    lua_setfield(L, -2, "report_seconds");
+
+    lua_pushnumber(L, seconds(stats->latency_ns));
+    lua_setfield(L, -2, "latency_seconds");
+
+    lua_createtable(L, static_cast<int>(SchemaStats::LATENCY_BUCKETS), 0);
+    std::uint64_t cumulative{0};
+    for (std::size_t i = 0; i < SchemaStats::LATENCY_BUCKETS; i++) {
+        cumulative += stats->latency[i];
+        lua_createtable(L, 0, 2);
+        lua_pushnumber(L, i < SchemaStats::LATENCY_BOUNDS_NS.size() ? seconds(SchemaStats::LATENCY_BOUNDS_NS[i])
+                                                                    : static_cast<lua_Number>(HUGE_VAL));
+        lua_setfield(L, -2, "le");
+        lua_pushinteger(L, static_cast<lua_Integer>(cumulative));
+        lua_setfield(L, -2, "count");
+        lua_rawseti(L, -2, static_cast<lua_Integer>(i + 1));
+    }
+    lua_setfield(L, -2, "latency");
+
+    return 1;
+}
+
+/**
+ * @brief Reset the runtime statistics of this schema to zero.
+ *
+ * Implements `CompiledSchema:reset_stats()`
+ *
+ * Does nothing unless the schema was created with `{ stats = true }`.
+ *
+ * @param L Lua state
+ * @return 0
+ */
+static int compiled_schema_reset_stats(lua_State *L) {
+    auto *compiled = check_compiled_schema(L, 1);
+    if (compiled->stats != nullptr) {
+        *compiled->stats = SchemaStats{};
+    }
+    return 0;
+}
+
+/**
+ * @brief Serialize the compiled template to a JSON artifact.
+ *
+ * Implements `CompiledSchema:dump() -> string`
+ *
+ * The artifact records the luablaze and Blaze versions, the mode and the
+ * dialect next to the template, and can be turned back into a
+ * `CompiledSchema` with `luablaze.load` by the same luablaze/Blaze build.
+ *
+ * @param L Lua state
+ * @return 1 (artifact JSON string on stack)
+ * @throws Lua error if serialization fails
+ */
+static int compiled_schema_dump(lua_State *L) {
+    auto *compiled = check_compiled_schema(L, 1);
+
+    try {
+        auto artifact = sourcemeta::core::JSON::make_object();
+        artifact.assign("format", sourcemeta::core::JSON{LUABLAZE_TEMPLATE_FORMAT});
+        artifact.assign("luablaze_version", sourcemeta::core::JSON{LUABLAZE_VERSION});
+        artifact.assign("blaze_version", sourcemeta::core::JSON{BLAZE_VERSION});
+        artifact.assign("mode", sourcemeta::core::JSON{compiled->mode_name});
+        artifact.assign("dialect", sourcemeta::core::JSON{compiled->dialect_name});
+        artifact.assign("compact", sourcemeta::core::JSON{compiled->compact});
+        artifact.assign("template", sourcemeta::blaze::to_json(*compiled->schema_template));
+
+        std::ostringstream stream;
+        sourcemeta::core::stringify(artifact, stream);
+        const auto output = stream.str();
+        lua_pushlstring(L, output.data(), output.size());
+        return 1;
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Validate a Lua table against the compiled schema (simple boolean result).
+ *
+ * Implements `CompiledSchema:validate(instance_table) -> boolean`
+ *
+ * Converts the Lua table at stack index 2 to a JSON value, then validates it
+ * against the compiled schema template. An `Instance` is validated as is.
+ *
+ * @param L Lua state
+ * @return 1 (boolean result on stack)
+ * @throws Lua error on conversion or validation failure
+ */
+static int compiled_schema_validate(lua_State *L) {
+    auto *compiled     = check_compiled_schema(L, 1);
+    const auto *parsed = test_instance(L, 2);
+    if (parsed == nullptr) {
+        luaL_checktype(L, 2, LUA_TTABLE);
+    }
+
+    try {
+        StatsTimer timer{compiled->stats.get()};
+        sourcemeta::core::JSON instance{nullptr};
+        if (parsed == nullptr) {
+            std::string error;
+            if (!convert_lua_instance(L, compiled, 2, instance, error)) {
+                throw std::runtime_error(error);
+            }
+            timer.lap(&SchemaStats::conversion_ns);
+        }
+        const bool result =
+            compiled->evaluator.validate(*compiled->schema_template, parsed != nullptr ? *parsed : instance);
+        timer.lap(&SchemaStats::evaluation_ns);
+        timer.finish(result);
+        lua_pushboolean(L, result);
+        return 1;
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Validate a JSON string against the compiled schema (simple boolean result).
+ *
+ * Implements `CompiledSchema:validate_json(instance_json_string) -> boolean`
+ *
+ * Parses the JSON string at stack index 2, then validates it against the compiled
+ * schema template. An `Instance` is validated as is.
+ *
+ * @param L Lua state
+ * @return 1 (boolean result on stack)
+ * @throws Lua error on parse or validation failure
+ */
+static int compiled_schema_validate_json(lua_State *L) {
+    auto *compiled = check_compiled_schema(L, 1);
+    if (test_instance(L, 2) != nullptr) {
+        return compiled_schema_validate(L);
+    }
+    std::size_t instance_len{0};
+    const char *instance_str = luaL_checklstring(L, 2, &instance_len);
+
+    try {
+        StatsTimer timer{compiled->stats.get()};
+        const auto instance =
+            parse_json_with_limits(std::string_view{instance_str, instance_len}, parse_limits_of(*compiled));
+        timer.lap(&SchemaStats::parse_ns);
+        const bool result = compiled->evaluator.validate(*compiled->schema_template, instance);
+        timer.lap(&SchemaStats::evaluation_ns);
+        timer.finish(result);
+        lua_pushboolean(L, result);
+        return 1;
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Expose the compiled schema to the LuaJIT FFI entry points.
+ *
+ * Implements `CompiledSchema:ffi_handle() -> lightuserdata`
+ *
+ * The handle is the address of the underlying schema and is only valid while
+ * the `CompiledSchema` is alive, so callers must keep a reference to it (the
+ * `luablaze.ffi` module does).
+ *
+ * @param L Lua state
+ * @return 1 (light userdata on stack)
+ */
+static int compiled_schema_ffi_handle(lua_State *L) {
+    lua_pushlightuserdata(L, check_compiled_schema(L, 1));
+    return 1;
+}
+
+// Message of the last failed luablaze_ffi_validate_json call on this thread
+static thread_local std::string ffi_last_error;
+
+// FFI counterpart of `CompiledSchema:validate_json`: the instance arrives as
+// a pointer/length pair, so a LuaJIT trace calls it without leaving compiled
+// code or copying the string. Returns 1 (valid), 0 (invalid) or -1 (error,
+// see luablaze_ffi_last_error).
+LUABLAZE_EXPORT int luablaze_ffi_validate_json(void *handle, const char *data, const std::size_t length) {
+    auto *compiled = static_cast<CompiledSchema *>(handle);
+    if (compiled == nullptr || (data == nullptr && length > 0)) {
+        ffi_last_error = "Invalid arguments";
+        return -1;
+    }
+
+    try {
+        StatsTimer timer{compiled->stats.get()};
+        const auto instance = parse_json_with_limits(std::string_view{data, length}, parse_limits_of(*compiled));
+        timer.lap(&SchemaStats::parse_ns);
+        const bool result = compiled->evaluator.validate(*compiled->schema_template, instance);
+        timer.lap(&SchemaStats::evaluation_ns);
+        timer.finish(result);
+        return result ? 1 : 0;
+    } catch (const std::exception &e) {
+        ffi_last_error = e.what();
+    } catch (...) {
+        ffi_last_error = "unknown error";
+    }
+    return -1;
+}
+
+LUABLAZE_EXPORT const char *luablaze_ffi_last_error(void) {
+    return ffi_last_error.c_str();
+}
+
+// Read the `decode_json` options at `index`. The `null`, `array_mt` and
+// `object_mt` values are left on the stack and referenced from `style`.
+static bool parse_decode_options_table(lua_State *L, const int index, bool &decode_on_failure,
+                                       LuaDecodeStyle &style, std::string &error) {
+    const int abs_index = lua_absindex(L, index);
+    if (!validate_options_table_keys(L, abs_index, error) ||
+        !parse_boolean_option(L, abs_index, "decode_on_failure", decode_on_failure, error)) {
+        return false;
+    }
+
+    lua_getfield(L, abs_index, "null");
+    if (lua_isnil(L, -1)) {
+        lua_pop(L, 1);
+    } else {
+        style.null_index = lua_gettop(L);
+    }
+
+    // `true` selects the luablaze marker metatable, a table is used as is
+    const struct {
+        const char *name;
+        const char *marker;
+        int *target;
+    } metatables[] = {{"array_mt", LUABLAZE_ARRAY_MT, &style.array_mt_index},
+                      {"object_mt", LUABLAZE_OBJECT_MT, &style.object_mt_index}};
+    for (const auto &[name, marker, target] : metatables) {
+        lua_getfield(L, abs_index, name);
+        if (lua_isnil(L, -1) || (lua_isboolean(L, -1) && !lua_toboolean(L, -1))) {
+            lua_pop(L, 1);
+            continue;
+        }
+        if (lua_isboolean(L, -1)) {
+            lua_pop(L, 1);
+            luaL_getmetatable(L, marker);
+        } else if (lua_type(L, -1) != LUA_TTABLE) {
+            lua_pop(L, 1);
+            error = std::string{"options."} + name + " must be a boolean or a table";
+            return false;
+        }
+        *target = lua_gettop(L);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Parse a JSON string once, validate it and decode it to Lua.
+ *
+ * Implements `CompiledSchema:decode_json(instance_json_string[, options]) -> boolean, value`
+ *
+ * Replaces decoding a payload with a JSON library and validating the same
+ * text again: the document parsed for validation is also the one turned
+ * into Lua values. Options:
+ * - `decode_on_failure`: Also decode invalid documents (default: true); when false `value` is nil for them
+ * - `null`: Value used for JSON null, e.g. `cjson.null` (default: nil)
+ * - `array_mt`: Metatable for decoded arrays, or true for `luablaze.array_mt` (default: none)
+ * - `object_mt`: Metatable for decoded objects, or true for `luablaze.object_mt` (default: none)
+ *
+ * @param L Lua state (expects a CompiledSchema at index 1, a JSON string at index 2, optional options at index 3)
+ * @return 2 (boolean result and decoded value on stack)
+ * @throws Lua error on parse or decode failure
+ */
+static int compiled_schema_decode_json(lua_State *L) {
+    auto *compiled = check_compiled_schema(L, 1);
+    std::size_t instance_len{0};
+    const char *instance_str = luaL_checklstring(L, 2, &instance_len);
+    lua_settop(L, 3);
+
+    try {
+        bool decode_on_failure{true};
+        LuaDecodeStyle style;
+        std::string error;
+        if (!lua_isnil(L, 3)) {
+            if (lua_type(L, 3) != LUA_TTABLE) {
+                throw std::runtime_error("options_table must be a table");
+            }
+            if (!parse_decode_options_table(L, 3, decode_on_failure, style, error)) {
+                throw std::runtime_error(error);
+            }
+        }
+
+        StatsTimer timer{compiled->stats.get()};
+        const auto instance =
+            parse_json_with_limits(std::string_view{instance_str, instance_len}, parse_limits_of(*compiled));
+        timer.lap(&SchemaStats::parse_ns);
+        const bool result = compiled->evaluator.validate(*compiled->schema_template, instance);
+        timer.lap(&SchemaStats::evaluation_ns);
+
+        lua_pushboolean(L, result);
+        if (result || decode_on_failure) {
+            if (!json_to_lua_value(L, instance, compiled->max_recursion_depth, 0, error, &style)) {
+                throw std::runtime_error(error);
+            }
+        } else {
+            lua_pushnil(L);
+        }
+        timer.lap(&SchemaStats::conversion_ns);
+        timer.finish(result);
+        return 2;
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Options accepted by the `*_detailed` methods.
+ *
+ * @var flag Only report validity (`format = "flag"`), skipping error collection entirely
+ * @var max_errors Maximum number of error entries converted to Lua (0 = unlimited)
+ * @var fields Output unit keys to keep in each entry (empty = all)
+ * @var lazy Return a `Report` view instead of converting the report to Lua tables
+ */
+struct DetailedOptions {
+    bool flag{false};
+    std::size_t max_errors{0};
+    std::vector<std::string> fields;
+    bool lazy{false};
+};
+
+// Parse the optional options table accepted by the `*_detailed` methods.
+//
+// Supported keys:
+// - `format`: "basic" (default) or "flag"
+// - `max_errors`: maximum number of error entries in the report
+// - `fields`: array of output unit keys to keep ("instanceLocation",
+//   "keywordLocation", "absoluteKeywordLocation", "error")
+// - `lazy`: return a `Report` view instead of a table
+static bool parse_detailed_options_table(lua_State *L, const int index, DetailedOptions &options,
+                                         std::string &error) {
+    const int abs_index = lua_absindex(L, index);
+    if (!validate_options_table_keys(L, abs_index, error) ||
+        !parse_size_option(L, abs_index, "max_errors", options.max_errors, error) ||
+        !parse_boolean_option(L, abs_index, "lazy", options.lazy, error)) {
+        return false;
+    }
+
+    lua_getfield(L, abs_index, "format");
+    if (!lua_isnil(L, -1)) {
+        const char *format = lua_type(L, -1) == LUA_TSTRING ? lua_tostring(L, -1) : "";
+        if (std::strcmp(format, "flag") == 0) {
+            options.flag = true;
+        } else if (std::strcmp(format, "basic") != 0) {
+            lua_pop(L, 1);
+            error = "options.format must be \"basic\" or \"flag\"";
+            return false;
+        }
+    }
+    lua_pop(L, 1);
+
+    lua_getfield(L, abs_index, "fields");
+    if (!lua_isnil(L, -1)) {
+        if (!lua_istable(L, -1)) {
+            lua_pop(L, 1);
+            error = "options.fields must be a table";
+            return false;
+        }
+        const auto count = static_cast<std::size_t>(lua_rawlen(L, -1));
+        for (std::size_t i = 1; i <= count; i++) {
+            lua_rawgeti(L, -1, static_cast<lua_Integer>(i));
+            const char *field = lua_type(L, -1) == LUA_TSTRING ? lua_tostring(L, -1) : "";
+            if (std::strcmp(field, "instanceLocation") != 0 && std::strcmp(field, "keywordLocation") != 0 &&
+                std::strcmp(field, "absoluteKeywordLocation") != 0 && std::strcmp(field, "error") != 0) {
+                lua_pop(L, 2);
+                error = "options.fields[" + std::to_string(i) +
+                        "] must be one of \"instanceLocation\", \"keywordLocation\", "
+                        "\"absoluteKeywordLocation\" or \"error\"";
+                return false;
+            }
+            options.fields.emplace_back(field);
+            lua_pop(L, 1);
+        }
+    }
+    lua_pop(L, 1);
+
+    return true;
+}
+
+// Read the optional detailed options table at `index` into `options`.
+// Throws on invalid options.
+static void check_detailed_options(lua_State *L, const int index, DetailedOptions &options) {
+    if (lua_isnoneornil(L, index)) {
+        return;
+    }
+    if (lua_type(L, index) != LUA_TTABLE) {
+        throw std::runtime_error("options_table must be a table");
+    }
+    std::string error;
+    if (!parse_detailed_options_table(L, index, options, error)) {
+        throw std::runtime_error(error);
+    }
+}
+
+// Copy the array of output units `units`, keeping at most `limit` entries
+// (0 = all) and only the keys in `fields` (empty = all).
+static auto trim_output_units(const sourcemeta::core::JSON &units, const std::size_t limit,
+                              const std::vector<std::string> &fields) -> sourcemeta::core::JSON {
+    const auto total = units.size();
+    const auto count = limit == 0 ? total : std::min(total, limit);
+    auto result      = sourcemeta::core::JSON::make_array();
+    for (std::size_t i = 0; i < count; i++) {
+        const auto &unit = units.at(i);
+        if (fields.empty() || !unit.is_object()) {
+            result.push_back(unit);
+            continue;
+        }
+
+        auto trimmed = sourcemeta::core::JSON::make_object();
+        for (const auto &field : fields) {
+            const auto *value = unit.try_at(field);
+            if (value != nullptr) {
+                trimmed.assign(field, *value);
+            }
+        }
+        result.push_back(std::move(trimmed));
+    }
+
+    return result;
+}
+
+// Apply `max_errors` / `fields` to a standard output document.
+static auto bound_standard_output(const sourcemeta::core::JSON &result, const DetailedOptions &options)
+    -> sourcemeta::core::JSON {
+    auto report = sourcemeta::core::JSON::make_object();
+    for (const auto &pair : result.as_object()) {
+        if (pair.first == "errors" && pair.second.is_array()) {
+            report.assign("errors", trim_output_units(pair.second, options.max_errors, options.fields));
+            if (options.max_errors > 0 && pair.second.size() > options.max_errors) {
+                report.assign("truncated", sourcemeta::core::JSON{true});
+            }
+        } else if (pair.first == "annotations" && pair.second.is_array()) {
+            report.assign("annotations", trim_output_units(pair.second, 0, options.fields));
+        } else {
+            report.assign(pair.first, pair.second);
+        }
+    }
+
+    return report;
+}
+
+/**
+ * @brief Lazily converted view of a validation report.
+ *
+ * Holds the output document on the C++ side and converts the parts that are
+ * actually read: indexing returns Lua scalars for scalar members and further
+ * `Report` views for arrays and objects. All views of one report share the
+ * same document.
+ */
+struct ReportUserdata {
+    std::shared_ptr<const sourcemeta::core::JSON> root;
+    const sourcemeta::core::JSON *node;
+    std::size_t max_recursion_depth;
+};
+
+// Push a `Report` view of `node`, which must live inside `root`.
+static void push_report(lua_State *L, std::shared_ptr<const sourcemeta::core::JSON> root,
+                        const sourcemeta::core::JSON *node, const std::size_t max_recursion_depth) {
+    auto *ud = static_cast<ReportUserdata *>(lua_newuserdata(L, sizeof(ReportUserdata)));
+    new (ud) ReportUserdata{nullptr, nullptr, max_recursion_depth};
+    luaL_getmetatable(L, LUABLAZE_REPORT_MT);
+    lua_setmetatable(L, -2);
+    ud->root = std::move(root);
+    ud->node = node;
+}
+
+// Validate and extract a `Report` view from a Lua userdata at `index`.
+// Raises a Lua error if the type does not match.
+static auto check_report(lua_State *L, const int index) -> ReportUserdata * {
+    auto *ud = static_cast<ReportUserdata *>(luaL_checkudata(L, index, LUABLAZE_REPORT_MT));
+    luaL_argcheck(L, ud != nullptr && ud->root != nullptr, index, "Report expected");
+    return ud;
+}
+
+// Push `value` (a member of the report held by `ud`): scalars are converted,
+// arrays and objects become further `Report` views.
+static void push_report_value(lua_State *L, const ReportUserdata *ud, const sourcemeta::core::JSON &value) {
+    if (value.is_array() || value.is_object()) {
+        push_report(L, ud->root, &value, ud->max_recursion_depth);
+        return;
+    }
+
+    std::string error;
+    if (!json_to_lua_value(L, value, ud->max_recursion_depth, 0, error)) {
+        luaL_error(L, "%s", error.c_str());
+    }
+}
+
+// Lua GC metamethod: release this view's reference to the report.
+static int report_gc(lua_State *L) {
+    auto *ud = static_cast<ReportUserdata *>(luaL_testudata(L, 1, LUABLAZE_REPORT_MT));
+    if (ud != nullptr) {
+        ud->root.reset();
+        ud->node = nullptr;
+    }
+    return 0;
+}
+
+// `__index` metamethod: methods first, then object members by name or array
+// elements by 1-based index. Missing members are nil.
+static int report_index(lua_State *L) {
+    auto *ud = check_report(L, 1);
+
+    if (lua_type(L, 2) == LUA_TSTRING) {
+        lua_pushvalue(L, 2);
+        lua_rawget(L, lua_upvalueindex(1));
+        if (!lua_isnil(L, -1)) {
+            return 1;
+        }
+        lua_pop(L, 1);
+
+        if (ud->node->is_object()) {
+            std::size_t key_len{0};
+            const char *key   = lua_tolstring(L, 2, &key_len);
+            const auto *value = ud->node->try_at(sourcemeta::core::JSON::String{key, key_len});
+            if (value != nullptr) {
+                push_report_value(L, ud, *value);
+                return 1;
+            }
+        }
+    } else if (lua_isinteger(L, 2) && ud->node->is_array()) {
+        const lua_Integer index = lua_tointeger(L, 2);
+        if (index >= 1 && static_cast<std::size_t>(index) <= ud->node->size()) {
+            push_report_value(L, ud, ud->node->at(static_cast<std::size_t>(index - 1)));
+            return 1;
+        }
+    }
+
+    lua_pushnil(L);
+    return 1;
+}
+
+// `__len` metamethod: number of elements of an array view (0 for objects).
+static int report_len(lua_State *L) {
+    auto *ud = check_report(L, 1);
+    lua_pushinteger(L, ud->node->is_array() ? static_cast<lua_Integer>(ud->node->size()) : 0);
+    return 1;
+}
+
+// A member of an object view, as yielded by iterating the object
+using ReportMember =
+    std::remove_reference_t<decltype(*std::declval<const sourcemeta::core::JSON::Object &>().begin())>;
+
+// Iterator closure behind `__pairs`. Upvalue 1 is the view, upvalue 2 the
+// position of the next member and, for objects, upvalue 3 an array of
+// pointers to the members, so that each step is constant time.
+static int report_iterate(lua_State *L) {
+    auto *ud            = check_report(L, lua_upvalueindex(1));
+    const auto position = static_cast<std::size_t>(lua_tointeger(L, lua_upvalueindex(2)));
+    const auto &node    = *ud->node;
+    if (position >= node.size()) {
+        return 0;
+    }
+
+    lua_pushinteger(L, static_cast<lua_Integer>(position + 1));
+    lua_replace(L, lua_upvalueindex(2));
+
+    if (node.is_array()) {
+        lua_pushinteger(L, static_cast<lua_Integer>(position + 1));
+        push_report_value(L, ud, node.at(position));
+        return 2;
+    }
+
+    const auto *members = static_cast<const ReportMember *const *>(lua_touserdata(L, lua_upvalueindex(3)));
+    const auto &member  = *members[position];
+    lua_pushlstring(L, member.first.data(), member.first.size());
+    push_report_value(L, ud, member.second);
+    return 2;
+}
+
+// `__pairs` metamethod and `Report:pairs()`: iterate over array elements or
+// object members. Lua 5.1 and LuaJIT ignore `__pairs`, so the method form is
+// the portable one. The report is immutable and the closure keeps it alive,
+// so pointers to the members of an object stay valid for the whole iteration.
+static int report_pairs(lua_State *L) {
+    const auto *ud = check_report(L, 1);
+    lua_pushvalue(L, 1);
+    lua_pushinteger(L, 0);
+    if (!ud->node->is_object()) {
+        lua_pushcclosure(L, report_iterate, 2);
+    } else {
+        const auto &object = ud->node->as_object();
+        auto **members     = static_cast<const ReportMember **>(
+            lua_newuserdata(L, std::max<std::size_t>(object.size(), 1) * sizeof(const ReportMember *)));
+        std::size_t index{0};
+        for (const auto &member : object) {
+            members[index++] = &member;
+        }
+        lua_pushcclosure(L, report_iterate, 3);
+    }
+    lua_pushnil(L);
+    lua_pushnil(L);
+    return 3;
+}
+
+/**
+ * @brief Count the errors of a report.
+ *
+ * Implements `Report:error_count() -> integer`
+ *
+ * @param L Lua state
+ * @return 1 (number of entries in the `errors` member, 0 if there is none)
+ */
+static int report_error_count(lua_State *L) {
+    auto *ud           = check_report(L, 1);
+    const auto *errors = ud->node->is_object() ? ud->node->try_at("errors") : nullptr;
+    lua_pushinteger(L, errors != nullptr && errors->is_array() ? static_cast<lua_Integer>(errors->size()) : 0);
+    return 1;
+}
+
+/**
+ * @brief Return the first error of a report as a plain Lua table.
+ *
+ * Implements `Report:first_error() -> table | nil`
+ *
+ * @param L Lua state
+ * @return 1 (first entry of the `errors` member, or nil)
+ */
+static int report_first_error(lua_State *L) {
+    auto *ud           = check_report(L, 1);
+    const auto *errors = ud->node->is_object() ? ud->node->try_at("errors") : nullptr;
+    if (errors == nullptr || !errors->is_array() || errors->empty()) {
+        lua_pushnil(L);
+        return 1;
+    }
+
+    std::string error;
+    if (!json_to_lua_value(L, errors->at(0), ud->max_recursion_depth, 0, error)) {
+        return luaL_error(L, "%s", error.c_str());
+    }
+    return 1;
+}
+
+/**
+ * @brief Serialize a report (or part of one) to a JSON string.
+ *
+ * Implements `Report:to_json() -> string`
+ *
+ * @param L Lua state
+ * @return 1 (JSON string on stack)
+ */
+static int report_to_json(lua_State *L) {
+    auto *ud = check_report(L, 1);
+
+    try {
+        std::ostringstream stream;
+        sourcemeta::core::stringify(*ud->node, stream);
+        const auto output = stream.str();
+        lua_pushlstring(L, output.data(), output.size());
+        return 1;
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Convert a report (or part of one) to plain Lua tables.
+ *
+ * Implements `Report:to_table() -> table`
+ *
+ * @param L Lua state
+ * @return 1 (table on stack)
+ */
+static int report_to_table(lua_State *L) {
+    auto *ud = check_report(L, 1);
+    std::string error;
+    if (!json_to_lua_value(L, *ud->node, ud->max_recursion_depth, 0, error)) {
+        return luaL_error(L, "%s", error.c_str());
+    }
+    return 1;
+}
+
+/**
+ * @brief Tracks which failing evaluation steps count as errors.
+ *
+ * Mirrors the "basic" output: a failing branch of `anyOf`, `oneOf`, `not`,
+ * `if` or `contains` only counts through its applicator, so errors whose
+ * evaluate path lies under one of those keywords are masked while it runs.
+ * `then` and `else` are siblings of `if`, so their errors still count.
+ * Used by `each_error`, which must not buffer errors: `ErrorCollector`
+ * derives the same decisions from `sourcemeta::blaze::SimpleOutput`, but
+ * that keeps every error it emits.
+ */
+class ErrorMask {
+public:
+    // Feed one evaluation step. Returns whether it is an error the "basic"
+    // output reports.
+    auto counts(const sourcemeta::blaze::EvaluationType type, const bool result,
+                const sourcemeta::core::WeakPointer &evaluate_path) -> bool {
+        if (evaluate_path.empty()) {
+            return false;
+        }
+
+        auto path          = sourcemeta::core::to_string(evaluate_path);
+        const auto slash   = path.rfind('/');
+        const auto keyword = std::string_view{path}.substr(slash == std::string::npos ? 0 : slash + 1);
+        const bool masking = keyword == "anyOf" || keyword == "oneOf" || keyword == "not" || keyword == "if" ||
+                             keyword == "contains";
+        if (type == sourcemeta::blaze::EvaluationType::Pre) {
+            if (masking) {
+                this->masks.push_back(std::move(path));
+            }
+            return false;
+        }
+
+        if (masking && !this->masks.empty()) {
+            this->masks.pop_back();
+        }
+
+        return !result && std::none_of(this->masks.cbegin(), this->masks.cend(), [&path](const std::string &prefix) {
+            return path.starts_with(prefix) && (path.size() == prefix.size() || path[prefix.size()] == '/');
+        });
+    }
+
+private:
+    // Evaluate paths of the masking applicators currently running
+    std::vector<std::string> masks;
+};
+
+/**
+ * @brief Collects the errors of the "basic" output as evaluation produces them.
+ *
+ * Wraps `sourcemeta::blaze::SimpleOutput`, which decides which failing steps
+ * are errors exactly as the standard output does (failing branches of
+ * `anyOf`, `oneOf`, `not`, ... are masked), and remembers the keyword
+ * location of the step behind every error it emits. Blaze offers no way to
+ * abandon an evaluation from its callback, so `stop()` instead stops
+ * forwarding steps: the rest of the evaluation then does no output work.
+ */
+class ErrorCollector {
+public:
+    explicit ErrorCollector(const sourcemeta::core::JSON &instance) : output{instance} {
+    }
+
+    // Forward one evaluation step. Returns whether it produced a new error.
+    auto feed(const sourcemeta::blaze::EvaluationType type, const bool result,
+              const sourcemeta::blaze::Instruction &step, const sourcemeta::core::WeakPointer &evaluate_path,
+              const sourcemeta::core::WeakPointer &instance_location, const sourcemeta::core::JSON &annotation)
+        -> bool {
+        if (this->stopped) {
+            return false;
+        }
+
+        this->output(type, result, step, evaluate_path, instance_location, annotation);
+        const auto previous = this->absolute_locations.size();
+        const auto count    = static_cast<std::size_t>(std::distance(this->output.begin(), this->output.end()));
+        this->absolute_locations.resize(count, step.keyword_location);
+        return count > previous;
+    }
+
+    auto stop() -> void {
+        this->stopped = true;
+    }
+
+    auto size() const -> std::size_t {
+        return this->absolute_locations.size();
+    }
+
+    // The error at `index` as a "basic" output unit
+    auto unit(const std::size_t index) const -> sourcemeta::core::JSON {
+        const auto &error = *std::next(this->output.begin(), static_cast<std::ptrdiff_t>(index));
+        auto result       = sourcemeta::core::JSON::make_object();
+        result.assign("keywordLocation", sourcemeta::core::JSON{sourcemeta::core::to_string(error.evaluate_path)});
+        result.assign("absoluteKeywordLocation", sourcemeta::core::JSON{this->absolute_locations[index]});
+        result.assign("instanceLocation",
+                      sourcemeta::core::JSON{sourcemeta::core::to_string(error.instance_location)});
+        result.assign("error", sourcemeta::core::JSON{error.message});
+        return result;
+    }
+
+private:
+    sourcemeta::blaze::SimpleOutput output;
+    std::vector<std::string> absolute_locations;
+    bool stopped{false};
+};
+
+// Evaluate `instance` into a "basic" output document with at most
+// `max_errors` errors. Once one more error than that is produced the report
+// is marked as `truncated` and later steps are no longer described, but the
+// evaluation itself runs to completion. Annotations are not collected.
+static auto bounded_basic_output(sourcemeta::blaze::Evaluator &evaluator,
+                                 const sourcemeta::blaze::Template &schema_template,
+                                 const sourcemeta::core::JSON &instance, const std::size_t max_errors)
+    -> sourcemeta::core::JSON {
+    ErrorCollector errors{instance};
+    bool truncated{false};
+    const bool valid = evaluator.validate(
+        schema_template, instance,
+        [&](const sourcemeta::blaze::EvaluationType type, const bool result,
+            const sourcemeta::blaze::Instruction &step, const sourcemeta::core::WeakPointer &evaluate_path,
+            const sourcemeta::core::WeakPointer &instance_location, const sourcemeta::core::JSON &annotation) {
+            if (errors.feed(type, result, step, evaluate_path, instance_location, annotation) &&
+                errors.size() > max_errors) {
+                truncated = true;
+                errors.stop();
+            }
+        });
+
+    auto report = sourcemeta::core::JSON::make_object();
+    report.assign("valid", sourcemeta::core::JSON{valid});
+    if (!valid) {
+        auto units = sourcemeta::core::JSON::make_array();
+        for (std::size_t index = 0; index < std::min(errors.size(), max_errors); index++) {
+            units.push_back(errors.unit(index));
+        }
+        report.assign("errors", std::move(units));
+    }
+    if (truncated) {
+        report.assign("truncated", sourcemeta::core::JSON{true});
+    }
+    return report;
+}
+
+// Evaluate `instance` and push the validation result and the report. Shared
+// by the `*_detailed` methods.
+//
+// With `format = "flag"` only the boolean evaluator runs, which can stop at
+// the first failure. With `max_errors` errors stop being described once the
+// report is full. Otherwise the standard "basic" output is built. `fields` then
+// trims the report handed to Lua. With `lazy = true` the report is a
+// `Report` view instead of a table.
+static int push_detailed_result(lua_State *L, CompiledSchema *compiled, const sourcemeta::core::JSON &instance,
+                                const DetailedOptions &options, StatsTimer &timer) {
+    if (!lua_checkstack(L, 4)) {
+        throw std::runtime_error("Cannot grow Lua stack for report table");
+    }
+
+    bool is_valid{false};
+    sourcemeta::core::JSON result{nullptr};
+    if (options.flag) {
+        is_valid = compiled->evaluator.validate(*compiled->schema_template, instance);
+        timer.lap(&SchemaStats::evaluation_ns);
+        result = sourcemeta::core::JSON::make_object();
+        result.assign("valid", sourcemeta::core::JSON{is_valid});
+    } else {
+        result = options.max_errors > 0
+                     ? bounded_basic_output(compiled->evaluator, *compiled->schema_template, instance,
+                                            options.max_errors)
+                     : sourcemeta::blaze::standard(compiled->evaluator, *compiled->schema_template, instance,
+                                                   sourcemeta::blaze::StandardOutput::Basic);
+
+        // Extract the "valid" field from the result
+        is_valid =
+            result.defines("valid") && result.at("valid").is_boolean() ? result.at("valid").to_boolean() : false;
+
+        timer.lap(&SchemaStats::evaluation_ns);
+        if (!options.fields.empty()) {
+            result = bound_standard_output(result, options);
+        }
+    }
+
+    lua_pushboolean(L, is_valid);
+
+    if (options.lazy) {
+        auto root        = std::make_shared<const sourcemeta::core::JSON>(std::move(result));
+        const auto *node = root.get();
+        push_report(L, std::move(root), node, compiled->max_recursion_depth);
+        timer.lap(&SchemaStats::report_ns);
+        timer.finish(is_valid);
+        return 2; // Return (boolean, Report)
+    }
+
+    // Convert the full result to a Lua table for detailed reporting
+    std::string error;
+    if (!json_to_lua_value(L, result, compiled->max_recursion_depth, 0, error)) {
+        throw std::runtime_error(error);
+    }
+    timer.lap(&SchemaStats::report_ns);
+    timer.finish(is_valid);
+
+    return 2; // Return (boolean, table)
+}
+
+/**
+ * @brief Validate a Lua table against the compiled schema with detailed report.
+ *
+ * Implements `CompiledSchema:validate_detailed(instance_table[, options]) -> boolean, report_table`
+ *
+ * Converts the Lua table at stack index 2 to a JSON value, validates it against
+ * the compiled schema template, and returns both the validation result and a detailed
+ * report in JSON Schema "basic" output format.
+ *
+ * @param L Lua state
+ * @return 2 (boolean result and report table on stack)
+ * @throws Lua error on conversion or validation failure
+ */
+static int compiled_schema_validate_detailed(lua_State *L) {
+    auto *compiled     = check_compiled_schema(L, 1);
+    const auto *parsed = test_instance(L, 2);
+    check_not_compact(L, compiled, "validate_detailed");
+    if (parsed == nullptr) {
+        luaL_checktype(L, 2, LUA_TTABLE);
+    }
+
+    try {
+        DetailedOptions options;
+        check_detailed_options(L, 3, options);
+
+        StatsTimer timer{compiled->stats.get()};
+        if (parsed != nullptr) {
+            return push_detailed_result(L, compiled, *parsed, options, timer);
+        }
+        sourcemeta::core::JSON instance{nullptr};
+        std::string error;
+        if (!convert_lua_instance(L, compiled, 2, instance, error)) {
+            throw std::runtime_error(error);
+        }
+        timer.lap(&SchemaStats::conversion_ns);
+        return push_detailed_result(L, compiled, instance, options, timer);
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Validate a JSON string against the compiled schema with detailed report.
+ *
+ * Implements `CompiledSchema:validate_json_detailed(instance_json_string[, options]) -> boolean, report_table`
+ *
+ * Parses the JSON string at stack index 2, validates it against the compiled schema
+ * template, and returns both the validation result and a detailed report in JSON Schema
+ * "basic" output format.
+ *
+ * @param L Lua state
+ * @return 2 (boolean result and report table on stack)
+ * @throws Lua error on parse or validation failure
+ */
+static int compiled_schema_validate_json_detailed(lua_State *L) {
+    auto *compiled = check_compiled_schema(L, 1);
+    check_not_compact(L, compiled, "validate_json_detailed");
+    if (test_instance(L, 2) != nullptr) {
+        return compiled_schema_validate_detailed(L);
+    }
+    std::size_t instance_len{0};
+    const char *instance_str = luaL_checklstring(L, 2, &instance_len);
+
+    try {
+        DetailedOptions options;
+        check_detailed_options(L, 3, options);
+
+        StatsTimer timer{compiled->stats.get()};
+        const auto instance =
+            parse_json_with_limits(std::string_view{instance_str, instance_len}, parse_limits_of(*compiled));
+        timer.lap(&SchemaStats::parse_ns);
+        return push_detailed_result(L, compiled, instance, options, timer);
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Validate a JSON file against the compiled schema.
+ *
+ * Implements `CompiledSchema:validate_file(path) -> boolean`
+ *
+ * The file is memory-mapped (where supported) and parsed in place with the
+ * schema's parse limits, so it is never copied into the Lua heap.
+ *
+ * @param L Lua state (expects a CompiledSchema at index 1 and a path at index 2)
+ * @return 1 (boolean result on stack)
+ * @throws Lua error if the file cannot be read or parsed
+ */
+static int compiled_schema_validate_file(lua_State *L) {
+    auto *compiled   = check_compiled_schema(L, 1);
+    const char *path = luaL_checkstring(L, 2);
+
+    try {
+        StatsTimer timer{compiled->stats.get()};
+        const MappedFile file{path};
+        const auto instance = parse_json_with_limits(file.view(), parse_limits_of(*compiled));
+        timer.lap(&SchemaStats::parse_ns);
+        const bool result = compiled->evaluator.validate(*compiled->schema_template, instance);
+        timer.lap(&SchemaStats::evaluation_ns);
+        timer.finish(result);
+        lua_pushboolean(L, result);
+        return 1;
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Validate a JSON file against the compiled schema with detailed report.
+ *
+ * Implements `CompiledSchema:validate_file_detailed(path[, options]) -> boolean, report_table`
+ *
+ * Reads the file like `CompiledSchema:validate_file` and reports like
+ * `CompiledSchema:validate_json_detailed`.
+ *
+ * @param L Lua state (expects a CompiledSchema at index 1 and a path at index 2)
+ * @return 2 (boolean result and report table on stack)
+ * @throws Lua error if the file cannot be read or parsed
+ */
+static int compiled_schema_validate_file_detailed(lua_State *L) {
+    auto *compiled   = check_compiled_schema(L, 1);
+    const char *path = luaL_checkstring(L, 2);
+    check_not_compact(L, compiled, "validate_file_detailed");
+
+    try {
+        DetailedOptions options;
+        check_detailed_options(L, 3, options);
+
+        StatsTimer timer{compiled->stats.get()};
+        const MappedFile file{path};
+        const auto instance = parse_json_with_limits(file.view(), parse_limits_of(*compiled));
+        timer.lap(&SchemaStats::parse_ns);
+        return push_detailed_result(L, compiled, instance, options, timer);
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Evaluator callback that hands every error to a Lua function.
+ *
+ * Errors are reported as they are produced, except those masked by an
+ * `ErrorMask`, so the errors seen match the "basic" output without buffering.
+ *
+ * The function at `function_index` is called as `fn(instance_location,
+ * keyword_location, message)` through `lua_pcall`, so Lua errors never unwind
+ * through the evaluator. A truthy return value asks to stop: the callback
+ * then throws `Stop` to abandon the evaluation.
+ */
+class ErrorStream {
+public:
+    struct Stop {};
+
+    ErrorStream(lua_State *L, const int function_index, const sourcemeta::core::JSON &instance)
+        : L{L}, function_index{function_index}, instance{instance} {
+    }
+
+    auto callback() -> sourcemeta::blaze::Callback {
+        return [this](const sourcemeta::blaze::EvaluationType type, const bool result,
+                      const sourcemeta::blaze::Instruction &step, const sourcemeta::core::WeakPointer &evaluate_path,
+                      const sourcemeta::core::WeakPointer &instance_location,
+                      const sourcemeta::core::JSON &annotation) {
+            this->on_step(type, result, step, evaluate_path, instance_location, annotation);
+        };
+    }
+
+    auto count() const -> std::size_t {
+        return this->reported;
+    }
+
+    // The Lua error raised by the callback function, if any
+    auto error() const -> const std::optional<std::string> & {
+        return this->lua_error;
+    }
+
+private:
+    auto on_step(const sourcemeta::blaze::EvaluationType type, const bool result,
+                 const sourcemeta::blaze::Instruction &step, const sourcemeta::core::WeakPointer &evaluate_path,
+                 const sourcemeta::core::WeakPointer &instance_location, const sourcemeta::core::JSON &annotation)
+        -> void {
+        if (!this->mask.counts(type, result, evaluate_path)) {
+            return;
+        }
+
+        const auto location         = sourcemeta::core::to_string(instance_location);
+        const auto keyword_location = sourcemeta::core::to_string(evaluate_path);
+        const auto message =
+            sourcemeta::blaze::describe(result, step, evaluate_path, instance_location, this->instance, annotation);
+
+        lua_pushvalue(this->L, this->function_index);
+        lua_pushlstring(this->L, location.data(), location.size());
+        lua_pushlstring(this->L, keyword_location.data(), keyword_location.size());
+        lua_pushlstring(this->L, message.data(), message.size());
+        this->reported++;
+        if (lua_pcall(this->L, 3, 1, 0) != LUA_OK) {
+            const char *text = lua_tostring(this->L, -1);
+            this->lua_error  = text != nullptr ? text : "error in each_error callback";
+            lua_pop(this->L, 1);
+            throw Stop{};
+        }
+        const bool stop = lua_toboolean(this->L, -1) != 0;
+        lua_pop(this->L, 1);
+        if (stop) {
+            throw Stop{};
+        }
+    }
+
+    lua_State *L;
+    int function_index;
+    const sourcemeta::core::JSON &instance;
+    ErrorMask mask;
+    std::size_t reported{0};
+    std::optional<std::string> lua_error;
+};
+
+// Shared implementation of `each_error` and `each_error_json`: stream the
+// errors of `instance` to the function at index 3.
+static int stream_errors(lua_State *L, CompiledSchema *compiled, const sourcemeta::core::JSON &instance,
+                         StatsTimer &timer) {
+    // The function and its three arguments
+    if (!lua_checkstack(L, 4)) {
+        throw std::runtime_error("Cannot grow Lua stack for each_error");
+    }
+
+    // A stopped evaluation leaves its evaluator half-way, so use a fresh one
+    sourcemeta::blaze::Evaluator evaluator;
+    ErrorStream stream{L, 3, instance};
+    bool result{false};
+    bool stopped{false};
+    try {
+        result = evaluator.validate(*compiled->schema_template, instance, stream.callback());
+    } catch (const ErrorStream::Stop &) {
+        stopped = true;
+    }
+    if (stream.error().has_value()) {
+        throw std::runtime_error(stream.error().value());
+    }
+    timer.lap(&SchemaStats::evaluation_ns);
+    timer.finish(result);
+
+    lua_pushboolean(L, result);
+    lua_pushinteger(L, static_cast<lua_Integer>(stream.count()));
+    lua_pushboolean(L, stopped);
+    return 3;
+}
+
+/**
+ * @brief Stream the validation errors of a Lua table to a function.
+ *
+ * Implements `CompiledSchema:each_error(instance_table, fn) -> boolean, integer, boolean`
+ *
+ * Calls `fn(instance_location, keyword_location, message)` for every error
+ * as evaluation produces it, without building an output document; memory
+ * use does not grow with the number of errors. Returning a truthy value from
+ * `fn` stops the evaluation. Use an Exhaustive-mode schema to see every
+ * error. Returns the validation result (false if stopped), the number of
+ * errors passed to `fn` and whether `fn` stopped the evaluation. Errors
+ * raised by `fn` propagate.
+ *
+ * @param L Lua state (expects a CompiledSchema at index 1, a table or Instance at index 2, a function at index 3)
+ * @return 3 (result, error count and stopped flag on stack)
+ * @throws Lua error on conversion failure or if `fn` raises
+ */
+static int compiled_schema_each_error(lua_State *L) {
+    auto *compiled     = check_compiled_schema(L, 1);
+    const auto *parsed = test_instance(L, 2);
+    check_not_compact(L, compiled, "each_error");
+    if (parsed == nullptr) {
+        luaL_checktype(L, 2, LUA_TTABLE);
+    }
+    luaL_checktype(L, 3, LUA_TFUNCTION);
+    lua_settop(L, 3);
+
+    try {
+        StatsTimer timer{compiled->stats.get()};
+        if (parsed != nullptr) {
+            return stream_errors(L, compiled, *parsed, timer);
+        }
+        sourcemeta::core::JSON instance{nullptr};
+        std::string error;
+        if (!convert_lua_instance(L, compiled, 2, instance, error)) {
+            throw std::runtime_error(error);
+        }
+        timer.lap(&SchemaStats::conversion_ns);
+        return stream_errors(L, compiled, instance, timer);
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Stream the validation errors of a JSON string to a function.
+ *
+ * Implements `CompiledSchema:each_error_json(instance_json_string, fn) -> boolean, integer, boolean`
+ *
+ * Parses the string, then behaves like `CompiledSchema:each_error`.
+ *
+ * @param L Lua state (expects a CompiledSchema at index 1, a JSON string or Instance at index 2, a function at index 3)
+ * @return 3 (result, error count and stopped flag on stack)
+ * @throws Lua error on parse failure or if `fn` raises
+ */
+static int compiled_schema_each_error_json(lua_State *L) {
+    auto *compiled = check_compiled_schema(L, 1);
+    check_not_compact(L, compiled, "each_error_json");
+    if (test_instance(L, 2) != nullptr) {
+        return compiled_schema_each_error(L);
+    }
+    std::size_t instance_len{0};
+    const char *instance_str = luaL_checklstring(L, 2, &instance_len);
+    luaL_checktype(L, 3, LUA_TFUNCTION);
+    lua_settop(L, 3);
+
+    try {
+        StatsTimer timer{compiled->stats.get()};
+        const auto instance =
+            parse_json_with_limits(std::string_view{instance_str, instance_len}, parse_limits_of(*compiled));
+        timer.lap(&SchemaStats::parse_ns);
+        return stream_errors(L, compiled, instance, timer);
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Alias for validate() - evaluates a Lua table against the compiled schema.
+ *
+ * Implements `CompiledSchema:evaluate(instance_table) -> boolean`
+ *
+ * For this binding, `evaluate` is an alias of `validate`.
+ *
+ * @param L Lua state
+ * @return 1 (boolean result on stack)
+ * @see compiled_schema_validate
+ */
+static int compiled_schema_evaluate(lua_State *L) {
+    return compiled_schema_validate(L);
+}
+
+/**
+ * @brief Evaluator callback that times every instruction of one evaluation.
+ *
+ * Instructions are grouped by their absolute keyword location. Pre/Post
+ * callbacks nest, so a stack of open instructions yields both the inclusive
+ * time of each keyword and its self time (excluding nested keywords). The
+ * locations are views into the template, which must outlive the profiler.
+ */
+class EvaluationProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Keyword {
+        std::uint64_t calls{0};
+        std::uint64_t failures{0};
+        std::uint64_t total_ns{0};
+        std::uint64_t self_ns{0};
+    };
+
+    auto callback() -> sourcemeta::blaze::Callback {
+        return [this](const sourcemeta::blaze::EvaluationType type, const bool result,
+                      const sourcemeta::blaze::Instruction &step, const sourcemeta::core::WeakPointer &,
+                      const sourcemeta::core::WeakPointer &,
+                      const sourcemeta::core::JSON &) { this->on_step(type, result, step); };
+    }
+
+    // Keywords sorted by descending inclusive time, then by location
+    auto sorted() const -> std::vector<std::pair<std::string_view, Keyword>> {
+        std::vector<std::pair<std::string_view, Keyword>> result{this->keywords.begin(), this->keywords.end()};
+        std::sort(result.begin(), result.end(), [](const auto &left, const auto &right) {
+            return left.second.total_ns != right.second.total_ns ? left.second.total_ns > right.second.total_ns
+                                                                 : left.first < right.first;
+        });
+        return result;
+    }
+
+private:
+    struct Frame {
+        std::string_view location;
+        Clock::time_point start;
+        std::uint64_t children_ns;
+    };
+
+    auto on_step(const sourcemeta::blaze::EvaluationType type, const bool result,
+                 const sourcemeta::blaze::Instruction &step) -> void {
+        const auto now = Clock::now();
+        if (type == sourcemeta::blaze::EvaluationType::Pre) {
+            this->stack.push_back({step.keyword_location, now, 0});
+            return;
+        }
+
+        if (this->stack.empty()) {
+            return;
+        }
+
+        const auto frame = this->stack.back();
+        this->stack.pop_back();
+        const auto elapsed =
+            static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - frame.start).count());
+
+        auto &keyword = this->keywords[frame.location];
+        keyword.calls++;
+        if (!result) {
+            keyword.failures++;
+        }
+        keyword.total_ns += elapsed;
+        keyword.self_ns += elapsed > frame.children_ns ? elapsed - frame.children_ns : 0;
+
+        if (!this->stack.empty()) {
+            this->stack.back().children_ns += elapsed;
+        }
+    }
+
+    std::vector<Frame> stack;
+    std::unordered_map<std::string_view, Keyword> keywords;
+};
+
+/**
+ * @brief Profile the evaluation of an instance keyword by keyword.
+ *
+ * Implements `CompiledSchema:profile(instance[, options]) -> boolean, keywords`
+ *
+ * `instance` is a Lua table (converted like `CompiledSchema:validate`) or a
+ * JSON string (parsed like `CompiledSchema:validate_json`). The instance is
+ * evaluated through an evaluator callback that times every instruction, so
+ * expect it to run several times slower than `validate`; conversion and
+ * parsing are not included.
+ *
+ * `keywords` is an array sorted by descending `seconds`, one entry per
+ * absolute keyword location:
+ * `{ keyword_location = uri, calls = n, failures = n, seconds = s, self_seconds = s }`.
+ * `seconds` includes nested keywords (recursive references count their time
+ * at every level); `self_seconds` does not.
+ *
+ * Options:
+ * - `iterations`: evaluate this many times and accumulate (default: 1)
+ *
+ * @param L Lua state
+ * @return 2 (boolean result and keywords table on stack)
+ * @throws Lua error on conversion or parse failure
+ */
+static int compiled_schema_profile(lua_State *L) {
+    auto *compiled     = check_compiled_schema(L, 1);
+    const int type     = lua_type(L, 2);
+    const auto *parsed = test_instance(L, 2);
+    check_not_compact(L, compiled, "profile");
+    luaL_argcheck(L, parsed != nullptr || type == LUA_TTABLE || type == LUA_TSTRING, 2,
+                  "table, JSON string or Instance expected");
+
+    std::size_t iterations{1};
+    if (!lua_isnoneornil(L, 3)) {
+        luaL_checktype(L, 3, LUA_TTABLE);
+        std::string options_error;
+        if (!validate_options_table_keys(L, 3, options_error) ||
+            !parse_size_option(L, lua_absindex(L, 3), "iterations", iterations, options_error)) {
+            return luaL_error(L, "%s", options_error.c_str());
+        }
+        if (iterations == 0) {
+            return luaL_error(L, "options.iterations must be at least 1");
+        }
+    }
+
+    if (!lua_checkstack(L, 4)) {
+        return luaL_error(L, "Cannot grow Lua stack for profile table");
+    }
+
+    try {
+        sourcemeta::core::JSON instance{nullptr};
+        if (parsed == nullptr && type == LUA_TTABLE) {
+            std::string error;
+            if (!convert_lua_instance(L, compiled, 2, instance, error)) {
+                throw std::runtime_error(error);
+            }
+        } else if (parsed == nullptr) {
+            std::size_t instance_len{0};
+            const char *instance_str = lua_tolstring(L, 2, &instance_len);
+            instance = parse_json_with_limits(std::string_view{instance_str, instance_len}, parse_limits_of(*compiled));
+        }
+        const auto &subject = parsed != nullptr ? *parsed : instance;
+
+        // Keep the template alive for the locations the profiler points into
+        const auto schema_template = compiled->schema_template;
+        EvaluationProfiler profiler;
+        const auto callback = profiler.callback();
+        bool result{false};
+        for (std::size_t i = 0; i < iterations; i++) {
+            result = compiled->evaluator.validate(*schema_template, subject, callback);
+        }
+
+        const auto keywords = profiler.sorted();
+        lua_pushboolean(L, result);
+        lua_createtable(L, static_cast<int>(std::min<std::size_t>(keywords.size(), INT_MAX)), 0);
+        lua_Integer index{0};
+        for (const auto &[location, keyword] : keywords) {
+            lua_createtable(L, 0, 5);
+            lua_pushlstring(L, location.data(), location.size());
+            lua_setfield(L, -2, "keyword_location");
+            lua_pushinteger(L, static_cast<lua_Integer>(keyword.calls));
+            lua_setfield(L, -2, "calls");
+            lua_pushinteger(L, static_cast<lua_Integer>(keyword.failures));
+            lua_setfield(L, -2, "failures");
+            lua_pushnumber(L, static_cast<lua_Number>(keyword.total_ns) / 1e9);
+            lua_setfield(L, -2, "seconds");
+            lua_pushnumber(L, static_cast<lua_Number>(keyword.self_ns) / 1e9);
+            lua_setfield(L, -2, "self_seconds");
+            lua_rawseti(L, -2, ++index);
+        }
+        return 2; // Return (boolean, keywords)
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+// Parse the optional options table accepted by the batch validation methods.
+//
+// Supported keys:
+// - `failures_only`: when true, return the 1-based indices of the invalid
+//   instances instead of one boolean per instance
+static bool parse_batch_options_table(lua_State *L, const int index, bool &failures_only, std::string &error) {
+    const int abs_index = lua_absindex(L, index);
+    if (!validate_options_table_keys(L, abs_index, error)) {
+        return false;
+    }
+
+    lua_getfield(L, abs_index, "failures_only");
+    if (!lua_isnil(L, -1)) {
+        if (!lua_isboolean(L, -1)) {
+            lua_pop(L, 1);
+            error = "options.failures_only must be a boolean";
+            return false;
+        }
+        failures_only = lua_toboolean(L, -1) != 0;
+    }
+    lua_pop(L, 1);
+
+    return true;
+}
+
+// Shared implementation of `validate_many` and `validate_json_many`.
+//
+// All instances of the batch are validated within a single Lua -> C call,
+// reusing the same evaluator and conversion scratch state for every
+// element. Conversion and parse failures raise a Lua error naming the
+// offending element; schema violations never raise.
+static int compiled_schema_validate_batch(lua_State *L, const bool json_strings) {
+    auto *compiled = check_compiled_schema(L, 1);
+    luaL_checktype(L, 2, LUA_TTABLE);
+
+    bool failures_only{false};
+    if (!lua_isnoneornil(L, 3)) {
+        luaL_checktype(L, 3, LUA_TTABLE);
+        std::string options_error;
+        if (!parse_batch_options_table(L, 3, failures_only, options_error)) {
+            return luaL_error(L, "%s", options_error.c_str());
+        }
+    }
+
+    const auto count = static_cast<std::size_t>(lua_rawlen(L, 2));
+    if (count > static_cast<std::size_t>(INT_MAX)) {
+        return luaL_error(L, "Batch is too large (%d instances maximum)", INT_MAX);
+    }
+
+    // Results table + current element + conversion headroom
+    if (!lua_checkstack(L, 8)) {
+        return luaL_error(L, "Cannot grow Lua stack for batch results");
+    }
+
+    lua_createtable(L, failures_only ? 0 : static_cast<int>(count), 0);
+    const int results_index = lua_gettop(L);
+
+    try {
+        std::string error;
+        lua_Integer invalid_count{0};
+
+        for (std::size_t i = 1; i <= count; i++) {
+            lua_rawgeti(L, 2, static_cast<lua_Integer>(i));
+            const int element_index = lua_gettop(L);
+            bool result{false};
+            StatsTimer timer{compiled->stats.get()};
+
+            if (const auto *parsed = test_instance(L, element_index); parsed != nullptr) {
+                result = compiled->evaluator.validate(*compiled->schema_template, *parsed);
+            } else if (json_strings) {
+                if (lua_type(L, element_index) != LUA_TSTRING) {
+                    throw std::runtime_error("instances[" + std::to_string(i) + "] must be a string (found " +
+                                             luaL_typename(L, element_index) + ")");
+                }
+                std::size_t instance_len{0};
+                const char *instance_str = lua_tolstring(L, element_index, &instance_len);
+                try {
+                    const auto instance = parse_json_with_limits(std::string_view{instance_str, instance_len},
+                                                                 parse_limits_of(*compiled));
+                    timer.lap(&SchemaStats::parse_ns);
+                    result = compiled->evaluator.validate(*compiled->schema_template, instance);
+                } catch (const std::exception &e) {
+                    throw std::runtime_error("instances[" + std::to_string(i) + "]: " + e.what());
+                }
+            } else {
+                if (lua_type(L, element_index) != LUA_TTABLE) {
+                    throw std::runtime_error("instances[" + std::to_string(i) + "] must be a table (found " +
+                                             luaL_typename(L, element_index) + ")");
+                }
+                sourcemeta::core::JSON instance{nullptr};
+                if (!convert_lua_instance(L, compiled, element_index, instance, error)) {
+                    throw std::runtime_error("instances[" + std::to_string(i) + "]: " + error);
+                }
+                timer.lap(&SchemaStats::conversion_ns);
+                result = compiled->evaluator.validate(*compiled->schema_template, instance);
+            }
+            timer.lap(&SchemaStats::evaluation_ns);
+            timer.finish(result);
+            lua_pop(L, 1);
+
+            if (!result) {
+                invalid_count++;
+            }
+
+            if (!failures_only) {
+                lua_pushboolean(L, result);
+                lua_rawseti(L, results_index, static_cast<lua_Integer>(i));
+            } else if (!result) {
+                lua_pushinteger(L, static_cast<lua_Integer>(i));
+                lua_rawseti(L, results_index, invalid_count);
+            }
+        }
+
+        lua_pushinteger(L, invalid_count);
+        return 2; // Return (results, invalid_count)
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Validate an array of Lua tables against the compiled schema in one call.
+ *
+ * Implements `CompiledSchema:validate_many(instances[, options]) -> results, invalid_count`
+ *
+ * Each element of the Lua array at stack index 2 is converted and validated
+ * exactly like `CompiledSchema:validate`. By default `results` holds one
+ * boolean per instance; with `{ failures_only = true }` it holds the 1-based
+ * indices of the invalid instances instead.
+ *
+ * @param L Lua state
+ * @return 2 (results table and number of invalid instances on stack)
+ * @throws Lua error on conversion failure of any element
+ */
+static int compiled_schema_validate_many(lua_State *L) {
+    return compiled_schema_validate_batch(L, false);
+}
+
+/**
+ * @brief Validate an array of JSON strings against the compiled schema in one call.
+ *
+ * Implements `CompiledSchema:validate_json_many(instance_json_strings[, options]) -> results, invalid_count`
+ *
+ * Each element of the Lua array at stack index 2 is parsed and validated
+ * exactly like `CompiledSchema:validate_json`. The result shape is the same as
+ * for `CompiledSchema:validate_many`.
+ *
+ * @param L Lua state
+ * @return 2 (results table and number of invalid instances on stack)
+ * @throws Lua error on parse failure of any element
+ */
+static int compiled_schema_validate_json_many(lua_State *L) {
+    return compiled_schema_validate_batch(L, true);
+}
+
+class WorkerPool;
+static auto worker_pool() -> WorkerPool &;
+
+/**
+ * @brief Process-wide pool of background threads for asynchronous and parallel validation.
+ *
+ * Threads are started on the first submission (one per hardware thread) and
+ * joined when the module is unloaded; tasks still queued at that point are
+ * dropped.
+ *
+ * Only the thread calling fork() survives in the child, so a `pthread_atfork`
+ * child handler forgets the inherited workers and queue; the next submission
+ * in the child starts fresh threads. Jobs submitted before the fork complete
+ * in the parent only.
+ */
+class WorkerPool {
+public:
+    ~WorkerPool() {
+        {
+            const std::lock_guard<std::mutex> lock{this->mutex};
+            this->stopping = true;
+            this->tasks.clear();
+        }
+        this->available.notify_all();
+        for (auto &thread : this->threads) {
+            thread.join();
+        }
+    }
+
+    auto submit(std::function<void()> task) -> void {
+        {
+            const std::lock_guard<std::mutex> lock{this->mutex};
+            if (this->threads.empty()) {
+#if !defined(_WIN32)
+                static std::once_flag fork_handlers;
+                std::call_once(fork_handlers, []() {
+                    pthread_atfork(WorkerPool::before_fork, WorkerPool::after_fork_parent,
+                                   WorkerPool::after_fork_child);
+                });
+#endif
+                const auto count = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+                for (std::size_t i = 0; i < count; i++) {
+                    this->threads.emplace_back([this]() { this->run(); });
+                }
+            }
+            this->tasks.push_back(std::move(task));
+        }
+        this->available.notify_one();
+    }
+
+private:
+#if !defined(_WIN32)
+    // Hold the lock across fork() so no worker owns it in the child
+    static auto before_fork() -> void {
+        worker_pool().mutex.lock();
+    }
+
+    static auto after_fork_parent() -> void {
+        worker_pool().mutex.unlock();
+    }
+
+    static auto after_fork_child() -> void {
+        auto &pool = worker_pool();
+        // The thread objects refer to workers that do not exist here: they
+        // can be neither joined nor destroyed, so their storage is leaked.
+        new std::vector<std::thread>(std::move(pool.threads));
+        pool.threads.clear();
+        pool.tasks.clear();
+        // Parent workers may still be registered as waiters
+        new (&pool.available) std::condition_variable;
+        pool.mutex.unlock();
+    }
+#endif
+
+    auto run() -> void {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock{this->mutex};
+                this->available.wait(lock, [this]() { return this->stopping || !this->tasks.empty(); });
+                if (this->stopping) {
+                    return;
+                }
+                task = std::move(this->tasks.front());
+                this->tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable available;
+    std::deque<std::function<void()>> tasks;
+    std::vector<std::thread> threads;
+    bool stopping{false};
+};
+
+static auto worker_pool() -> WorkerPool & {
+    static WorkerPool pool;
+    return pool;
+}
+
+// Validate `instances` against `schema_template` on the calling thread plus
+// up to `threads - 1` tasks of the shared `WorkerPool`, each with its own
+// evaluator. A non-null `parsed[i]` is evaluated as is instead of parsing
+// `instances[i]`. Pure C++: no Lua API calls, so the strings and documents
+// backing both vectors must stay alive for the duration of the call.
+// `results[i]` is set to 1 for valid instances; the first failure (by index)
+// is reported through `error_index` (1-based, 0 = none) and `error`.
+static void validate_json_strings_parallel(const sourcemeta::blaze::Template &schema_template,
+                                           const std::vector<std::string_view> &instances,
+                                           const std::vector<const sourcemeta::core::JSON *> &parsed,
+                                           const ParseLimits &limits,
+                                           const std::size_t threads, std::vector<char> &results,
+                                           std::size_t &error_index, std::string &error) {
+    // Shared with the pool tasks, which may only start once the calling
+    // thread has finished the batch: they then return without touching it
+    struct Batch {
+        std::mutex mutex;
+        std::condition_variable idle;
+        std::size_t running{0};
+        bool closed{false};
+    };
+
+    // Workers claim chunks of indices; several chunks per thread keep them
+    // balanced when instance sizes vary
+    const auto chunk = std::max<std::size_t>(instances.size() / (threads * 8), 1);
+    std::atomic<std::size_t> next{0};
+    std::mutex error_mutex;
+    error_index = 0;
+
+    const auto work = [&]() {
+        sourcemeta::blaze::Evaluator evaluator;
+        for (std::size_t start = next.fetch_add(chunk); start < instances.size(); start = next.fetch_add(chunk)) {
+            const auto end = std::min(start + chunk, instances.size());
+            for (std::size_t i = start; i < end; i++) {
+                try {
+                    if (parsed[i] != nullptr) {
+                        results[i] = evaluator.validate(schema_template, *parsed[i]) ? 1 : 0;
+                        continue;
+                    }
+                    const auto instance = parse_json_with_limits(instances[i], limits);
+                    results[i]          = evaluator.validate(schema_template, instance) ? 1 : 0;
+                } catch (const std::exception &e) {
+                    const std::lock_guard<std::mutex> lock{error_mutex};
+                    if (error_index == 0 || i + 1 < error_index) {
+                        error_index = i + 1;
+                        error       = e.what();
+                    }
+                }
+            }
+        }
+    };
+
+    auto batch = std::make_shared<Batch>();
+    try {
+        for (std::size_t i = 1; i < threads && i * chunk < instances.size(); i++) {
+            worker_pool().submit([batch, &work]() {
+                {
+                    const std::lock_guard<std::mutex> lock{batch->mutex};
+                    if (batch->closed) {
+                        return;
+                    }
+                    batch->running++;
+                }
+                work();
+                {
+                    const std::lock_guard<std::mutex> lock{batch->mutex};
+                    batch->running--;
+                }
+                batch->idle.notify_all();
+            });
+        }
+    } catch (...) {
+        // Could not queue every task; carry on with the ones we have
+    }
+
+    // The calling thread is one of the workers, then waits for the tasks
+    // still running. Tasks that never started are left to find the batch
+    // closed.
+    work();
+    std::unique_lock<std::mutex> lock{batch->mutex};
+    batch->closed = true;
+    batch->idle.wait(lock, [&batch]() { return batch->running == 0; });
+}
+
+/**
+ * @brief Validate an array of JSON strings on multiple OS threads.
+ *
+ * Implements `CompiledSchema:validate_json_parallel(instance_json_strings[, options]) -> results, invalid_count`
+ *
+ * The strings are pinned by the argument table while parsing and evaluation
+ * fan out over a worker pool with one `Evaluator` per thread and the shared,
+ * immutable template. Elements may also be `Instance` values, which are
+ * evaluated without parsing. The Lua state is only touched before the workers start
+ * and after they finish. Results come back in input order with the same shape
+ * as `CompiledSchema:validate_json_many`.
+ *
+ * Options:
+ * - `threads`: number of threads including the caller (default: hardware concurrency, 0 = default)
+ * - `failures_only`: as for `CompiledSchema:validate_json_many`
+ *
+ * @param L Lua state
+ * @return 2 (results table and number of invalid instances on stack)
+ * @throws Lua error naming the first element that fails to parse
+ */
+static int compiled_schema_validate_json_parallel(lua_State *L) {
+    auto *compiled = check_compiled_schema(L, 1);
+    luaL_checktype(L, 2, LUA_TTABLE);
+
+    bool failures_only{false};
+    std::size_t threads{0};
+    if (!lua_isnoneornil(L, 3)) {
+        luaL_checktype(L, 3, LUA_TTABLE);
+        std::string options_error;
+        if (!parse_batch_options_table(L, 3, failures_only, options_error) ||
+            !parse_size_option(L, lua_absindex(L, 3), "threads", threads, options_error)) {
+            return luaL_error(L, "%s", options_error.c_str());
+        }
+    }
+
+    const auto count = static_cast<std::size_t>(lua_rawlen(L, 2));
+    if (count > static_cast<std::size_t>(INT_MAX)) {
+        return luaL_error(L, "Batch is too large (%d instances maximum)", INT_MAX);
+    }
+
+    if (!lua_checkstack(L, 4)) {
+        return luaL_error(L, "Cannot grow Lua stack for batch results");
+    }
+
+    try {
+        // Strings and Instances stay referenced by the argument table, so the
+        // views and pointers remain valid while the workers run
+        std::vector<std::string_view> instances;
+        std::vector<const sourcemeta::core::JSON *> parsed(count, nullptr);
+        instances.reserve(count);
+        for (std::size_t i = 1; i <= count; i++) {
+            lua_rawgeti(L, 2, static_cast<lua_Integer>(i));
+            if (const auto *instance = test_instance(L, -1); instance != nullptr) {
+                parsed[i - 1] = instance;
+                instances.emplace_back();
+                lua_pop(L, 1);
+                continue;
+            }
+            if (lua_type(L, -1) != LUA_TSTRING) {
+                throw std::runtime_error("instances[" + std::to_string(i) + "] must be a string (found " +
+                                         luaL_typename(L, -1) + ")");
+            }
+            std::size_t instance_len{0};
+            const char *instance_str = lua_tolstring(L, -1, &instance_len);
+            instances.emplace_back(instance_str, instance_len);
+            lua_pop(L, 1);
+        }
+
+        if (threads == 0) {
+            threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+        }
+        threads = std::clamp<std::size_t>(threads, 1, std::max<std::size_t>(count, 1));
+
+        std::vector<char> results(count, 0);
+        std::size_t error_index{0};
+        std::string error;
+        validate_json_strings_parallel(*compiled->schema_template, instances, parsed, parse_limits_of(*compiled),
+                                       threads, results, error_index, error);
+        if (error_index != 0) {
+            throw std::runtime_error("instances[" + std::to_string(error_index) + "]: " + error);
+        }
+
+        lua_createtable(L, failures_only ? 0 : static_cast<int>(count), 0);
+        lua_Integer invalid_count{0};
+        for (std::size_t i = 0; i < count; i++) {
+            const bool result = results[i] != 0;
+            if (!result) {
+                invalid_count++;
+            }
+
+            if (!failures_only) {
+                lua_pushboolean(L, result);
+                lua_rawseti(L, -2, static_cast<lua_Integer>(i + 1));
+            } else if (!result) {
+                lua_pushinteger(L, static_cast<lua_Integer>(i + 1));
+                lua_rawseti(L, -2, invalid_count);
+            }
+        }
+
+        lua_pushinteger(L, invalid_count);
+        return 2; // Return (results, invalid_count)
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+// Parse the optional options table accepted by `validate_ndjson`.
+//
+// Supported keys:
+// - `max_failures`: stop after this many invalid records (0 = unlimited)
+// - `failures`: when false, only count records instead of listing failures
+static bool parse_ndjson_options_table(lua_State *L, const int index, std::size_t &max_failures,
+                                       bool &report_failures, std::string &error) {
+    const int abs_index = lua_absindex(L, index);
+    return validate_options_table_keys(L, abs_index, error) &&
+           parse_size_option(L, abs_index, "max_failures", max_failures, error) &&
+           parse_boolean_option(L, abs_index, "failures", report_failures, error);
+}
+
+/**
+ * @brief Validate a buffer of newline-delimited JSON records.
+ *
+ * Implements `CompiledSchema:validate_ndjson(buffer[, options]) -> summary`
+ *
+ * Records are parsed one after another straight from the Lua string, with the
+ * schema's parse limits, and validated with the schema's evaluator. No
+ * Lua value is created per record; only invalid records produce an entry in
+ * `summary.failures`. Blank lines are skipped and a trailing `\r` is ignored.
+ * Malformed records count as invalid and carry the parse error.
+ *
+ * The summary table holds `records`, `valid`, `invalid`, `stopped` (true if
+ * `max_failures` cut the scan short) and `failures`, an array of
+ * `{ line = n, position = byte, error = message | nil }` where `position` is
+ * the 1-based byte position of the record in `buffer`.
+ *
+ * @param L Lua state (expects a CompiledSchema at index 1, a string at index 2, optional options at index 3)
+ * @return 1 (summary table on stack)
+ */
+static int compiled_schema_validate_ndjson(lua_State *L) {
+    auto *compiled = check_compiled_schema(L, 1);
+    std::size_t buffer_len{0};
+    const char *buffer = luaL_checklstring(L, 2, &buffer_len);
+
+    std::size_t max_failures{0};
+    bool report_failures{true};
+    if (!lua_isnoneornil(L, 3)) {
+        luaL_checktype(L, 3, LUA_TTABLE);
+        std::string options_error;
+        if (!parse_ndjson_options_table(L, 3, max_failures, report_failures, options_error)) {
+            return luaL_error(L, "%s", options_error.c_str());
+        }
+    }
+
+    // Summary + failures + failure entry + field value
+    if (!lua_checkstack(L, 6)) {
+        return luaL_error(L, "Cannot grow Lua stack for NDJSON summary");
+    }
+
+    lua_createtable(L, 0, 5);
+    lua_newtable(L);
+    const int failures_index = lua_gettop(L);
+
+    try {
+        lua_Integer records{0};
+        lua_Integer invalid{0};
+        lua_Integer line{0};
+        bool stopped{false};
+        // Limits apply to every record, not to the whole buffer
+        const auto limits = parse_limits_of(*compiled);
+
+        const char *const end = buffer + buffer_len;
+        const char *cursor    = buffer;
+        while (cursor < end) {
+            const auto *newline = static_cast<const char *>(std::memchr(cursor, '\n', end - cursor));
+            const char *line_end = newline == nullptr ? end : newline;
+            const char *record   = cursor;
+            cursor               = newline == nullptr ? end : newline + 1;
+            line++;
+
+            const char *record_end = line_end;
+            if (record_end > record && record_end[-1] == '\r') {
+                record_end--;
+            }
+            const char *first = record;
+            while (first < record_end && (*first == ' ' || *first == '\t')) {
+                first++;
+            }
+            if (first == record_end) {
+                continue;
+            }
+
+            if (max_failures > 0 && static_cast<std::size_t>(invalid) >= max_failures) {
+                stopped = true;
+                break;
+            }
+
+            records++;
+            bool valid{false};
+            std::string error;
+            try {
+                StatsTimer timer{compiled->stats.get()};
+                const auto instance = parse_json_with_limits(
+                    std::string_view{record, static_cast<std::size_t>(record_end - record)}, limits);
+                timer.lap(&SchemaStats::parse_ns);
+                valid = compiled->evaluator.validate(*compiled->schema_template, instance);
+                timer.lap(&SchemaStats::evaluation_ns);
+                timer.finish(valid);
+            } catch (const std::exception &e) {
+                error = e.what();
+            }
+
+            if (valid) {
+                continue;
+            }
+
+            invalid++;
+            if (report_failures) {
+                lua_createtable(L, 0, 3);
+                lua_pushinteger(L, line);
+                lua_setfield(L, -2, "line");
+                lua_pushinteger(L, static_cast<lua_Integer>(record - buffer) + 1);
+                lua_setfield(L, -2, "position");
+                if (!error.empty()) {
+                    lua_pushlstring(L, error.data(), error.size());
+                    lua_setfield(L, -2, "error");
+                }
+                lua_rawseti(L, failures_index, invalid);
+            }
+        }
+
+        lua_setfield(L, -2, "failures");
+
+        lua_pushinteger(L, records);
+        lua_setfield(L, -2, "records");
+
+        lua_pushinteger(L, records - invalid);
+        lua_setfield(L, -2, "valid");
+
+        lua_pushinteger(L, invalid);
+        lua_setfield(L, -2, "invalid");
+
+        lua_pushboolean(L, stopped ? 1 : 0);
+        lua_setfield(L, -2, "stopped");
+
+        return 1;
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief State shared between a `ValidationJob` userdata and its worker task.
+ *
+ * The instance text is copied into the job, and an `Instance` document is
+ * shared with it, so the worker never touches Lua memory. On POSIX systems
+ * the job also owns a file descriptor (an eventfd on Linux, the read end of
+ * a pipe elsewhere) that becomes readable once the job is done, for hosts
+ * that wait on descriptors.
+ */
+struct ValidationJob {
+    std::string instance;
+    std::shared_ptr<const sourcemeta::core::JSON> document;
+    std::mutex mutex;
+    std::condition_variable finished;
+    bool done{false};
+    bool valid{false};
+    std::string error;
+    int read_fd{-1};
+    int write_fd{-1};
+
+    ValidationJob(const char *data, const std::size_t size) : instance{data, size} {
+#if defined(__linux__)
+        this->read_fd  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        this->write_fd = this->read_fd;
+#elif !defined(_WIN32)
+        int fds[2];
+        if (pipe(fds) == 0) {
+            fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+            fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+            fcntl(fds[0], F_SETFL, O_NONBLOCK);
+            this->read_fd  = fds[0];
+            this->write_fd = fds[1];
+        }
+#endif
+    }
+
+    ValidationJob(const ValidationJob &)            = delete;
+    ValidationJob &operator=(const ValidationJob &) = delete;
+
+    ~ValidationJob() {
+#if !defined(_WIN32)
+        if (this->read_fd >= 0) {
+            close(this->read_fd);
+        }
+        if (this->write_fd >= 0 && this->write_fd != this->read_fd) {
+            close(this->write_fd);
+        }
+#endif
+    }
+
+    auto complete(const bool result, std::string message) -> void {
+        {
+            const std::lock_guard<std::mutex> lock{this->mutex};
+            this->done  = true;
+            this->valid = result;
+            this->error = std::move(message);
+            // The instance is no longer needed; release it early
+            std::string{}.swap(this->instance);
+            this->document.reset();
+        }
+        this->finished.notify_all();
+#if defined(__linux__)
+        if (this->write_fd >= 0) {
+            const std::uint64_t one{1};
+            (void)!write(this->write_fd, &one, sizeof(one));
+        }
+#elif !defined(_WIN32)
+        if (this->write_fd >= 0) {
+            const char one{1};
+            (void)!write(this->write_fd, &one, sizeof(one));
+        }
+#endif
+    }
+};
+
+struct ValidationJobUserdata {
+    std::shared_ptr<ValidationJob> job;
+};
+
+// Validate and extract the job from a `ValidationJob` userdata at `index`.
+// Raises a Lua error if the type does not match.
+static auto check_validation_job(lua_State *L, const int index) -> ValidationJob * {
+    auto *ud = static_cast<ValidationJobUserdata *>(luaL_checkudata(L, index, LUABLAZE_VALIDATIONJOB_MT));
+    luaL_argcheck(L, ud != nullptr && ud->job != nullptr, index, "ValidationJob expected");
+    return ud->job.get();
+}
+
+// Lua GC metamethod: drop the userdata's reference to the job. A job still
+// running keeps itself alive through its worker task.
+static int validation_job_gc(lua_State *L) {
+    auto *ud = static_cast<ValidationJobUserdata *>(luaL_testudata(L, 1, LUABLAZE_VALIDATIONJOB_MT));
+    if (ud != nullptr) {
+        ud->job.reset();
+    }
+    return 0;
+}
+
+/**
+ * @brief Validate a JSON string on a background thread.
+ *
+ * Implements `CompiledSchema:validate_json_async(instance_json_string) -> ValidationJob`
+ *
+ * The string is copied and parsed and evaluated on the process-wide worker
+ * pool with the schema's shared template (an `Instance` is shared with the
+ * job and evaluated without parsing), so the calling thread (e.g. an
+ * event loop) is never blocked. The returned job can be polled with
+ * `job:done()`, waited on with `job:wait()` or through the descriptor
+ * returned by `job:fd()`, and its outcome read with `job:result()`.
+ *
+ * @param L Lua state (expects a CompiledSchema at index 1 and a JSON string at index 2)
+ * @return 1 (ValidationJob userdata on stack)
+ */
+static int compiled_schema_validate_json_async(lua_State *L) {
+    auto *compiled     = check_compiled_schema(L, 1);
+    const auto *parsed = test_instance_object(L, 2);
+    std::size_t instance_len{0};
+    const char *instance_str = parsed != nullptr ? "" : luaL_checklstring(L, 2, &instance_len);
+
+    try {
+        auto *ud = static_cast<ValidationJobUserdata *>(lua_newuserdata(L, sizeof(ValidationJobUserdata)));
+        new (ud) ValidationJobUserdata{};
+        luaL_getmetatable(L, LUABLAZE_VALIDATIONJOB_MT);
+        lua_setmetatable(L, -2);
+
+        ud->job = std::make_shared<ValidationJob>(instance_str, instance_len);
+        if (parsed != nullptr) {
+            ud->job->document = parsed->value;
+        }
+        worker_pool().submit(
+            [job = ud->job, schema_template = compiled->schema_template, limits = parse_limits_of(*compiled)]() {
+                static thread_local sourcemeta::blaze::Evaluator evaluator;
+                try {
+                    if (job->document != nullptr) {
+                        job->complete(evaluator.validate(*schema_template, *job->document), {});
+                        return;
+                    }
+                    const auto instance = parse_json_with_limits(job->instance, limits);
+                    job->complete(evaluator.validate(*schema_template, instance), {});
+                } catch (const std::exception &e) {
+                    job->complete(false, e.what());
+                } catch (...) {
+                    job->complete(false, "unknown error");
+                }
+            });
+        return 1;
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Check whether an asynchronous validation has finished.
+ *
+ * Implements `ValidationJob:done() -> boolean`
+ *
+ * @param L Lua state
+ * @return 1 (boolean on stack)
+ */
+static int validation_job_done(lua_State *L) {
+    auto *job = check_validation_job(L, 1);
+    const std::lock_guard<std::mutex> lock{job->mutex};
+    lua_pushboolean(L, job->done ? 1 : 0);
+    return 1;
+}
+
+/**
+ * @brief Block until an asynchronous validation finishes.
+ *
+ * Implements `ValidationJob:wait([timeout_seconds]) -> boolean`
+ *
+ * Blocks the calling OS thread; event-loop hosts should poll `done()` or wait
+ * on `fd()` instead.
+ *
+ * @param L Lua state (optional timeout in seconds at index 2; nil waits forever)
+ * @return 1 (true if the job finished, false on timeout)
+ */
+static int validation_job_wait(lua_State *L) {
+    // Longer waits would overflow the clock's duration; treat them (and
+    // math.huge) as waiting forever
+    constexpr lua_Number longest_wait = 1e9;
+
+    auto *job                = check_validation_job(L, 1);
+    const bool no_timeout    = lua_isnoneornil(L, 2);
+    const lua_Number timeout = no_timeout ? 0 : luaL_checknumber(L, 2);
+    luaL_argcheck(L, no_timeout || timeout >= 0, 2, "must be >= 0");
+    const bool forever = no_timeout || timeout > longest_wait;
+
+    std::unique_lock<std::mutex> lock{job->mutex};
+    if (forever) {
+        job->finished.wait(lock, [job]() { return job->done; });
+    } else {
+        job->finished.wait_for(lock, std::chrono::duration<double>(timeout), [job]() { return job->done; });
+    }
+    lua_pushboolean(L, job->done ? 1 : 0);
+    return 1;
+}
+
+/**
+ * @brief Return the outcome of an asynchronous validation.
+ *
+ * Implements `ValidationJob:result() -> boolean`
+ *
+ * Waits for the job if it is still running.
+ *
+ * @param L Lua state
+ * @return 1 (boolean validation result on stack)
+ * @throws Lua error if the instance could not be parsed
+ */
+static int validation_job_result(lua_State *L) {
+    auto *job = check_validation_job(L, 1);
+    bool valid{false};
+    std::string error;
+    {
+        std::unique_lock<std::mutex> lock{job->mutex};
+        job->finished.wait(lock, [job]() { return job->done; });
+        valid = job->valid;
+        error = job->error;
+    }
+
+    if (!error.empty()) {
+        return luaL_error(L, "%s", error.c_str());
+    }
+    lua_pushboolean(L, valid ? 1 : 0);
+    return 1;
+}
+
+/**
+ * @brief Return a file descriptor that becomes readable when the job is done.
+ *
+ * Implements `ValidationJob:fd() -> integer | nil`
+ *
+ * The descriptor is owned by the job and closed when the job is collected.
+ * Not available on Windows.
+ *
+ * @param L Lua state
+ * @return 1 (descriptor or nil on stack)
+ */
+static int validation_job_fd(lua_State *L) {
+    auto *job = check_validation_job(L, 1);
+    if (job->read_fd < 0) {
+        lua_pushnil(L);
+    } else {
+        lua_pushinteger(L, static_cast<lua_Integer>(job->read_fd));
+    }
+    return 1;
+}
+
+/**
+ * @brief A converted instance kept up to date through edits.
+ *
+ * Created by `CompiledSchema:track()`. Edits are applied to the stored
+ * instance in place, so each one only converts the value it writes. The
+ * result of the last validation is kept until the next edit. With a
+ * decomposition, the results of the shape and of every top-level property
+ * are kept too, and an edit only discards those its path can affect.
+ *
+ * @var schema_template Template shared with the schema the document was created from
+ * @var decomposition Decomposition shared with the schema, or null to always evaluate the whole template
+ * @var evaluator Evaluator reused across validations
+ * @var instance Current instance
+ * @var max_array_length Maximum array length when converting written values
+ * @var max_recursion_depth Maximum recursion depth when converting written values
+ * @var scratch Conversion scratch state reused across edits
+ * @var valid Result of the last validation, or empty if the instance changed since
+ * @var shape_valid Result of the decomposition shape, or empty if the property names may have changed since
+ * @var property_valid Results of the top-level properties evaluated since they were last edited
+ */
+struct TrackedDocument {
+    std::shared_ptr<const sourcemeta::blaze::Template> schema_template;
+    std::shared_ptr<const Decomposition> decomposition;
+    sourcemeta::blaze::Evaluator evaluator;
+    sourcemeta::core::JSON instance{nullptr};
+    std::size_t max_array_length;
+    std::size_t max_recursion_depth;
+    ConversionScratch scratch;
+    std::optional<bool> valid;
+    std::optional<bool> shape_valid;
+    std::unordered_map<std::string, bool> property_valid;
+};
+
+struct TrackedDocumentUserdata {
+    TrackedDocument *ptr;
+};
+
+// Validate and extract a `TrackedDocument*` from a Lua userdata at `index`.
+// Raises a Lua error if the type does not match.
+static auto check_tracked_document(lua_State *L, const int index) -> TrackedDocument * {
+    auto *ud = static_cast<TrackedDocumentUserdata *>(luaL_checkudata(L, index, LUABLAZE_TRACKEDDOCUMENT_MT));
+    luaL_argcheck(L, ud != nullptr && ud->ptr != nullptr, index, "TrackedDocument expected");
+    return ud->ptr;
+}
+
+// Lua GC metamethod: destroy the document stored inside the userdata.
+static int tracked_document_gc(lua_State *L) {
+    auto *ud = static_cast<TrackedDocumentUserdata *>(luaL_testudata(L, 1, LUABLAZE_TRACKEDDOCUMENT_MT));
+    if (ud != nullptr && ud->ptr != nullptr) {
+        delete ud->ptr;
+        ud->ptr = nullptr;
+    }
+    return 0;
+}
+
+// Split an RFC 6901 JSON Pointer into its unescaped reference tokens.
+// Throws on pointers that neither are empty nor start with '/'.
+static auto parse_json_pointer(const std::string_view pointer) -> std::vector<std::string> {
+    std::vector<std::string> tokens;
+    if (pointer.empty()) {
+        return tokens;
+    }
+    if (pointer.front() != '/') {
+        throw std::runtime_error("Invalid JSON Pointer \"" + std::string{pointer} + "\": must start with '/'");
+    }
+
+    std::string token;
+    for (std::size_t position = 1; position <= pointer.size(); ++position) {
+        if (position == pointer.size() || pointer[position] == '/') {
+            tokens.push_back(std::move(token));
+            token.clear();
+        } else if (pointer[position] != '~') {
+            token.push_back(pointer[position]);
+        } else if (position + 1 < pointer.size() && (pointer[position + 1] == '0' || pointer[position + 1] == '1')) {
+            token.push_back(pointer[++position] == '0' ? '~' : '/');
+        } else {
+            throw std::runtime_error("Invalid JSON Pointer \"" + std::string{pointer} + "\": bad '~' escape");
+        }
+    }
+    return tokens;
+}
+
+// Parse an array reference token. With `allow_end`, "-" and `size` itself
+// name the position after the last element. Throws if out of range.
+static auto parse_array_index(const std::string &token, const std::size_t size, const bool allow_end)
+    -> std::size_t {
+    if (allow_end && token == "-") {
+        return size;
+    }
+
+    const bool digits = !token.empty() && std::all_of(token.begin(), token.end(), [](const char character) {
+        return character >= '0' && character <= '9';
+    });
+    if (!digits || (token.size() > 1 && token.front() == '0') || token.size() > 19) {
+        throw std::runtime_error("Invalid array index \"" + token + "\"");
+    }
+
+    const auto index = static_cast<std::size_t>(std::stoull(token));
+    if (index > size || (index == size && !allow_end)) {
+        throw std::runtime_error("Array index " + token + " is out of range");
+    }
+    return index;
+}
+
+// Resolve the first `count` tokens inside `root`, or null if any of them
+// is missing. `Document` is `JSON` or `const JSON`.
+template <typename Document>
+static auto find_json_pointer(Document &root, const std::vector<std::string> &tokens, const std::size_t count)
+    -> Document * {
+    auto *current = &root;
+    for (std::size_t position = 0; position < count; ++position) {
+        const auto &token = tokens[position];
+        if (current->is_object()) {
+            if (!current->defines(token)) {
+                return nullptr;
+            }
+            current = &current->at(token);
+        } else if (current->is_array()) {
+            try {
+                current = &current->at(parse_array_index(token, current->size(), false));
+            } catch (const std::runtime_error &) {
+                return nullptr;
+            }
+        } else {
+            return nullptr;
+        }
+    }
+    return current;
+}
+
+// The container holding the value `tokens` points to. Throws if it does
+// not exist, as no edit creates intermediate containers.
+static auto parent_of(sourcemeta::core::JSON &root, const std::vector<std::string> &tokens,
+                      const std::string_view pointer) -> sourcemeta::core::JSON & {
+    auto *parent = find_json_pointer(root, tokens, tokens.size() - 1);
+    if (parent == nullptr || (!parent->is_object() && !parent->is_array())) {
+        throw std::runtime_error("No container at the parent of \"" + std::string{pointer} + "\"");
+    }
+    return *parent;
+}
+
+// Discard the cached results of `document` that an edit of the value at
+// `tokens` may change. Only edits of the root or of a top-level property
+// can change the property names.
+static auto invalidate_tracked(TrackedDocument &document, const std::vector<std::string> &tokens) -> void {
+    document.valid.reset();
+    if (tokens.empty()) {
+        document.shape_valid.reset();
+        document.property_valid.clear();
+        return;
+    }
+
+    if (tokens.size() == 1) {
+        document.shape_valid.reset();
+    }
+    document.property_valid.erase(tokens.front());
+}
+
+// Evaluate `document`, reusing the cached results of the parts of its
+// decomposition that no edit discarded.
+static auto evaluate_tracked(TrackedDocument &document) -> bool {
+    const auto *decomposition = document.decomposition.get();
+    if (decomposition == nullptr || !document.instance.is_object()) {
+        return document.evaluator.validate(*document.schema_template, document.instance);
+    }
+
+    if (!document.shape_valid.has_value()) {
+        document.shape_valid = document.evaluator.validate(*decomposition->shape, document.instance);
+    }
+    if (!document.shape_valid.value()) {
+        return false;
+    }
+
+    for (const auto &entry : document.instance.as_object()) {
+        auto match = document.property_valid.find(entry.first);
+        if (match == document.property_valid.end()) {
+            const auto &part = decomposition->part(entry.first);
+            const bool valid = part.schema_template == nullptr
+                                   ? part.value
+                                   : document.evaluator.validate(*part.schema_template, entry.second);
+            match            = document.property_valid.emplace(entry.first, valid).first;
+        }
+        if (!match->second) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief How to revert one edit of a `TrackedDocument:patch()` call.
+ *
+ * `Restore` puts `previous` back at `tokens`, `Erase` removes the value an
+ * edit inserted there and `Reinsert` inserts `previous` again at `tokens`.
+ * Array positions are always recorded as indexes, never as "-".
+ */
+struct PatchUndo {
+    enum class Action { Restore, Erase, Reinsert };
+    Action action;
+    std::vector<std::string> tokens;
+    sourcemeta::core::JSON previous{nullptr};
+};
+
+// Write `value` at `tokens` with JSON Patch "add" semantics: replace an
+// object member or the root, insert into an array.
+static auto json_pointer_add(sourcemeta::core::JSON &root, std::vector<std::string> tokens,
+                             const std::string_view pointer, sourcemeta::core::JSON &&value) -> PatchUndo {
+    if (tokens.empty()) {
+        PatchUndo undo{PatchUndo::Action::Restore, std::move(tokens), std::move(root)};
+        root = std::move(value);
+        return undo;
+    }
+
+    auto &parent = parent_of(root, tokens, pointer);
+    if (parent.is_object()) {
+        const auto &key = tokens.back();
+        if (parent.defines(key)) {
+            PatchUndo undo{PatchUndo::Action::Restore, tokens, std::move(parent.at(key))};
+            parent.at(key) = std::move(value);
+            return undo;
+        }
+        parent.assign(key, std::move(value));
+        return PatchUndo{PatchUndo::Action::Erase, std::move(tokens), sourcemeta::core::JSON{nullptr}};
+    }
+
+    const auto index = parse_array_index(tokens.back(), parent.size(), true);
+    parent.insert(parent.as_array().cbegin() + static_cast<std::ptrdiff_t>(index), std::move(value));
+    tokens.back() = std::to_string(index);
+    return PatchUndo{PatchUndo::Action::Erase, std::move(tokens), sourcemeta::core::JSON{nullptr}};
+}
+
+// Remove the value at `tokens`, moving it into the returned undo record.
+// Throws if there is no such value.
+static auto json_pointer_remove(sourcemeta::core::JSON &root, std::vector<std::string> tokens,
+                                const std::string_view pointer) -> PatchUndo {
+    if (tokens.empty()) {
+        throw std::runtime_error("Cannot remove the document root");
+    }
+    if (find_json_pointer(root, tokens, tokens.size()) == nullptr) {
+        throw std::runtime_error("No value at \"" + std::string{pointer} + "\"");
+    }
+
+    auto &parent = parent_of(root, tokens, pointer);
+    if (parent.is_object()) {
+        auto previous = std::move(parent.at(tokens.back()));
+        parent.erase(tokens.back());
+        return PatchUndo{PatchUndo::Action::Reinsert, std::move(tokens), std::move(previous)};
+    }
+
+    const auto index = parse_array_index(tokens.back(), parent.size(), false);
+    auto previous    = std::move(parent.at(index));
+    parent.erase(parent.as_array().cbegin() + static_cast<std::ptrdiff_t>(index));
+    return PatchUndo{PatchUndo::Action::Reinsert, std::move(tokens), std::move(previous)};
+}
+
+// Revert one edit recorded by `json_pointer_add` / `json_pointer_remove`.
+static auto json_pointer_undo(sourcemeta::core::JSON &root, PatchUndo &undo) -> void {
+    if (undo.tokens.empty()) {
+        root = std::move(undo.previous);
+        return;
+    }
+
+    // Undo records are reverted newest first, so the parent an edit worked
+    // on is back in place; a missing one leaves nothing to revert
+    auto *target = find_json_pointer(root, undo.tokens, undo.tokens.size() - 1);
+    if (target == nullptr) {
+        return;
+    }
+
+    auto &parent     = *target;
+    const auto &last = undo.tokens.back();
+    switch (undo.action) {
+        case PatchUndo::Action::Restore:
+            (parent.is_object() ? parent.at(last) : parent.at(std::stoull(last))) = std::move(undo.previous);
+            break;
+        case PatchUndo::Action::Erase:
+            if (parent.is_object()) {
+                parent.erase(last);
+            } else {
+                parent.erase(parent.as_array().cbegin() + static_cast<std::ptrdiff_t>(std::stoull(last)));
+            }
+            break;
+        case PatchUndo::Action::Reinsert:
+            if (parent.is_object()) {
+                parent.assign(last, std::move(undo.previous));
+            } else {
+                parent.insert(parent.as_array().cbegin() + static_cast<std::ptrdiff_t>(std::stoull(last)),
+                              std::move(undo.previous));
+            }
+            break;
+    }
+}
+
+// Convert the Lua value at `index` for writing into `document`.
+static auto tracked_value_to_json(lua_State *L, TrackedDocument *document, const int index)
+    -> sourcemeta::core::JSON {
+    document->scratch.reset();
+    sourcemeta::core::JSON value{nullptr};
+    std::string error;
+    if (!lua_value_to_json(L, index, document->scratch, document->max_array_length, document->max_recursion_depth, 0,
+                           value, error)) {
+        throw std::runtime_error(error);
+    }
+    return value;
+}
+
+// Apply one JSON Patch operation (the table at `index`) to `document`,
+// appending what is needed to revert it to `undo`. Fields are read with
+// raw access: an `__index` metamethod raising would unwind past the rollback.
+static void apply_patch_operation(lua_State *L, TrackedDocument *document, const int index,
+                                  std::vector<PatchUndo> &undo) {
+    const auto field = [L, index](const char *name) -> std::string {
+        lua_pushstring(L, name);
+        lua_rawget(L, index);
+        if (lua_type(L, -1) != LUA_TSTRING) {
+            lua_pop(L, 1);
+            throw std::runtime_error(std::string{"Patch operation field '"} + name + "' must be a string");
+        }
+        std::size_t length{0};
+        const char *data = lua_tolstring(L, -1, &length);
+        std::string value{data, length};
+        lua_pop(L, 1);
+        return value;
+    };
+    // Operations need a value field, but nil is a valid (null) value
+    const auto value = [L, index, document]() -> sourcemeta::core::JSON {
+        lua_pushliteral(L, "value");
+        lua_rawget(L, index);
+        auto json = tracked_value_to_json(L, document, -1);
+        lua_pop(L, 1);
+        return json;
+    };
+
+    const auto op   = field("op");
+    const auto path = field("path");
+    auto tokens     = parse_json_pointer(path);
+    auto &root      = document->instance;
+
+    if (op == "add") {
+        invalidate_tracked(*document, tokens);
+        undo.push_back(json_pointer_add(root, std::move(tokens), path, value()));
+    } else if (op == "remove") {
+        invalidate_tracked(*document, tokens);
+        undo.push_back(json_pointer_remove(root, std::move(tokens), path));
+    } else if (op == "replace") {
+        auto *target = find_json_pointer(root, tokens, tokens.size());
+        if (target == nullptr) {
+            throw std::runtime_error("No value at \"" + path + "\"");
+        }
+        auto replacement = value();
+        invalidate_tracked(*document, tokens);
+        undo.push_back(PatchUndo{PatchUndo::Action::Restore, std::move(tokens), std::move(*target)});
+        *target = std::move(replacement);
+    } else if (op == "test") {
+        const auto *target = find_json_pointer(root, tokens, tokens.size());
+        if (target == nullptr || !(*target == value())) {
+            throw std::runtime_error("Patch test failed at \"" + path + "\"");
+        }
+    } else if (op == "move" || op == "copy") {
+        const auto from    = field("from");
+        auto from_tokens   = parse_json_pointer(from);
+        const auto *source = find_json_pointer(root, from_tokens, from_tokens.size());
+        if (source == nullptr) {
+            throw std::runtime_error("No value at \"" + from + "\"");
+        }
+        if (op == "copy") {
+            invalidate_tracked(*document, tokens);
+            undo.push_back(json_pointer_add(root, std::move(tokens), path, sourcemeta::core::JSON{*source}));
+            return;
+        }
+        if (tokens.size() > from_tokens.size() &&
+            std::equal(from_tokens.begin(), from_tokens.end(), tokens.begin())) {
+            throw std::runtime_error("Cannot move \"" + from + "\" into its own child \"" + path + "\"");
+        }
+        invalidate_tracked(*document, from_tokens);
+        invalidate_tracked(*document, tokens);
+        undo.push_back(json_pointer_remove(root, std::move(from_tokens), from));
+        undo.push_back(json_pointer_add(root, std::move(tokens), path, sourcemeta::core::JSON{undo.back().previous}));
+    } else {
+        throw std::runtime_error("Unsupported patch operation \"" + op + "\"");
+    }
+}
+
+/**
+ * @brief Track a document for repeated validation after small edits.
+ *
+ * Implements `CompiledSchema:track(instance_table) -> TrackedDocument`
+ *
+ * Converts the table once (in full, ignoring `project`) and keeps the
+ * instance, sharing the schema's template and conversion limits. Later
+ * edits only convert the values they write. An `Instance` is copied, since
+ * the tracked document is edited in place.
+ *
+ * @param L Lua state (expects a CompiledSchema at index 1, a table or Instance at index 2)
+ * @return 1 (TrackedDocument userdata on stack)
+ * @throws Lua error on conversion failure
+ */
+static int compiled_schema_track(lua_State *L) {
+    auto *compiled     = check_compiled_schema(L, 1);
+    const auto *parsed = test_instance(L, 2);
+    if (parsed == nullptr) {
+        luaL_checktype(L, 2, LUA_TTABLE);
+    }
+
+    auto *ud = static_cast<TrackedDocumentUserdata *>(lua_newuserdata(L, sizeof(TrackedDocumentUserdata)));
+    ud->ptr  = nullptr;
+    luaL_getmetatable(L, LUABLAZE_TRACKEDDOCUMENT_MT);
+    lua_setmetatable(L, -2);
+
+    try {
+        ud->ptr = new TrackedDocument{compiled->schema_template,
+                                      compiled->decomposition,
+                                      sourcemeta::blaze::Evaluator{},
+                                      sourcemeta::core::JSON{nullptr},
+                                      compiled->max_array_length,
+                                      compiled->max_recursion_depth,
+                                      ConversionScratch{},
+                                      std::nullopt,
+                                      std::nullopt,
+                                      {}};
+        ud->ptr->instance = parsed != nullptr ? sourcemeta::core::JSON{*parsed} : tracked_value_to_json(L, ud->ptr, 2);
+        return 1;
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Write a value into a tracked document.
+ *
+ * Implements `TrackedDocument:set(pointer, value)`
+ *
+ * `pointer` is a JSON Pointer (`""` is the whole document). Existing values
+ * are replaced; a missing object member is added and `"-"` (or the array
+ * length) appends to an array. The parent must already exist.
+ *
+ * @param L Lua state (expects a TrackedDocument at index 1, a pointer string at index 2, a value at index 3)
+ * @return 0
+ * @throws Lua error on an invalid pointer, a missing parent or a conversion failure
+ */
+static int tracked_document_set(lua_State *L) {
+    auto *document      = check_tracked_document(L, 1);
+    const char *pointer = luaL_checkstring(L, 2);
+    luaL_checkany(L, 3);
+
+    try {
+        auto tokens  = parse_json_pointer(pointer);
+        auto value   = tracked_value_to_json(L, document, 3);
+        auto *target = find_json_pointer(document->instance, tokens, tokens.size());
+        if (target != nullptr) {
+            *target = std::move(value);
+        } else {
+            json_pointer_add(document->instance, tokens, pointer, std::move(value));
+        }
+        invalidate_tracked(*document, tokens);
+        return 0;
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Remove a value from a tracked document.
+ *
+ * Implements `TrackedDocument:remove(pointer) -> boolean`
+ *
+ * @param L Lua state (expects a TrackedDocument at index 1, a pointer string at index 2)
+ * @return 1 (true if a value was removed, false if there was none)
+ * @throws Lua error on an invalid pointer or when removing the root
+ */
+static int tracked_document_remove(lua_State *L) {
+    auto *document      = check_tracked_document(L, 1);
+    const char *pointer = luaL_checkstring(L, 2);
+
+    try {
+        auto tokens = parse_json_pointer(pointer);
+        if (!tokens.empty() && find_json_pointer(document->instance, tokens, tokens.size()) == nullptr) {
+            lua_pushboolean(L, 0);
+            return 1;
+        }
+        json_pointer_remove(document->instance, tokens, pointer);
+        invalidate_tracked(*document, tokens);
+        lua_pushboolean(L, 1);
+        return 1;
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Apply an RFC 6902 JSON Patch to a tracked document.
+ *
+ * Implements `TrackedDocument:patch(operations)`
+ *
+ * `operations` is an array of `{ op = ..., path = ..., value = ..., from = ... }`
+ * tables using the `add`, `remove`, `replace`, `move`, `copy` and `test`
+ * operations. The patch is atomic: if any operation fails, the operations
+ * before it are reverted and the document is left unchanged.
+ *
+ * @param L Lua state (expects a TrackedDocument at index 1, an operations array at index 2)
+ * @return 0
+ * @throws Lua error on a malformed or failing operation
+ */
+static int tracked_document_patch(lua_State *L) {
+    auto *document = check_tracked_document(L, 1);
+    luaL_checktype(L, 2, LUA_TTABLE);
+
+    std::vector<PatchUndo> undo;
+    const auto rollback = [document, &undo]() {
+        for (auto entry = undo.rbegin(); entry != undo.rend(); ++entry) {
+            json_pointer_undo(document->instance, *entry);
+        }
+    };
+    try {
+        const auto count = static_cast<std::size_t>(lua_rawlen(L, 2));
+        undo.reserve(count);
+        for (std::size_t position = 1; position <= count; ++position) {
+            lua_rawgeti(L, 2, static_cast<lua_Integer>(position));
+            if (lua_type(L, -1) != LUA_TTABLE) {
+                throw std::runtime_error("Patch operation " + std::to_string(position) + " must be a table");
+            }
+            try {
+                apply_patch_operation(L, document, lua_gettop(L), undo);
+            } catch (const std::exception &e) {
+                throw std::runtime_error("Patch operation " + std::to_string(position) + ": " + e.what());
+            }
+            lua_pop(L, 1);
+        }
+        return 0;
+    } catch (const std::exception &e) {
+        rollback();
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        rollback();
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Validate a tracked document.
+ *
+ * Implements `TrackedDocument:validate() -> boolean`
+ *
+ * Evaluates the stored instance without converting it again. The result is
+ * reused until the document is edited. For a schema created with
+ * `{ incremental = true }` that could be split, an object document only
+ * re-evaluates the top-level properties edited since the last call, plus
+ * the shape if property names may have changed.
+ *
+ * @param L Lua state (expects a TrackedDocument at index 1)
+ * @return 1 (boolean result on stack)
+ */
+static int tracked_document_validate(lua_State *L) {
+    auto *document = check_tracked_document(L, 1);
+
+    try {
+        if (!document->valid.has_value()) {
+            document->valid = evaluate_tracked(*document);
+        }
+        lua_pushboolean(L, document->valid.value());
+        return 1;
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Read a value from a tracked document.
+ *
+ * Implements `TrackedDocument:get([pointer]) -> value`
+ *
+ * @param L Lua state (expects a TrackedDocument at index 1, optional pointer string at index 2)
+ * @return 1 (the value converted to Lua, or nil if there is none)
+ * @throws Lua error on an invalid pointer
+ */
+static int tracked_document_get(lua_State *L) {
+    auto *document      = check_tracked_document(L, 1);
+    const char *pointer = luaL_optstring(L, 2, "");
+
+    try {
+        const auto tokens  = parse_json_pointer(pointer);
+        const auto *target = find_json_pointer(document->instance, tokens, tokens.size());
+        if (target == nullptr) {
+            lua_pushnil(L);
+            return 1;
+        }
+        std::string error;
+        if (!json_to_lua_value(L, *target, document->max_recursion_depth, 0, error)) {
+            throw std::runtime_error(error);
+        }
+        return 1;
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Serialize a tracked document.
+ *
+ * Implements `TrackedDocument:to_json() -> string`
+ *
+ * @param L Lua state (expects a TrackedDocument at index 1)
+ * @return 1 (JSON string on stack)
+ */
+static int tracked_document_to_json(lua_State *L) {
+    auto *document = check_tracked_document(L, 1);
+
+    try {
+        std::ostringstream stream;
+        sourcemeta::core::stringify(document->instance, stream);
+        const auto output = stream.str();
+        lua_pushlstring(L, output.data(), output.size());
+        return 1;
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+// Push a new `CompiledSchema` userdata wrapping `schema_template`, configured
+// with the limits in `options`. The mode and dialect are only recorded for
+// introspection; they must match how the template was compiled.
+static void push_compiled_schema(lua_State *L, std::shared_ptr<const sourcemeta::blaze::Template> schema_template,
+                                 const SchemaOptions &options,
+                                 std::shared_ptr<const Projection> projection       = nullptr,
+                                 std::shared_ptr<const Decomposition> decomposition = nullptr) {
+    // Capture mode and dialect names for introspection
+    const char *mode_name_ptr = (options.mode == sourcemeta::blaze::Mode::FastValidation) ? "Fast" : "Exhaustive";
+    const std::string dialect_name_str = options.default_dialect.value_or("auto");
+    const auto footprint               = measure_template(*schema_template);
+    // Only a template owned by this schema alone is freed when it is collected
+    const bool owns_template = schema_template.use_count() == 1;
+
+    auto *ud = static_cast<CompiledSchemaUserdata *>(lua_newuserdata(L, sizeof(CompiledSchemaUserdata)));
+    ud->ptr  = nullptr;
+    ud->ptr  = new CompiledSchema{std::move(schema_template),
+                                 sourcemeta::blaze::Evaluator{},
+                                 options.max_array_length,
+                                 options.max_depth,
+                                 options.max_input_bytes,
+                                 options.max_json_array_length,
+                                 options.max_string_length,
+                                 options.max_object_properties,
+                                 options.max_recursion_depth,
+                                 mode_name_ptr,
+                                 dialect_name_str,
+                                 options.cache,
+                                 options.compact,
+                                 footprint.instructions,
+                                 footprint.bytes,
+                                 ConversionScratch{},
+                                 options.stats ? std::make_unique<SchemaStats>() : nullptr,
+                                 std::move(projection),
+                                 std::move(decomposition)};
+    luaL_getmetatable(L, LUABLAZE_COMPILEDSCHEMA_MT);
+    lua_setmetatable(L, -2);
+
+    // The userdata itself is a pointer, so tell the collector about the
+    // template behind it as if it had been allocated from Lua
+    if (owns_template && footprint.bytes >= 1024) {
+        lua_gc(L, LUA_GCSTEP, static_cast<int>(std::min<std::size_t>(footprint.bytes / 1024, INT_MAX)));
+    }
+}
+
+/**
+ * @brief Compile a JSON Schema string into a reusable compiled schema object.
+ *
+ * Implements `luablaze.new(schema_json[, options]) -> CompiledSchema`
+ *
+ * Compiles a JSON Schema string into a Blaze template. Options can control:
+ * - `dialect`: JSON Schema dialect (e.g., "draft7", "draft2020-12", or a $schema URI)
+ * - `mode`: Compilation mode ("Fast" or "Exhaustive")
+ * - `max_array_length`: Maximum array length for Lua table conversion (default: 100000, 0 = unlimited)
+ * - `max_depth`: Maximum nesting depth for JSON parsing (default: 128, 0 = unlimited)
+ * - `max_input_bytes`: Maximum size of a JSON instance string or file (default: 0 = unlimited)
+ * - `max_json_array_length`: Maximum number of elements of a JSON array (default: 0 = unlimited)
+ * - `max_string_length`: Maximum length of a JSON string, in bytes (default: 0 = unlimited)
+ * - `max_object_properties`: Maximum number of properties of a JSON object (default: 0 = unlimited)
+ * - `cache`: Share the template through the process-wide template cache (default: false)
+ * - `registry`: `luablaze.registry()` holding schemas that `$ref`s may point to
+ * - `stats`: Collect runtime statistics for `CompiledSchema:stats()` (default: false)
+ * - `compact`: Drop keyword locations from the template (Fast mode only, default: false)
+ *   The detailed, `each_error*` and `profile` methods then raise an error.
+ * - `project`: Skip converting table fields the schema never observes (default: false)
+ * - `incremental`: Let `TrackedDocument:validate()` re-evaluate only the top-level properties edits touched
+ *   (default: false)
+ *
+ * @param L Lua state (expects schema_json_string at index 1, optional options table at index 2)
+ * @return 1 (CompiledSchema userdata on stack)
+ * @throws Lua error on parse or compilation failure
+ *
+ * @code{.lua}
+ * local schema = luablaze.new([[{"type": "string"}]])
+ * local schema2 = luablaze.new(schema_json, { dialect = "draft7", mode = "Exhaustive" })
+ * @endcode
+ */
+static int luablaze_new(lua_State *L) {
+    std::size_t schema_len{0};
+    const char *schema_str = luaL_checklstring(L, 1, &schema_len);
+
+    if (schema_len == 0) {
+        return luaL_error(L, "schema cannot be empty");
+    }
+
+    SchemaOptions options;
+
+    try {
+        // Supported call patterns:
+        //   new(schema)
+        //   new(schema, { dialect = "draft7", mode = "Exhaustive" })
+        //
+        // NOTE: Positional dialect arguments are not supported.
+        if (!lua_isnoneornil(L, 2)) {
+            if (lua_type(L, 2) != LUA_TTABLE) {
+                throw std::runtime_error("options_table must be a table");
+            }
+            std::string options_error;
+            if (!parse_options_table(L, 2, options, options_error)) {
+                throw std::runtime_error(options_error);
+            }
+        }
+
+        if (!lua_isnoneornil(L, 3)) {
+            throw std::runtime_error("luablaze.new expects (schema_json) or (schema_json, options_table)");
+        }
+
+        // Exhaustive mode exists for detailed output, which needs the keyword locations
+        if (options.compact && options.mode != sourcemeta::blaze::Mode::FastValidation) {
+            throw std::runtime_error("options.compact requires mode = \"Fast\"");
+        }
+
+        // The depth limit applies to the schema text even when the template
+        // is served from the cache
+        const auto schema_text = std::string_view{schema_str, schema_len};
+        check_json_limits(schema_text, ParseLimits{options.max_depth});
+
+        std::shared_ptr<const sourcemeta::blaze::Template> schema_template;
+        std::string cache_key;
+        if (options.cache) {
+            cache_key       = template_cache_key(schema_text, options);
+            schema_template = template_cache().find(cache_key);
+        }
+
+        // A cache hit still needs the schema itself for the projection and
+        // the decomposition
+        std::shared_ptr<const Projection> projection;
+        std::shared_ptr<const Decomposition> decomposition;
+        if (schema_template == nullptr || options.project || options.incremental) {
+            const auto schema = parse_json_with_depth_limit(schema_text, 0);
+            if (schema_template == nullptr) {
+                schema_template = compile_schema_template(schema, options);
+                if (options.cache) {
+                    template_cache().insert(std::move(cache_key), schema_template,
+                                            measure_template(*schema_template).bytes);
+                }
+            }
+
+            // Other dialects convert in full
+            if (options.project && uses_modern_dialect(schema, options.default_dialect)) {
+                auto analyzed = analyze_projection(schema);
+                if (analyzed.kind != Projection::Kind::Full) {
+                    projection = std::make_shared<const Projection>(std::move(analyzed));
+                }
+            }
+
+            if (options.incremental) {
+                decomposition = decompose_schema(schema, options);
+            }
+        }
+
+        push_compiled_schema(L, std::move(schema_template), options, std::move(projection), std::move(decomposition));
+        return 1;
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Load a compiled schema from a `CompiledSchema:dump()` artifact.
+ *
+ * Implements `luablaze.load(artifact_json[, options]) -> CompiledSchema`
+ *
+ * The template is rebuilt without walking, resolving or compiling the
+ * original schema. Artifacts produced by a different luablaze or Blaze
+ * version are rejected. Mode and dialect are taken from the artifact, so
+ * `options` only accepts the conversion and parse limits (`max_array_length`,
+ * `max_depth`, `max_input_bytes`, `max_json_array_length`,
+ * `max_string_length`, `max_object_properties`, `max_recursion_depth`) and
+ * `stats`.
+ *
+ * @param L Lua state (expects artifact_json_string at index 1, optional options table at index 2)
+ * @return 1 (CompiledSchema userdata on stack)
+ * @throws Lua error on malformed, stale or invalid artifacts
+ *
+ * @code{.lua}
+ * local artifact = luablaze.new(schema_json):dump()
+ * local schema = luablaze.load(artifact)
+ * @endcode
+ */
+static int luablaze_load(lua_State *L) {
+    std::size_t artifact_len{0};
+    const char *artifact_str = luaL_checklstring(L, 1, &artifact_len);
+
+    SchemaOptions options;
+
+    try {
+        if (!lua_isnoneornil(L, 2)) {
+            if (lua_type(L, 2) != LUA_TTABLE) {
+                throw std::runtime_error("options_table must be a table");
+            }
+            std::string options_error;
+            if (!parse_options_table(L, 2, options, options_error)) {
+                throw std::runtime_error(options_error);
+            }
+            if (!reject_compilation_options(L, 2, "luablaze.load", options_error)) {
+                throw std::runtime_error(options_error);
+            }
+        }
+
+        if (!lua_isnoneornil(L, 3)) {
+            throw std::runtime_error("luablaze.load expects (artifact_json) or (artifact_json, options_table)");
+        }
+
+        // Templates nest far deeper than the schemas they come from, so the
+        // artifact itself is parsed without a depth limit
+        const auto artifact = parse_json_with_depth_limit(std::string_view{artifact_str, artifact_len}, 0);
+        if (!artifact.is_object()) {
+            throw std::runtime_error("Invalid template artifact: expected a JSON object");
+        }
+
+        const auto *format    = artifact.try_at("format");
+        const auto *version   = artifact.try_at("luablaze_version");
+        const auto *blaze     = artifact.try_at("blaze_version");
+        const auto *mode      = artifact.try_at("mode");
+        const auto *dialect   = artifact.try_at("dialect");
+        const auto *templated = artifact.try_at("template");
+        if (format == nullptr || !format->is_string() || format->to_string() != LUABLAZE_TEMPLATE_FORMAT ||
+            version == nullptr || !version->is_string() || blaze == nullptr || !blaze->is_string() ||
+            mode == nullptr || !mode->is_string() || dialect == nullptr || !dialect->is_string() ||
+            templated == nullptr) {
+            throw std::runtime_error("Invalid template artifact: missing or malformed header");
+        }
+
+        if (version->to_string() != LUABLAZE_VERSION || blaze->to_string() != BLAZE_VERSION) {
+            throw std::runtime_error("Stale template artifact: built with luablaze " + version->to_string() +
+                                     " (Blaze " + blaze->to_string() + "), expected luablaze " + LUABLAZE_VERSION +
+                                     " (Blaze " + BLAZE_VERSION + ")");
+        }
+
+        const auto parsed_mode = parse_mode_string(mode->to_string());
+        if (!parsed_mode.has_value()) {
+            throw std::runtime_error("Invalid template artifact: unknown mode '" + mode->to_string() + "'");
+        }
+        options.mode = parsed_mode.value();
+        if (dialect->to_string() != "auto") {
+            options.default_dialect = dialect->to_string();
+        }
+
+        // Artifacts written before compaction existed omit the flag
+        const auto *compact = artifact.try_at("compact");
+        if (compact != nullptr && !compact->is_boolean()) {
+            throw std::runtime_error("Invalid template artifact: malformed compact flag");
+        }
+        options.compact = compact != nullptr && compact->to_boolean();
+
+        auto schema_template = sourcemeta::blaze::from_json(*templated);
+        if (!schema_template.has_value()) {
+            throw std::runtime_error("Invalid template artifact: template could not be decoded");
+        }
+
+        push_compiled_schema(
+            L, std::make_shared<const sourcemeta::blaze::Template>(std::move(schema_template).value()), options);
+        return 1;
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Publish a compiled schema's template under a process-wide name.
+ *
+ * Implements `luablaze.publish(name, compiled_schema)`
+ *
+ * The template is shared, not copied: every schema later created with
+ * `luablaze.acquire(name)` from any Lua state or thread in the process reuses
+ * it. Publishing an existing name replaces the previous entry; schemas already
+ * acquired from it keep their template.
+ *
+ * @param L Lua state (expects a name at index 1 and a CompiledSchema at index 2)
+ * @return 0
+ */
+static int luablaze_publish(lua_State *L) {
+    std::size_t name_len{0};
+    const char *name_str = luaL_checklstring(L, 1, &name_len);
+    auto *compiled       = check_compiled_schema(L, 2);
+
+    try {
+        SchemaOptions options;
+        options.mode                  = parse_mode_string(compiled->mode_name).value();
+        options.max_array_length      = compiled->max_array_length;
+        options.max_depth             = compiled->max_depth;
+        options.max_input_bytes       = compiled->max_input_bytes;
+        options.max_json_array_length = compiled->max_json_array_length;
+        options.max_string_length     = compiled->max_string_length;
+        options.max_object_properties = compiled->max_object_properties;
+        options.max_recursion_depth   = compiled->max_recursion_depth;
+        options.cache                 = compiled->cached;
+        options.stats                 = compiled->stats != nullptr;
+        options.compact               = compiled->compact;
+        if (compiled->dialect_name != "auto") {
+            options.default_dialect = compiled->dialect_name;
+        }
+
+        template_registry().publish(
+            std::string{name_str, name_len},
+            {compiled->schema_template, options, compiled->projection, compiled->decomposition});
+        return 0;
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Create a compiled schema from a published template.
+ *
+ * Implements `luablaze.acquire(name[, options]) -> CompiledSchema | nil`
+ *
+ * The new schema shares the published template, has its own evaluator and
+ * inherits the conversion limits and `stats` setting of the published schema
+ * (not its counters) unless `options` overrides them (the conversion and
+ * parse limits, `stats`).
+ *
+ * @param L Lua state (expects a name at index 1, optional options table at index 2)
+ * @return 1 (CompiledSchema userdata, or nil if nothing is published under `name`)
+ * @throws Lua error on invalid options
+ */
+static int luablaze_acquire(lua_State *L) {
+    std::size_t name_len{0};
+    const char *name_str = luaL_checklstring(L, 1, &name_len);
+
+    try {
+        const bool has_options = !lua_isnoneornil(L, 2);
+        std::string options_error;
+        if (has_options) {
+            if (lua_type(L, 2) != LUA_TTABLE) {
+                throw std::runtime_error("options_table must be a table");
+            }
+            if (!reject_compilation_options(L, 2, "luablaze.acquire", options_error)) {
+                throw std::runtime_error(options_error);
+            }
+        }
+
+        auto entry = template_registry().find(std::string{name_str, name_len});
+        if (!entry.has_value()) {
+            lua_pushnil(L);
+            return 1;
+        }
+
+        // Limits not given in `options` are inherited from the published schema
+        if (has_options && !parse_options_table(L, 2, entry->options, options_error)) {
+            throw std::runtime_error(options_error);
+        }
+
+        push_compiled_schema(L, std::move(entry->schema_template), entry->options, std::move(entry->projection),
+                             std::move(entry->decomposition));
+        return 1;
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
+}
+
+/**
+ * @brief Remove a published template.
+ *
+ * Implements `luablaze.unpublish(name) -> boolean`
+ *
+ * Schemas already acquired keep working.
+ *
+ * @param L Lua state (expects a name at index 1)
+ * @return 1 (true if an entry was removed)
+ */
+static int luablaze_unpublish(lua_State *L) {
+    std::size_t name_len{0};
+    const char *name_str = luaL_checklstring(L, 1, &name_len);
+    lua_pushboolean(L, template_registry().unpublish(std::string{name_str, name_len}) ? 1 : 0);
+    return 1;
+}
+
+/**
+ * @brief List the names of the published templates.
+ *
+ * Implements `luablaze.published() -> table`
+ *
+ * @param L Lua state
+ * @return 1 (sorted array of names)
+ */
+static int luablaze_published(lua_State *L) {
+    const auto names = template_registry().names();
+    lua_createtable(L, static_cast<int>(names.size()), 0);
+    for (std::size_t i = 0; i < names.size(); i++) {
+        lua_pushlstring(L, names[i].data(), names[i].size());
+        lua_rawseti(L, -2, static_cast<lua_Integer>(i + 1));
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Schemas selected by a discriminator value in the instance.
+ *
+ * Created by `luablaze.new_set()`. Every route owns a `CompiledSchema`
+ * sharing the template of the schema it was created from, so the set keeps
+ * working after those schemas are collected.
+ *
+ * @var discriminator Reference tokens of the discriminator JSON Pointer
+ * @var pointer The discriminator JSON Pointer as given
+ * @var routes Compiled schema for every discriminator value
+ * @var fallback Route used for instances without a known discriminator, if any
+ * @var limits Parse limits for JSON instances, the loosest of all routes;
+ *      the selected route's own limits are checked after routing
+ */
+struct SchemaSet {
+    std::vector<std::string> discriminator;
+    std::string pointer;
+    std::unordered_map<std::string, std::unique_ptr<CompiledSchema>> routes;
+    const std::pair<const std::string, std::unique_ptr<CompiledSchema>> *fallback{nullptr};
+    ParseLimits limits{};
+
+    // The route for `value`, falling back to the default route
+    auto route(const std::optional<std::string> &value) const
+        -> const std::pair<const std::string, std::unique_ptr<CompiledSchema>> * {
+        if (value.has_value()) {
+            const auto match = this->routes.find(value.value());
+            if (match != this->routes.end()) {
+                return &*match;
+            }
+        }
+        return this->fallback;
+    }
+};
+
+struct SchemaSetUserdata {
+    SchemaSet *ptr;
+};
+
+// Validate and extract a `SchemaSet*` from a Lua userdata at `index`.
+// Raises a Lua error if the type does not match.
+static auto check_schema_set(lua_State *L, const int index) -> SchemaSet * {
+    auto *ud = static_cast<SchemaSetUserdata *>(luaL_checkudata(L, index, LUABLAZE_SCHEMASET_MT));
+    luaL_argcheck(L, ud != nullptr && ud->ptr != nullptr, index, "SchemaSet expected");
+    return ud->ptr;
+}
+
+// Lua GC metamethod: destroy the set stored inside the userdata.
+static int schema_set_gc(lua_State *L) {
+    auto *ud = static_cast<SchemaSetUserdata *>(luaL_testudata(L, 1, LUABLAZE_SCHEMASET_MT));
+    if (ud != nullptr && ud->ptr != nullptr) {
+        delete ud->ptr;
+        ud->ptr = nullptr;
     }
-    error = "Unsupported JSON type for Lua conversion";
-    return false;
+    return 0;
 }
 
-static bool lua_table_to_json(lua_State *L, int index, std::unordered_set<const void *> &seen,
-                              const std::size_t max_array_length, const std::size_t max_recursion_depth,
-                              std::size_t depth, sourcemeta::core::JSON &out, std::string &error) {
-    const int abs_index = lua_absindex(L, index);
-    return lua_table_to_json_abs(L, abs_index, seen, max_array_length, max_recursion_depth, depth, out, error);
+// A route sharing the template, limits and projection of `compiled`, with
+// its own evaluator and scratch state and no statistics.
+static auto make_route(const CompiledSchema &compiled) -> std::unique_ptr<CompiledSchema> {
+    return std::unique_ptr<CompiledSchema>{new CompiledSchema{compiled.schema_template,
+                                                              sourcemeta::blaze::Evaluator{},
+                                                              compiled.max_array_length,
+                                                              compiled.max_depth,
+                                                              compiled.max_input_bytes,
+                                                              compiled.max_json_array_length,
+                                                              compiled.max_string_length,
+                                                              compiled.max_object_properties,
+                                                              compiled.max_recursion_depth,
+                                                              compiled.mode_name,
+                                                              compiled.dialect_name,
+                                                              compiled.cached,
+                                                              compiled.compact,
+                                                              compiled.instruction_count,
+                                                              compiled.approx_bytes,
+                                                              ConversionScratch{},
+                                                              nullptr,
+                                                              compiled.projection,
+                                                              compiled.decomposition}};
 }
 
-static bool lua_table_to_json_abs(lua_State *L, const int abs_index, std::unordered_set<const void *> &seen,
-                                  const std::size_t max_array_length, const std::size_t max_recursion_depth,
-                                  std::size_t depth, sourcemeta::core::JSON &out, std::string &error) {
-    // Check recursion depth to prevent stack overflow (0 = unlimited)
-    if (max_recursion_depth > 0 && depth > max_recursion_depth) {
-        error = "Maximum recursion depth exceeded (depth=" + std::to_string(depth) + ")";
-        return false;
+// A discriminator value as a route key: strings as is, integers in decimal.
+static auto discriminator_key(const sourcemeta::core::JSON &value) -> std::optional<std::string> {
+    if (value.is_string()) {
+        return value.to_string();
     }
-
-    // Ensure we have enough Lua stack space for table iteration/conversion.
-    // Deeply nested tables can otherwise trigger undefined behavior.
-    if (!lua_checkstack(L, 8)) {
-        error = "Cannot grow Lua stack (stack overflow risk)";
-        return false;
+    if (value.is_integer()) {
+        return std::to_string(value.to_integer());
     }
+    return std::nullopt;
+}
 
-    const void *ptr = lua_topointer(L, abs_index);
-    if (ptr != nullptr) {
-        if (seen.find(ptr) != seen.end()) {
-            error = "Cycle detected in Lua table";
-            return false;
+// Read the discriminator of the Lua table at `index` without converting it.
+// Array elements are addressed with 0-based tokens, as in JSON.
+static auto lua_discriminator_key(lua_State *L, const int index, const std::vector<std::string> &tokens)
+    -> std::optional<std::string> {
+    const int top = lua_gettop(L);
+    lua_pushvalue(L, index);
+    for (const auto &token : tokens) {
+        if (lua_type(L, -1) != LUA_TTABLE) {
+            lua_settop(L, top);
+            return std::nullopt;
+        }
+        lua_pushlstring(L, token.data(), token.size());
+        lua_rawget(L, -2);
+        if (lua_isnil(L, -1) && !token.empty() && token.size() <= 18 &&
+            std::all_of(token.begin(), token.end(), [](const char character) {
+                return character >= '0' && character <= '9';
+            })) {
+            lua_pop(L, 1);
+            lua_rawgeti(L, -1, static_cast<lua_Integer>(std::stoll(token)) + 1);
         }
-        seen.insert(ptr);
+        lua_remove(L, -2);
     }
 
-    bool is_array              = true;
-    std::size_t max_index      = 0;
-    std::size_t count_int_keys = 0;
+    std::optional<std::string> key;
+    if (lua_type(L, -1) == LUA_TSTRING) {
+        std::size_t length{0};
+        const char *value = lua_tolstring(L, -1, &length);
+        key               = std::string{value, length};
+    } else if (lua_type(L, -1) == LUA_TNUMBER && lua_isinteger(L, -1)) {
+        key = std::to_string(lua_tointeger(L, -1));
+    }
+    lua_settop(L, top);
+    return key;
+}
 
-    lua_pushnil(L);
-    while (lua_next(L, abs_index) != 0) {
-        if (lua_type(L, -2) == LUA_TNUMBER) {
-            lua_Number k   = lua_tonumber(L, -2);
-            lua_Integer ki = lua_tointeger(L, -2);
-            if (static_cast<lua_Number>(ki) != k || ki <= 0) {
-                is_array = false;
-            } else {
-                count_int_keys++;
-                if (static_cast<std::size_t>(ki) > max_index) {
-                    max_index = static_cast<std::size_t>(ki);
-                }
-            }
-        } else {
-            is_array = false;
-        }
-        lua_pop(L, 1);
+// Read the discriminator of the table or `Instance` at `index`.
+static auto instance_discriminator_key(lua_State *L, const SchemaSet *set, const int index)
+    -> std::optional<std::string> {
+    if (const auto *parsed = test_instance(L, index); parsed != nullptr) {
+        const auto *value = find_json_pointer(*parsed, set->discriminator, set->discriminator.size());
+        return value != nullptr ? discriminator_key(*value) : std::nullopt;
     }
+    return lua_discriminator_key(L, index, set->discriminator);
+}
 
-    if (is_array && count_int_keys == 0) {
-        // Empty table: treat as object by default.
-        is_array = false;
+// Push the name of `route` (nil if the instance matched no route).
+static void push_route_name(lua_State *L,
+                            const std::pair<const std::string, std::unique_ptr<CompiledSchema>> *route) {
+    if (route == nullptr) {
+        lua_pushnil(L);
+        return;
     }
+    lua_pushlstring(L, route->first.data(), route->first.size());
+}
 
-    if (is_array) {
-        // Check for potential integer overflow before loop
-        if (max_index == SIZE_MAX) {
-            error = "Array index too large (integer overflow risk)";
-            if (ptr != nullptr) {
-                seen.erase(ptr);
-            }
-            return false;
-        }
+/**
+ * @brief Create a set of schemas selected by a discriminator.
+ *
+ * Implements `luablaze.new_set(schemas, options) -> SchemaSet`
+ *
+ * `schemas` maps discriminator values to `CompiledSchema`s. Options:
+ * - `discriminator`: JSON Pointer to the discriminator in each instance (required)
+ * - `default`: Name of the schema used when the discriminator is missing or unknown
+ *
+ * Each instance is validated against exactly one schema found with a hash
+ * lookup, instead of trying every branch of a `oneOf`.
+ *
+ * @param L Lua state (expects a schemas table at index 1 and an options table at index 2)
+ * @return 1 (SchemaSet userdata on stack)
+ * @throws Lua error on invalid schemas or options
+ */
+static int luablaze_new_set(lua_State *L) {
+    luaL_checktype(L, 1, LUA_TTABLE);
+    luaL_checktype(L, 2, LUA_TTABLE);
 
-        if (max_array_length > 0 && max_index > max_array_length) {
-            error = "Array length exceeds max_array_length";
-            if (ptr != nullptr) {
-                seen.erase(ptr);
-            }
-            return false;
-        }
-        sourcemeta::core::JSON array{sourcemeta::core::JSON::Array{}};
-        for (std::size_t i = 1; i <= max_index; i++) {
-            if (!lua_checkstack(L, 4)) {
-                error = "Cannot grow Lua stack (stack overflow risk)";
-                if (ptr != nullptr) {
-                    seen.erase(ptr);
-                }
-                return false;
+    auto *ud = static_cast<SchemaSetUserdata *>(lua_newuserdata(L, sizeof(SchemaSetUserdata)));
+    ud->ptr  = nullptr;
+    luaL_getmetatable(L, LUABLAZE_SCHEMASET_MT);
+    lua_setmetatable(L, -2);
+
+    try {
+        ud->ptr    = new SchemaSet{};
+        auto &set  = *ud->ptr;
+        bool first = true;
+
+        lua_pushnil(L);
+        while (lua_next(L, 1) != 0) {
+            if (lua_type(L, -2) != LUA_TSTRING) {
+                throw std::runtime_error("schemas keys must be strings");
             }
-            lua_rawgeti(L, abs_index, static_cast<lua_Integer>(i));
-            sourcemeta::core::JSON element{nullptr};
-            if (!lua_isnil(L, -1)) {
-                if (!lua_value_to_json_abs(L, lua_gettop(L), seen, max_array_length, max_recursion_depth, depth + 1,
-                                           element, error)) {
-                    lua_pop(L, 1);
-                    if (ptr != nullptr) {
-                        seen.erase(ptr);
-                    }
-                    return false;
-                }
+            auto *entry = static_cast<CompiledSchemaUserdata *>(luaL_testudata(L, -1, LUABLAZE_COMPILEDSCHEMA_MT));
+            if (entry == nullptr || entry->ptr == nullptr) {
+                throw std::runtime_error(std::string{"schemas."} + lua_tostring(L, -2) + " must be a CompiledSchema");
             }
-            array.push_back(std::move(element));
+            // A route without a limit (0) lifts it for the whole set
+            const auto loosest = [first](const std::size_t current, const std::size_t limit) -> std::size_t {
+                return first ? limit : (limit == 0 || current == 0 ? 0 : std::max(current, limit));
+            };
+            const auto limits = parse_limits_of(*entry->ptr);
+            set.limits        = {loosest(set.limits.max_depth, limits.max_depth),
+                                 loosest(set.limits.max_input_bytes, limits.max_input_bytes),
+                                 loosest(set.limits.max_json_array_length, limits.max_json_array_length),
+                                 loosest(set.limits.max_string_length, limits.max_string_length),
+                                 loosest(set.limits.max_object_properties, limits.max_object_properties)};
+            first             = false;
+            set.routes.emplace(lua_tostring(L, -2), make_route(*entry->ptr));
             lua_pop(L, 1);
         }
+        if (set.routes.empty()) {
+            throw std::runtime_error("schemas must not be empty");
+        }
 
-        if (ptr != nullptr) {
-            seen.erase(ptr);
+        std::string options_error;
+        if (!validate_options_table_keys(L, 2, options_error)) {
+            throw std::runtime_error(options_error);
         }
-        out = std::move(array);
-        return true;
-    }
 
-    sourcemeta::core::JSON object{sourcemeta::core::JSON::Object{}};
-    lua_pushnil(L);
-    while (lua_next(L, abs_index) != 0) {
-        if (!lua_checkstack(L, 8)) {
-            lua_pop(L, 2);
-            error = "Cannot grow Lua stack (stack overflow risk)";
-            if (ptr != nullptr) {
-                seen.erase(ptr);
-            }
-            return false;
+        lua_getfield(L, 2, "discriminator");
+        if (lua_type(L, -1) != LUA_TSTRING) {
+            throw std::runtime_error("options.discriminator must be a JSON Pointer string");
         }
-        if (lua_type(L, -2) != LUA_TSTRING) {
-            const int key_type = lua_type(L, -2);
-            lua_pop(L, 2);
-            error = std::string{"Object table keys must be strings (found "} + lua_typename(L, key_type) + ")";
-            if (ptr != nullptr) {
-                seen.erase(ptr);
-            }
-            return false;
+        set.pointer       = lua_tostring(L, -1);
+        set.discriminator = parse_json_pointer(set.pointer);
+        if (set.discriminator.empty()) {
+            throw std::runtime_error("options.discriminator must not point to the whole instance");
         }
-        std::size_t key_len{0};
-        const char *key_str = lua_tolstring(L, -2, &key_len);
-        const auto key      = std::string{key_str, key_len};
-        sourcemeta::core::JSON value{nullptr};
-        if (!lua_value_to_json_abs(L, lua_gettop(L), seen, max_array_length, max_recursion_depth, depth + 1, value,
-                                   error)) {
-            lua_pop(L, 2);
-            if (ptr != nullptr) {
-                seen.erase(ptr);
+        lua_pop(L, 1);
+
+        lua_getfield(L, 2, "default");
+        if (!lua_isnil(L, -1)) {
+            if (lua_type(L, -1) != LUA_TSTRING) {
+                throw std::runtime_error("options.default must be a string");
             }
-            return false;
+            const auto match = set.routes.find(lua_tostring(L, -1));
+            if (match == set.routes.end()) {
+                throw std::runtime_error(std::string{"options.default names no schema: "} + lua_tostring(L, -1));
+            }
+            set.fallback = &*match;
         }
-        object.assign(key, std::move(value));
         lua_pop(L, 1);
-    }
 
-    if (ptr != nullptr) {
-        seen.erase(ptr);
+        return 1;
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
     }
-    out = std::move(object);
-    return true;
-}
-
-static bool lua_value_to_json(lua_State *L, int index, std::unordered_set<const void *> &seen,
-                              const std::size_t max_array_length, const std::size_t max_recursion_depth,
-                              std::size_t depth, sourcemeta::core::JSON &out, std::string &error) {
-    const int abs_index = lua_absindex(L, index);
-    return lua_value_to_json_abs(L, abs_index, seen, max_array_length, max_recursion_depth, depth, out, error);
 }
 
-static bool lua_value_to_json_abs(lua_State *L, const int abs_index, std::unordered_set<const void *> &seen,
-                                  const std::size_t max_array_length, const std::size_t max_recursion_depth,
-                                  std::size_t depth, sourcemeta::core::JSON &out, std::string &error) {
-    // Check recursion depth to prevent stack overflow (0 = unlimited)
-    if (max_recursion_depth > 0 && depth > max_recursion_depth) {
-        error = "Maximum recursion depth exceeded (depth=" + std::to_string(depth) + ")";
-        return false;
+/**
+ * @brief Validate a Lua table against the schema its discriminator selects.
+ *
+ * Implements `SchemaSet:validate(instance_table) -> boolean, name`
+ *
+ * The discriminator is read straight from the table, then only the selected
+ * schema converts and evaluates the instance. An instance whose
+ * discriminator selects no schema (and no `default` is set) is invalid and
+ * `name` is nil.
+ *
+ * @param L Lua state (expects a SchemaSet at index 1 and a table at index 2)
+ * @return 2 (boolean result and the selected schema's name on stack)
+ * @throws Lua error on conversion failure
+ */
+static int schema_set_validate(lua_State *L) {
+    auto *set          = check_schema_set(L, 1);
+    const auto *parsed = test_instance(L, 2);
+    if (parsed == nullptr) {
+        luaL_checktype(L, 2, LUA_TTABLE);
     }
 
-    const int t = lua_type(L, abs_index);
-    switch (t) {
-        case LUA_TNIL:
-            out = sourcemeta::core::JSON{nullptr};
-            return true;
-        case LUA_TBOOLEAN:
-            out = sourcemeta::core::JSON{static_cast<bool>(lua_toboolean(L, abs_index))};
-            return true;
-        case LUA_TNUMBER: {
-            if (lua_isinteger(L, abs_index)) {
-                out = sourcemeta::core::JSON{static_cast<std::int64_t>(lua_tointeger(L, abs_index))};
-                return true;
-            }
-            const double number = static_cast<double>(lua_tonumber(L, abs_index));
-            if (!std::isfinite(number)) {
-                error = "Non-finite numbers (NaN/Inf) are not valid JSON numbers";
-                return false;
-            }
-            out = sourcemeta::core::JSON{number};
-            return true;
-        }
-        case LUA_TSTRING: {
-            std::size_t len{0};
-            const char *str = lua_tolstring(L, abs_index, &len);
-            out             = sourcemeta::core::JSON{std::string{str, len}};
-            return true;
-        }
-        case LUA_TTABLE:
-            return lua_table_to_json_abs(L, abs_index, seen, max_array_length, max_recursion_depth, depth, out, error);
-        default: {
-            std::ostringstream oss;
-            oss << "Unsupported Lua type for JSON conversion: " << lua_typename(L, t);
-            if (t == LUA_TUSERDATA || t == LUA_TLIGHTUSERDATA) {
-                oss << " (userdata cannot be converted to JSON)";
-            } else if (t == LUA_TFUNCTION) {
-                oss << " (functions cannot be converted to JSON)";
-            } else if (t == LUA_TTHREAD) {
-                oss << " (threads cannot be converted to JSON)";
+    try {
+        const auto *route = set->route(instance_discriminator_key(L, set, 2));
+        bool result{false};
+        if (route != nullptr && parsed != nullptr) {
+            auto *compiled = route->second.get();
+            result         = compiled->evaluator.validate(*compiled->schema_template, *parsed);
+        } else if (route != nullptr) {
+            auto *compiled = route->second.get();
+            sourcemeta::core::JSON instance{nullptr};
+            std::string error;
+            if (!convert_lua_instance(L, compiled, 2, instance, error)) {
+                throw std::runtime_error(error);
             }
-            error = oss.str();
-            return false;
+            result = compiled->evaluator.validate(*compiled->schema_template, instance);
         }
+        lua_pushboolean(L, result);
+        push_route_name(L, route);
+        return 2;
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
     }
 }
 
-static auto parse_json_with_depth_limit(const std::string_view input, const std::size_t max_depth)
-    -> sourcemeta::core::JSON {
-    if (max_depth == 0) {
-        return sourcemeta::core::parse_json(std::string{input});
+/**
+ * @brief Validate a JSON string against the schema its discriminator selects.
+ *
+ * Implements `SchemaSet:validate_json(instance_json_string) -> boolean, name`
+ *
+ * The string is parsed once, with the loosest parse limits of the set's
+ * schemas, and evaluated against the selected schema only. If that schema's
+ * parse limits are tighter, the string is scanned again with them before
+ * evaluation, so a route rejects the same documents through the set as on
+ * its own.
+ *
+ * @param L Lua state (expects a SchemaSet at index 1 and a JSON string at index 2)
+ * @return 2 (boolean result and the selected schema's name on stack)
+ * @throws Lua error on parse failure
+ */
+static int schema_set_validate_json(lua_State *L) {
+    auto *set = check_schema_set(L, 1);
+    if (test_instance(L, 2) != nullptr) {
+        return schema_set_validate(L);
     }
+    std::size_t instance_len{0};
+    const char *instance_str = luaL_checklstring(L, 2, &instance_len);
 
-    std::size_t depth{0};
-    const sourcemeta::core::JSON::ParseCallback cb = [&](const sourcemeta::core::JSON::ParsePhase phase,
-                                                         const sourcemeta::core::JSON::Type type, const std::uint64_t,
-                                                         const std::uint64_t, const sourcemeta::core::JSON &) {
-        if (type == sourcemeta::core::JSON::Type::Array || type == sourcemeta::core::JSON::Type::Object) {
-            if (phase == sourcemeta::core::JSON::ParsePhase::Pre) {
-                depth++;
-                if (depth > max_depth) {
-                    throw std::runtime_error("JSON maximum nesting depth exceeded");
-                }
-            } else {
-                if (depth > 0) {
-                    depth--;
-                }
+    try {
+        auto instance = parse_json_with_limits(std::string_view{instance_str, instance_len}, set->limits);
+        const auto *value = find_json_pointer(instance, set->discriminator, set->discriminator.size());
+        const auto *route = set->route(value != nullptr ? discriminator_key(*value) : std::nullopt);
+        bool result{false};
+        if (route != nullptr) {
+            auto *compiled    = route->second.get();
+            const auto limits = parse_limits_of(*compiled);
+            if (!(limits == set->limits)) {
+                check_json_limits(std::string_view{instance_str, instance_len}, limits);
             }
+            result = compiled->evaluator.validate(*compiled->schema_template, instance);
         }
-    };
-
-    return sourcemeta::core::parse_json(std::string{input}, cb);
+        lua_pushboolean(L, result);
+        push_route_name(L, route);
+        return 2;
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
+    }
 }
 
-// Validate and extract a `CompiledSchema*` from a Lua userdata at `index`.
-// Raises a Lua error if the type does not match.
-static auto check_compiled_schema(lua_State *L, const int index) -> CompiledSchema * {
-    auto *ud = static_cast<CompiledSchemaUserdata *>(luaL_checkudata(L, index, LUABLAZE_COMPILEDSCHEMA_MT));
-    luaL_argcheck(L, ud != nullptr && ud->ptr != nullptr, index, "CompiledSchema expected");
-    return ud->ptr;
-}
+/**
+ * @brief Find the schema a Lua table would be validated against.
+ *
+ * Implements `SchemaSet:route(instance_table) -> name | nil`
+ *
+ * @param L Lua state (expects a SchemaSet at index 1 and a table at index 2)
+ * @return 1 (the selected schema's name, or nil)
+ */
+static int schema_set_route(lua_State *L) {
+    auto *set = check_schema_set(L, 1);
+    if (test_instance(L, 2) == nullptr) {
+        luaL_checktype(L, 2, LUA_TTABLE);
+    }
 
-// Lua GC metamethod: destroy the object stored inside the userdata.
-static int compiled_schema_gc(lua_State *L) {
-    auto *ud = static_cast<CompiledSchemaUserdata *>(luaL_testudata(L, 1, LUABLAZE_COMPILEDSCHEMA_MT));
-    if (ud != nullptr && ud->ptr != nullptr) {
-        delete ud->ptr;
-        ud->ptr = nullptr;
+    try {
+        push_route_name(L, set->route(instance_discriminator_key(L, set, 2)));
+        return 1;
+    } catch (const std::exception &e) {
+        return luaL_error(L, "%s", e.what());
+    } catch (...) {
+        return luaL_error(L, "unknown error");
     }
-    return 0;
 }
 
 /**
- * @brief Return information about the compiled schema configuration.
+ * @brief Return the discriminator and schema names of a set.
  *
- * Implements `CompiledSchema:info() -> table`
+ * Implements `SchemaSet:info() -> table`
  *
- * Returns a table containing:
- * - mode: "Fast" or "Exhaustive"
- * - dialect: The dialect used or "auto" if auto-detected
- * - max_array_length: Maximum array length for Lua table conversion
- * - max_depth: Maximum JSON nesting depth
- * - max_recursion_depth: Maximum recursion depth for conversion
- * - luablaze_version: Version of luablaze
- * - blaze_version: Version of the Blaze library
+ * Returns `{ discriminator = pointer, schemas = { names... }, default = name | nil }`
+ * with the names sorted.
  *
- * @param L Lua state
- * @return 1 (info table on stack)
+ * @param L Lua state (expects a SchemaSet at index 1)
+ * @return 1 (table on stack)
  */
-static int compiled_schema_info(lua_State *L) {
-    auto *compiled = check_compiled_schema(L, 1);
+static int schema_set_info(lua_State *L) {
+    auto *set = check_schema_set(L, 1);
 
-    // Ensure we have enough stack space (7 key-value pairs + table)
-    if (!lua_checkstack(L, 15)) {
-        return luaL_error(L, "Cannot grow Lua stack for info table");
+    std::vector<std::string_view> names;
+    names.reserve(set->routes.size());
+    for (const auto &route : set->routes) {
+        names.push_back(route.first);
     }
+    std::sort(names.begin(), names.end());
 
-    lua_createtable(L, 0, 7);
+    lua_createtable(L, 0, 3);
+    lua_pushlstring(L, set->pointer.data(), set->pointer.size());
+    lua_setfield(L, -2, "discriminator");
+    lua_createtable(L, static_cast<int>(names.size()), 0);
+    for (std::size_t i = 0; i < names.size(); i++) {
+        lua_pushlstring(L, names[i].data(), names[i].size());
+        lua_rawseti(L, -2, static_cast<lua_Integer>(i + 1));
+    }
+    lua_setfield(L, -2, "schemas");
+    push_route_name(L, set->fallback);
+    lua_setfield(L, -2, "default");
+    return 1;
+}
 
-    lua_pushstring(L, compiled->mode_name);
-    lua_setfield(L, -2, "mode");
+// Implements `luablaze.validate(compiled_schema, instance_table)`.
+//
+// Functional form that delegates to the method implementation.
+static int luablaze_validate(lua_State *L) {
+    (void)check_compiled_schema(L, 1);
+    return compiled_schema_validate(L);
+}
 
-    lua_pushstring(L, compiled->dialect_name.c_str());
-    lua_setfield(L, -2, "dialect");
+static int luablaze_validate_json(lua_State *L) {
+    (void)check_compiled_schema(L, 1);
+    return compiled_schema_validate_json(L);
+}
 
-    lua_pushinteger(L, static_cast<lua_Integer>(compiled->max_array_length));
-    lua_setfield(L, -2, "max_array_length");
+static int luablaze_validate_detailed(lua_State *L) {
+    (void)check_compiled_schema(L, 1);
+    return compiled_schema_validate_detailed(L);
+}
 
-    lua_pushinteger(L, static_cast<lua_Integer>(compiled->max_depth));
-    lua_setfield(L, -2, "max_depth");
+static int luablaze_validate_json_detailed(lua_State *L) {
+    (void)check_compiled_schema(L, 1);
+    return compiled_schema_validate_json_detailed(L);
+}
+
+static int luablaze_validate_file(lua_State *L) {
+    (void)check_compiled_schema(L, 1);
+    return compiled_schema_validate_file(L);
+}
 
-    lua_pushinteger(L, static_cast<lua_Integer>(compiled->max_recursion_depth));
-    lua_setfield(L, -2, "max_recursion_depth");
+static int luablaze_validate_file_detailed(lua_State *L) {
+    (void)check_compiled_schema(L, 1);
+    return compiled_schema_validate_file_detailed(L);
+}
 
-    lua_pushstring(L, LUABLAZE_VERSION);
-    lua_setfield(L, -2, "luablaze_version");
+static int luablaze_validate_many(lua_State *L) {
+    (void)check_compiled_schema(L, 1);
+    return compiled_schema_validate_many(L);
+}
 
-    lua_pushstring(L, BLAZE_VERSION);
-    lua_setfield(L, -2, "blaze_version");
+static int luablaze_validate_json_many(lua_State *L) {
+    (void)check_compiled_schema(L, 1);
+    return compiled_schema_validate_json_many(L);
+}
 
-    return 1;
+static int luablaze_validate_json_parallel(lua_State *L) {
+    (void)check_compiled_schema(L, 1);
+    return compiled_schema_validate_json_parallel(L);
 }
 
 /**
- * @brief Validate a Lua table against the compiled schema (simple boolean result).
- *
- * Implements `CompiledSchema:validate(instance_table) -> boolean`
+ * @brief Create an empty schema registry.
  *
- * Converts the Lua table at stack index 2 to a JSON value, then validates it
- * against the compiled schema template.
+ * Implements `luablaze.registry() -> SchemaRegistry`
  *
  * @param L Lua state
- * @return 1 (boolean result on stack)
- * @throws Lua error on conversion or validation failure
+ * @return 1 (SchemaRegistry userdata on stack)
  */
-static int compiled_schema_validate(lua_State *L) {
-    auto *compiled = check_compiled_schema(L, 1);
-    luaL_checktype(L, 2, LUA_TTABLE);
+static int luablaze_registry(lua_State *L) {
+    auto *ud = static_cast<SchemaRegistryUserdata *>(lua_newuserdata(L, sizeof(SchemaRegistryUserdata)));
+    new (ud) SchemaRegistryUserdata{};
+    luaL_getmetatable(L, LUABLAZE_SCHEMAREGISTRY_MT);
+    lua_setmetatable(L, -2);
 
     try {
-        std::unordered_set<const void *> seen;
-        seen.reserve(32);
-        sourcemeta::core::JSON instance{nullptr};
-        std::string error;
-        if (!lua_value_to_json(L, 2, seen, compiled->max_array_length, compiled->max_recursion_depth, 0, instance,
-                               error)) {
-            throw std::runtime_error(error);
-        }
-        const bool result = compiled->evaluator.validate(compiled->schema_template, instance);
-        lua_pushboolean(L, result);
+        ud->registry = std::make_shared<SchemaRegistry>();
         return 1;
     } catch (const std::exception &e) {
         return luaL_error(L, "%s", e.what());
-    } catch (...) {
-        return luaL_error(L, "unknown error");
     }
 }
 
+// Validate and extract the registry from a `SchemaRegistry` userdata at
+// `index`. Raises a Lua error if the type does not match.
+static auto check_schema_registry(lua_State *L, const int index) -> SchemaRegistry * {
+    auto *ud = static_cast<SchemaRegistryUserdata *>(luaL_checkudata(L, index, LUABLAZE_SCHEMAREGISTRY_MT));
+    luaL_argcheck(L, ud != nullptr && ud->registry != nullptr, index, "SchemaRegistry expected");
+    return ud->registry.get();
+}
+
+// Lua GC metamethod: release the userdata's reference to the registry.
+// Compilations in flight keep their own reference.
+static int schema_registry_gc(lua_State *L) {
+    auto *ud = static_cast<SchemaRegistryUserdata *>(luaL_testudata(L, 1, LUABLAZE_SCHEMAREGISTRY_MT));
+    if (ud != nullptr) {
+        ud->registry.reset();
+    }
+    return 0;
+}
+
 /**
- * @brief Validate a JSON string against the compiled schema (simple boolean result).
+ * @brief Add a schema document to the registry.
  *
- * Implements `CompiledSchema:validate_json(instance_json_string) -> boolean`
+ * Implements `SchemaRegistry:add(schema_json[, uri]) -> uri`
  *
- * Parses the JSON string at stack index 2, then validates it against the compiled
- * schema template.
+ * The document is parsed once and served to every compilation that
+ * references `uri`. Without an explicit `uri` the top-level `$id` (or `id`
+ * for draft 4 and older) is used. Adding an existing URI replaces it.
  *
- * @param L Lua state
- * @return 1 (boolean result on stack)
- * @throws Lua error on parse or validation failure
+ * @param L Lua state (expects a SchemaRegistry at index 1, a JSON string at index 2, optional URI at index 3)
+ * @return 1 (the URI the document was registered under)
+ * @throws Lua error if the document is not valid JSON or has no URI
  */
-static int compiled_schema_validate_json(lua_State *L) {
-    auto *compiled = check_compiled_schema(L, 1);
-    std::size_t instance_len{0};
-    const char *instance_str = luaL_checklstring(L, 2, &instance_len);
+static int schema_registry_add(lua_State *L) {
+    auto *registry = check_schema_registry(L, 1);
+    std::size_t schema_len{0};
+    const char *schema_str = luaL_checklstring(L, 2, &schema_len);
+    const char *uri_str    = luaL_optstring(L, 3, nullptr);
 
     try {
-        const auto instance =
-            parse_json_with_depth_limit(std::string_view{instance_str, instance_len}, compiled->max_depth);
-        const bool result = compiled->evaluator.validate(compiled->schema_template, instance);
-        lua_pushboolean(L, result);
+        auto schema =
+            parse_json_with_depth_limit(std::string_view{schema_str, schema_len}, LUABLAZE_DEFAULT_MAX_DEPTH);
+
+        std::string uri;
+        if (uri_str != nullptr) {
+            uri = uri_str;
+        } else if (schema.is_object()) {
+            for (const char *keyword : {"$id", "id"}) {
+                const auto *identifier = schema.try_at(keyword);
+                if (identifier != nullptr && identifier->is_string()) {
+                    uri = identifier->to_string();
+                    break;
+                }
+            }
+        }
+
+        uri = std::string{SchemaRegistry::normalize_uri(uri)};
+        if (uri.empty()) {
+            throw std::runtime_error("Registry schemas need a URI: pass one or set $id");
+        }
+
+        registry->add(uri, std::move(schema));
+        lua_pushlstring(L, uri.data(), uri.size());
         return 1;
     } catch (const std::exception &e) {
         return luaL_error(L, "%s", e.what());
@@ -766,229 +6264,191 @@ static int compiled_schema_validate_json(lua_State *L) {
 }
 
 /**
- * @brief Validate a Lua table against the compiled schema with detailed report.
+ * @brief Remove a schema document from the registry.
  *
- * Implements `CompiledSchema:validate_detailed(instance_table) -> boolean, report_table`
+ * Implements `SchemaRegistry:remove(uri) -> boolean`
  *
- * Converts the Lua table at stack index 2 to a JSON value, validates it against
- * the compiled schema template, and returns both the validation result and a detailed
- * report in JSON Schema "basic" output format.
+ * Schemas already compiled against it are not affected.
  *
- * @param L Lua state
- * @return 2 (boolean result and report table on stack)
- * @throws Lua error on conversion or validation failure
+ * @param L Lua state (expects a SchemaRegistry at index 1 and a URI at index 2)
+ * @return 1 (true if a document was removed)
  */
-static int compiled_schema_validate_detailed(lua_State *L) {
-    auto *compiled = check_compiled_schema(L, 1);
-    luaL_checktype(L, 2, LUA_TTABLE);
-
-    try {
-        std::unordered_set<const void *> seen;
-        seen.reserve(32);
-        sourcemeta::core::JSON instance{nullptr};
-        std::string error;
-        if (!lua_value_to_json(L, 2, seen, compiled->max_array_length, compiled->max_recursion_depth, 0, instance,
-                               error)) {
-            throw std::runtime_error(error);
-        }
-        const auto result{sourcemeta::blaze::standard(compiled->evaluator, compiled->schema_template, instance,
-                                                      sourcemeta::blaze::StandardOutput::Basic)};
-
-        // Extract the "valid" field from the result
-        const bool is_valid =
-            result.defines("valid") && result.at("valid").is_boolean() ? result.at("valid").to_boolean() : false;
-
-        lua_pushboolean(L, is_valid);
+static int schema_registry_remove(lua_State *L) {
+    auto *registry  = check_schema_registry(L, 1);
+    const char *uri = luaL_checkstring(L, 2);
+    lua_pushboolean(L, registry->remove(std::string{SchemaRegistry::normalize_uri(uri)}) ? 1 : 0);
+    return 1;
+}
 
-        // Convert the full result to a Lua table for detailed reporting
-        if (!json_to_lua_value(L, result, compiled->max_recursion_depth, 0, error)) {
-            throw std::runtime_error(error);
-        }
+/**
+ * @brief Check whether the registry holds a document.
+ *
+ * Implements `SchemaRegistry:has(uri) -> boolean`
+ *
+ * @param L Lua state (expects a SchemaRegistry at index 1 and a URI at index 2)
+ * @return 1 (boolean on stack)
+ */
+static int schema_registry_has(lua_State *L) {
+    auto *registry  = check_schema_registry(L, 1);
+    const char *uri = luaL_checkstring(L, 2);
+    lua_pushboolean(L, registry->contains(uri) ? 1 : 0);
+    return 1;
+}
 
-        return 2; // Return (boolean, table)
-    } catch (const std::exception &e) {
-        return luaL_error(L, "%s", e.what());
-    } catch (...) {
-        return luaL_error(L, "unknown error");
-    }
+// `__len` metamethod: number of registered documents.
+static int schema_registry_len(lua_State *L) {
+    auto *registry = check_schema_registry(L, 1);
+    lua_pushinteger(L, static_cast<lua_Integer>(registry->size()));
+    return 1;
 }
 
 /**
- * @brief Validate a JSON string against the compiled schema with detailed report.
- *
- * Implements `CompiledSchema:validate_json_detailed(instance_json_string) -> boolean, report_table`
+ * @brief Report template cache statistics.
  *
- * Parses the JSON string at stack index 2, validates it against the compiled schema
- * template, and returns both the validation result and a detailed report in JSON Schema
- * "basic" output format.
+ * Implements `luablaze.cache_stats()`
  *
  * @param L Lua state
- * @return 2 (boolean result and report table on stack)
- * @throws Lua error on parse or validation failure
+ * @return 1 (table with entries, max_entries, bytes, max_bytes, hits, misses and evictions)
  */
-static int compiled_schema_validate_json_detailed(lua_State *L) {
-    auto *compiled = check_compiled_schema(L, 1);
-    std::size_t instance_len{0};
-    const char *instance_str = luaL_checklstring(L, 2, &instance_len);
+static int luablaze_cache_stats(lua_State *L) {
+    const auto stats = template_cache().stats();
 
-    try {
-        const auto instance =
-            parse_json_with_depth_limit(std::string_view{instance_str, instance_len}, compiled->max_depth);
-        const auto result{sourcemeta::blaze::standard(compiled->evaluator, compiled->schema_template, instance,
-                                                      sourcemeta::blaze::StandardOutput::Basic)};
+    lua_createtable(L, 0, 7);
 
-        // Extract the "valid" field from the result
-        const bool is_valid =
-            result.defines("valid") && result.at("valid").is_boolean() ? result.at("valid").to_boolean() : false;
+    lua_pushinteger(L, static_cast<lua_Integer>(stats.entries));
+    lua_setfield(L, -2, "entries");
 
-        lua_pushboolean(L, is_valid);
+    lua_pushinteger(L, static_cast<lua_Integer>(stats.max_entries));
+    lua_setfield(L, -2, "max_entries");
 
-        // Convert the full result to a Lua table for detailed reporting
-        std::string error;
-        if (!json_to_lua_value(L, result, compiled->max_recursion_depth, 0, error)) {
-            throw std::runtime_error(error);
-        }
+    lua_pushinteger(L, static_cast<lua_Integer>(stats.bytes));
+    lua_setfield(L, -2, "bytes");
 
-        return 2; // Return (boolean, table)
-    } catch (const std::exception &e) {
-        return luaL_error(L, "%s", e.what());
-    } catch (...) {
-        return luaL_error(L, "unknown error");
-    }
+    lua_pushinteger(L, static_cast<lua_Integer>(stats.max_bytes));
+    lua_setfield(L, -2, "max_bytes");
+
+    lua_pushinteger(L, static_cast<lua_Integer>(stats.hits));
+    lua_setfield(L, -2, "hits");
+
+    lua_pushinteger(L, static_cast<lua_Integer>(stats.misses));
+    lua_setfield(L, -2, "misses");
+
+    lua_pushinteger(L, static_cast<lua_Integer>(stats.evictions));
+    lua_setfield(L, -2, "evictions");
+
+    return 1;
 }
 
 /**
- * @brief Alias for validate() - evaluates a Lua table against the compiled schema.
+ * @brief Drop every template from the template cache.
  *
- * Implements `CompiledSchema:evaluate(instance_table) -> boolean`
+ * Implements `luablaze.cache_clear()`
  *
- * For this binding, `evaluate` is an alias of `validate`.
+ * Schemas already compiled keep their templates alive.
  *
  * @param L Lua state
- * @return 1 (boolean result on stack)
- * @see compiled_schema_validate
+ * @return 0
  */
-static int compiled_schema_evaluate(lua_State *L) {
-    return compiled_schema_validate(L);
+static int luablaze_cache_clear(lua_State *L) {
+    (void)L;
+    template_cache().clear();
+    return 0;
 }
 
 /**
- * @brief Compile a JSON Schema string into a reusable compiled schema object.
- *
- * Implements `luablaze.new(schema_json[, options]) -> CompiledSchema`
+ * @brief Set the maximum number of templates and bytes kept by the template cache.
  *
- * Compiles a JSON Schema string into a Blaze template. Options can control:
- * - `dialect`: JSON Schema dialect (e.g., "draft7", "draft2020-12", or a $schema URI)
- * - `mode`: Compilation mode ("Fast" or "Exhaustive")
- * - `max_array_length`: Maximum array length for Lua table to JSON conversion (default: 100000, 0 = unlimited)
- * - `max_depth`: Maximum nesting depth for JSON parsing (default: 128, 0 = unlimited)
+ * Implements `luablaze.cache_set_limit(max_entries[, max_bytes])`
  *
- * @param L Lua state (expects schema_json_string at index 1, optional options table at index 2)
- * @return 1 (CompiledSchema userdata on stack)
- * @throws Lua error on parse or compilation failure
+ * `max_bytes` bounds the summed key sizes and approximate template
+ * footprints; when omitted the current byte limit is kept.
  *
- * @code{.lua}
- * local schema = luablaze.new([[{"type": "string"}]])
- * local schema2 = luablaze.new(schema_json, { dialect = "draft7", mode = "Exhaustive" })
- * @endcode
+ * @param L Lua state (expects non-negative integers at index 1 and optionally 2; 0 = unlimited)
+ * @return 0
  */
-static int luablaze_new(lua_State *L) {
-    std::size_t schema_len{0};
-    const char *schema_str = luaL_checklstring(L, 1, &schema_len);
+static int luablaze_cache_set_limit(lua_State *L) {
+    auto &cache                   = template_cache();
+    const lua_Integer max_entries = luaL_checkinteger(L, 1);
+    luaL_argcheck(L, max_entries >= 0, 1, "must be >= 0");
+    const lua_Integer max_bytes = luaL_optinteger(L, 2, static_cast<lua_Integer>(cache.stats().max_bytes));
+    luaL_argcheck(L, max_bytes >= 0, 2, "must be >= 0");
+    cache.set_limits(static_cast<std::size_t>(max_entries), static_cast<std::size_t>(max_bytes));
+    return 0;
+}
 
-    if (schema_len == 0) {
-        return luaL_error(L, "schema cannot be empty");
+/**
+ * @brief Mark a metatable as an explicit JSON array or object marker.
+ *
+ * Implements `luablaze.register_metatable(mt, kind)`
+ *
+ * Tables whose metatable is `mt` are converted as JSON arrays (`kind` =
+ * "array") or objects (`kind` = "object") regardless of their contents, which
+ * also settles the type of empty tables. This is how markers from other
+ * libraries are honored, e.g. lua-cjson's `cjson.array_mt` and
+ * `cjson.empty_array_mt`. Passing `nil` as `kind` removes the marker.
+ *
+ * @param L Lua state (expects a table at index 1 and a kind at index 2)
+ * @return 0
+ */
+static int luablaze_register_metatable(lua_State *L) {
+    luaL_checktype(L, 1, LUA_TTABLE);
+    if (!lua_isnoneornil(L, 2) && table_hint_from_value(L, 2) == TableHint::None) {
+        return luaL_argerror(L, 2, "expected \"array\", \"object\" or nil");
     }
 
-    std::optional<std::string> default_dialect{std::nullopt};
-    sourcemeta::blaze::Mode mode{sourcemeta::blaze::Mode::FastValidation};
-    std::size_t max_array_length{LUABLAZE_DEFAULT_MAX_ARRAY_LENGTH};
-    std::size_t max_depth{LUABLAZE_DEFAULT_MAX_DEPTH};
-    std::size_t max_recursion_depth{LUABLAZE_DEFAULT_MAX_RECURSION_DEPTH};
-
-    try {
-        // Supported call patterns:
-        //   new(schema)
-        //   new(schema, { dialect = "draft7", mode = "Exhaustive" })
-        //
-        // NOTE: Positional dialect arguments are not supported.
-        if (!lua_isnoneornil(L, 2)) {
-            if (lua_type(L, 2) != LUA_TTABLE) {
-                throw std::runtime_error("options_table must be a table");
-            }
-            std::string options_error;
-            if (!parse_options_table(L, 2, mode, default_dialect, max_array_length, max_depth, max_recursion_depth,
-                                     options_error)) {
-                throw std::runtime_error(options_error);
-            }
-        }
-
-        if (!lua_isnoneornil(L, 3)) {
-            throw std::runtime_error("luablaze.new expects (schema_json) or (schema_json, options_table)");
-        }
-
-        // Capture mode and dialect names for introspection
-        const char *mode_name_ptr          = (mode == sourcemeta::blaze::Mode::FastValidation) ? "Fast" : "Exhaustive";
-        const std::string dialect_name_str = default_dialect.value_or("auto");
-
-        const auto schema = parse_json_with_depth_limit(std::string_view{schema_str, schema_len}, max_depth);
-        const auto schema_template{
-            sourcemeta::blaze::compile(schema, sourcemeta::core::schema_walker, sourcemeta::core::schema_resolver,
-                                       sourcemeta::blaze::default_schema_compiler, mode, default_dialect)};
-
-        auto *ud = static_cast<CompiledSchemaUserdata *>(lua_newuserdata(L, sizeof(CompiledSchemaUserdata)));
-        ud->ptr  = nullptr;
-        ud->ptr  = new CompiledSchema{schema_template,     sourcemeta::blaze::Evaluator{},
-                                     max_array_length,    max_depth,
-                                     max_recursion_depth, mode_name_ptr,
-                                     dialect_name_str};
-        luaL_getmetatable(L, LUABLAZE_COMPILEDSCHEMA_MT);
-        lua_setmetatable(L, -2);
-        return 1;
-    } catch (const std::exception &e) {
-        return luaL_error(L, "%s", e.what());
-    } catch (...) {
-        return luaL_error(L, "unknown error");
+    lua_getfield(L, LUA_REGISTRYINDEX, LUABLAZE_TABLE_HINTS_KEY);
+    lua_pushvalue(L, 1);
+    if (lua_isnoneornil(L, 2)) {
+        lua_pushnil(L);
+    } else {
+        lua_pushvalue(L, 2);
     }
+    lua_rawset(L, -3);
+    lua_pop(L, 1);
+    return 0;
 }
 
-// Implements `luablaze.validate(compiled_schema, instance_table)`.
-//
-// Functional form that delegates to the method implementation.
-static int luablaze_validate(lua_State *L) {
-    (void)check_compiled_schema(L, 1);
-    return compiled_schema_validate(L);
-}
-
-static int luablaze_validate_json(lua_State *L) {
-    (void)check_compiled_schema(L, 1);
-    return compiled_schema_validate_json(L);
-}
-
-static int luablaze_validate_detailed(lua_State *L) {
-    (void)check_compiled_schema(L, 1);
-    return compiled_schema_validate_detailed(L);
-}
-
-static int luablaze_validate_json_detailed(lua_State *L) {
-    (void)check_compiled_schema(L, 1);
-    return compiled_schema_validate_json_detailed(L);
+// Create one of the module's marker metatables in the registry and leave it
+// on the stack. `__jsontype` makes the marker understood by dkjson as well.
+static void create_marker_metatable(lua_State *L, const char *name, const char *kind) {
+    luaL_newmetatable(L, name);
+    lua_pushstring(L, kind);
+    lua_setfield(L, -2, "__jsontype");
 }
 
 // Module function table for `require("luablaze")`.
 static const struct luaL_Reg luablaze_functions[] = {
     {"new", luablaze_new},
+    {"load", luablaze_load},
+    {"new_set", luablaze_new_set},
+    {"parse", luablaze_parse},
+    {"from_table", luablaze_from_table},
+    {"publish", luablaze_publish},
+    {"acquire", luablaze_acquire},
+    {"unpublish", luablaze_unpublish},
+    {"published", luablaze_published},
+    {"registry", luablaze_registry},
     {"validate", luablaze_validate},
     {"validate_json", luablaze_validate_json},
     {"validate_detailed", luablaze_validate_detailed},
     {"validate_json_detailed", luablaze_validate_json_detailed},
+    {"validate_file", luablaze_validate_file},
+    {"validate_file_detailed", luablaze_validate_file_detailed},
+    {"validate_many", luablaze_validate_many},
+    {"validate_json_many", luablaze_validate_json_many},
+    {"validate_json_parallel", luablaze_validate_json_parallel},
+    {"register_metatable", luablaze_register_metatable},
+    {"cache_stats", luablaze_cache_stats},
+    {"cache_clear", luablaze_cache_clear},
+    {"cache_set_limit", luablaze_cache_set_limit},
     {NULL, NULL},
 };
 
 // Module entrypoint for `require("luablaze")`.
 //
-// Registers the `CompiledSchema` metatable (methods + __gc), then returns the
-// module table containing `new` and `validate`.
+// Registers the `CompiledSchema` metatable (methods + __gc) and the table
+// marker registry, then returns the module table containing `new`,
+// `validate` and the `array_mt` / `object_mt` markers.
 LUABLAZE_EXPORT int luaopen_luablaze(lua_State *L) {
     luaL_newmetatable(L, LUABLAZE_COMPILEDSCHEMA_MT);
     lua_pushvalue(L, -1);
@@ -996,18 +6456,141 @@ LUABLAZE_EXPORT int luaopen_luablaze(lua_State *L) {
     static const luaL_Reg compiled_schema_methods[] = {
         {"validate", compiled_schema_validate},
         {"validate_json", compiled_schema_validate_json},
+        {"decode_json", compiled_schema_decode_json},
         {"validate_detailed", compiled_schema_validate_detailed},
         {"validate_json_detailed", compiled_schema_validate_json_detailed},
+        {"validate_file", compiled_schema_validate_file},
+        {"validate_file_detailed", compiled_schema_validate_file_detailed},
+        {"each_error", compiled_schema_each_error},
+        {"each_error_json", compiled_schema_each_error_json},
+        {"validate_many", compiled_schema_validate_many},
+        {"validate_json_many", compiled_schema_validate_json_many},
+        {"validate_json_parallel", compiled_schema_validate_json_parallel},
+        {"validate_json_async", compiled_schema_validate_json_async},
+        {"validate_ndjson", compiled_schema_validate_ndjson},
         {"evaluate", compiled_schema_evaluate},
+        {"profile", compiled_schema_profile},
         {"info", compiled_schema_info},
+        {"stats", compiled_schema_stats},
+        {"reset_stats", compiled_schema_reset_stats},
+        {"dump", compiled_schema_dump},
+        {"track", compiled_schema_track},
+        {"ffi_handle", compiled_schema_ffi_handle},
         {"__gc", compiled_schema_gc},
         {NULL, NULL},
     };
     luaL_setfuncs(L, compiled_schema_methods, 0);
     lua_pop(L, 1);
 
+    // Report views resolve methods through the upvalue of `__index`, as
+    // member names must also be reachable through it
+    luaL_newmetatable(L, LUABLAZE_REPORT_MT);
+    static const luaL_Reg report_methods[] = {
+        {"error_count", report_error_count},
+        {"first_error", report_first_error},
+        {"pairs", report_pairs},
+        {"to_json", report_to_json},
+        {"to_table", report_to_table},
+        {NULL, NULL},
+    };
+    luaL_newlib(L, report_methods);
+    lua_pushcclosure(L, report_index, 1);
+    lua_setfield(L, -2, "__index");
+    static const luaL_Reg report_metamethods[] = {
+        {"__len", report_len},
+        {"__pairs", report_pairs},
+        {"__gc", report_gc},
+        {NULL, NULL},
+    };
+    luaL_setfuncs(L, report_metamethods, 0);
+    lua_pop(L, 1);
+
+    luaL_newmetatable(L, LUABLAZE_SCHEMAREGISTRY_MT);
+    lua_pushvalue(L, -1);
+    lua_setfield(L, -2, "__index");
+    static const luaL_Reg schema_registry_methods[] = {
+        {"add", schema_registry_add},
+        {"remove", schema_registry_remove},
+        {"has", schema_registry_has},
+        {"__len", schema_registry_len},
+        {"__gc", schema_registry_gc},
+        {NULL, NULL},
+    };
+    luaL_setfuncs(L, schema_registry_methods, 0);
+    lua_pop(L, 1);
+
+    luaL_newmetatable(L, LUABLAZE_TRACKEDDOCUMENT_MT);
+    lua_pushvalue(L, -1);
+    lua_setfield(L, -2, "__index");
+    static const luaL_Reg tracked_document_methods[] = {
+        {"set", tracked_document_set},
+        {"remove", tracked_document_remove},
+        {"patch", tracked_document_patch},
+        {"validate", tracked_document_validate},
+        {"get", tracked_document_get},
+        {"to_json", tracked_document_to_json},
+        {"__gc", tracked_document_gc},
+        {NULL, NULL},
+    };
+    luaL_setfuncs(L, tracked_document_methods, 0);
+    lua_pop(L, 1);
+
+    luaL_newmetatable(L, LUABLAZE_INSTANCE_MT);
+    lua_pushvalue(L, -1);
+    lua_setfield(L, -2, "__index");
+    static const luaL_Reg instance_methods[] = {
+        {"to_json", instance_to_json},
+        {"to_table", instance_to_table},
+        {"__gc", instance_gc},
+        {NULL, NULL},
+    };
+    luaL_setfuncs(L, instance_methods, 0);
+    lua_pop(L, 1);
+
+    luaL_newmetatable(L, LUABLAZE_SCHEMASET_MT);
+    lua_pushvalue(L, -1);
+    lua_setfield(L, -2, "__index");
+    static const luaL_Reg schema_set_methods[] = {
+        {"validate", schema_set_validate},
+        {"validate_json", schema_set_validate_json},
+        {"route", schema_set_route},
+        {"info", schema_set_info},
+        {"__gc", schema_set_gc},
+        {NULL, NULL},
+    };
+    luaL_setfuncs(L, schema_set_methods, 0);
+    lua_pop(L, 1);
+
+    luaL_newmetatable(L, LUABLAZE_VALIDATIONJOB_MT);
+    lua_pushvalue(L, -1);
+    lua_setfield(L, -2, "__index");
+    static const luaL_Reg validation_job_methods[] = {
+        {"done", validation_job_done},
+        {"wait", validation_job_wait},
+        {"result", validation_job_result},
+        {"fd", validation_job_fd},
+        {"__gc", validation_job_gc},
+        {NULL, NULL},
+    };
+    luaL_setfuncs(L, validation_job_methods, 0);
+    lua_pop(L, 1);
+
+    // Weak-keyed registry of metatables that mark tables as arrays/objects
+    lua_newtable(L);
+    lua_createtable(L, 0, 1);
+    lua_pushliteral(L, "k");
+    lua_setfield(L, -2, "__mode");
+    lua_setmetatable(L, -2);
+    lua_setfield(L, LUA_REGISTRYINDEX, LUABLAZE_TABLE_HINTS_KEY);
+
     luaL_newlib(L, luablaze_functions);
 
+    create_marker_metatable(L, LUABLAZE_ARRAY_MT, "array");
+    lua_setfield(L, -2, "array_mt");
+
+    create_marker_metatable(L, LUABLAZE_OBJECT_MT, "object");
+    lua_setfield(L, -2, "object_mt");
+
     // Add version information to the module table
     lua_pushstring(L, LUABLAZE_VERSION);
     lua_setfield(L, -2, "_VERSION");
@@ -6,30 +6,80 @@
 //
 // The module exports:
 // - luablaze.new(schema_json[, options_table]) -> CompiledSchema
+// - luablaze.load(artifact_json[, options_table]) -> CompiledSchema
+// - luablaze.new_set(schemas, options_table) -> SchemaSet
+// - luablaze.parse(instance_json[, options_table]) -> Instance
+// - luablaze.from_table(instance_table[, options_table]) -> Instance
+// - luablaze.publish(name, compiled_schema)
+// - luablaze.acquire(name[, options_table]) -> CompiledSchema | nil
+// - luablaze.unpublish(name) -> boolean
+// - luablaze.published() -> names
+// - luablaze.registry() -> SchemaRegistry
 // - luablaze.validate(compiled_schema, instance_table) -> boolean
 // - luablaze.validate_json(compiled_schema, instance_json) -> boolean
-// - luablaze.validate_detailed(compiled_schema, instance_table) -> boolean, report_table
-// - luablaze.validate_json_detailed(compiled_schema, instance_json) -> boolean, report_table
+// - luablaze.validate_detailed(compiled_schema, instance_table[, options]) -> boolean, report_table
+// - luablaze.validate_json_detailed(compiled_schema, instance_json[, options]) -> boolean, report_table
+// - luablaze.validate_file(compiled_schema, path) -> boolean
+// - luablaze.validate_file_detailed(compiled_schema, path[, options]) -> boolean, report_table
+// - luablaze.validate_many(compiled_schema, instance_tables[, options]) -> results, invalid_count
+// - luablaze.validate_json_many(compiled_schema, instance_jsons[, options]) -> results, invalid_count
+// - luablaze.validate_json_parallel(compiled_schema, instance_jsons[, options]) -> results, invalid_count
+// - luablaze.register_metatable(mt, "array" | "object" | nil)
+// - luablaze.cache_stats() -> table
+// - luablaze.cache_clear()
+// - luablaze.cache_set_limit(max_entries[, max_bytes])
 // - CompiledSchema:validate(instance_table) -> boolean
 // - CompiledSchema:validate_json(instance_json) -> boolean
-// - CompiledSchema:validate_detailed(instance_table) -> boolean, report_table
-// - CompiledSchema:validate_json_detailed(instance_json) -> boolean, report_table
+// - CompiledSchema:decode_json(instance_json[, options]) -> boolean, value
+// - CompiledSchema:validate_detailed(instance_table[, options]) -> boolean, report_table
+// - CompiledSchema:validate_json_detailed(instance_json[, options]) -> boolean, report_table
+// - CompiledSchema:validate_file(path) -> boolean
+// - CompiledSchema:validate_file_detailed(path[, options]) -> boolean, report_table
+// - CompiledSchema:each_error(instance_table, fn) -> boolean, count, stopped
+// - CompiledSchema:each_error_json(instance_json, fn) -> boolean, count, stopped
+// - CompiledSchema:validate_many(instance_tables[, options]) -> results, invalid_count
+// - CompiledSchema:validate_json_many(instance_jsons[, options]) -> results, invalid_count
+// - CompiledSchema:validate_json_parallel(instance_jsons[, options]) -> results, invalid_count
+// - CompiledSchema:validate_json_async(instance_json) -> ValidationJob
+// - CompiledSchema:validate_ndjson(buffer[, options]) -> summary
 // - CompiledSchema:evaluate(instance_table) -> boolean (alias for validate)
+// - CompiledSchema:profile(instance[, options]) -> boolean, keywords
+// - CompiledSchema:info() -> table
+// - CompiledSchema:stats() -> table | nil
+// - CompiledSchema:reset_stats()
+// - CompiledSchema:dump() -> artifact_json
+// - CompiledSchema:track(instance_table) -> TrackedDocument
+// - CompiledSchema:ffi_handle() -> lightuserdata (for the LuaJIT FFI entry points below)
+// - ValidationJob:done() / :wait([timeout]) / :result() / :fd()
+// - SchemaRegistry:add(schema_json[, uri]) / :remove(uri) / :has(uri)
+// - Report:pairs() / :error_count() / :first_error() / :to_json() / :to_table()
+// - Instance:to_json() / :to_table() (accepted in place of a table or JSON string by every validate method but
+//   decode_json, validate_ndjson and validate_file*, and by track)
+// - SchemaSet:validate(instance_table) / :validate_json(instance_json) -> boolean, name
+// - SchemaSet:route(instance_table) -> name | nil / :info() -> table
+// - TrackedDocument:set(pointer, value) / :remove(pointer) / :patch(operations) / :validate() / :get([pointer])
+//   / :to_json()
 //
 // Module constants:
 // - luablaze._VERSION (string) - Module version (e.g., "1.0.0")
 // - luablaze._NAME (string) - Module name ("luablaze")
 // - luablaze._BLAZE_VERSION (string) - Sourcemeta Blaze library version (e.g., "0.0.1")
+// - luablaze.array_mt / luablaze.object_mt (table) - Metatables marking tables as JSON arrays/objects
 //
 // Thread Safety:
 // - CompiledSchema objects are NOT thread-safe. External synchronization is
 //   required if the same CompiledSchema instance is used concurrently from
 //   multiple threads. Each thread should use its own CompiledSchema instance
 //   or proper locking mechanisms.
+// - Compiled templates are immutable and reference-counted. luablaze.publish /
+//   luablaze.acquire share one template between CompiledSchema instances in
+//   any Lua state or thread of the process.
 
 #ifndef LUABLAZE_H
 #define LUABLAZE_H
 
+#include <cstddef>
+
 extern "C" {
 #include <lua.hpp>
 }
@@ -43,6 +93,12 @@ extern "C" {
 extern "C" {
     // Module entrypoint for `require("luablaze")`.
     LUABLAZE_EXPORT int luaopen_luablaze(lua_State *L);
+
+    // LuaJIT FFI fast path, declared with `ffi.cdef` by the `luablaze.ffi`
+    // module. `handle` comes from `CompiledSchema:ffi_handle()`. Returns 1
+    // (valid), 0 (invalid) or -1 (error, see luablaze_ffi_last_error).
+    LUABLAZE_EXPORT int luablaze_ffi_validate_json(void *handle, const char *data, std::size_t length);
+    LUABLAZE_EXPORT const char *luablaze_ffi_last_error(void);
 }
 
 #endif // LUABLAZE_H
\ No newline at end of file
@@ -0,0 +1,75 @@
+-- luablaze/ffi.lua - LuaJIT FFI fast path for CompiledSchema:validate_json()
+--
+-- Usage:
+--   local luablaze_ffi = require("luablaze.ffi")
+--   local validate = luablaze_ffi.validator(schema)
+--   local ok = validate('{"id": 1}')
+--
+-- Under LuaJIT the returned function calls the exported
+-- luablaze_ffi_validate_json() through ffi.cdef, passing the string as a
+-- const char*/length pair. Unlike a lua_CFunction call this does not abort
+-- the trace, and the string is not copied. On other interpreters, or if the
+-- C module cannot be opened through ffi.load, the validator falls back to
+-- CompiledSchema:validate_json() with the same results and errors.
+
+-- Loads the C module the FFI functions are resolved from
+require("luablaze")
+
+local M = {}
+
+local ffi_loaded, ffi = pcall(require, "ffi")
+local lib
+
+if ffi_loaded then
+    -- Tolerate another module having declared the same functions
+    pcall(ffi.cdef, [[
+int luablaze_ffi_validate_json(void *handle, const char *data, size_t length);
+const char *luablaze_ffi_last_error(void);
+]])
+
+    -- require() already loaded the C module, so opening the same file again
+    -- shares its state instead of loading a second copy
+    local path = package.searchpath and package.searchpath("luablaze", package.cpath)
+    if path then
+        local opened, result = pcall(ffi.load, path)
+        if opened then
+            lib = result
+        end
+    end
+end
+
+-- Whether validators use the FFI entry point
+M.available = lib ~= nil
+
+-- Return `function(instance_json) -> boolean` validating against `schema`.
+-- The function keeps `schema` alive; anything but a string (e.g. an
+-- Instance) goes through CompiledSchema:validate_json().
+function M.validator(schema)
+    -- Raises unless `schema` is a CompiledSchema
+    local handle = schema:ffi_handle()
+
+    if lib == nil then
+        return function(instance_json)
+            return schema:validate_json(instance_json)
+        end
+    end
+
+    local validate_json = lib.luablaze_ffi_validate_json
+    return function(instance_json)
+        if type(instance_json) ~= "string" then
+            return schema:validate_json(instance_json)
+        end
+        local result = validate_json(handle, instance_json, #instance_json)
+        if result < 0 then
+            error(ffi.string(lib.luablaze_ffi_last_error()), 2)
+        end
+        return result == 1
+    end
+end
+
+-- One-off validation; prefer M.validator() in loops
+function M.validate_json(schema, instance_json)
+    return M.validator(schema)(instance_json)
+end
+
+return M